@@ -16,9 +16,14 @@
  */
 
 #pragma once
+#include "frame_pool.hpp"
+#include "requester/request_queue.hpp"
+
 #include <phosphor-logging/lg2.hpp>
 
 #include <coroutine>
+#include <type_traits>
+#include <utility>
 
 namespace requester
 {
@@ -46,6 +51,68 @@ struct Coroutine
 
         bool detached = false;
 
+        /** @brief Class of the requests sent by the coroutine, inherited
+         * from the code which started it.
+         */
+        RequestClass requestClass = currentRequestClass();
+
+        /** @brief Request class of the code which resumed the coroutine,
+         * current again once the coroutine suspends.
+         */
+        RequestClass resumerClass = requestClass;
+
+        /** @brief Awaiter making the class of the coroutine current while it
+         * runs, whatever resumes it.
+         */
+        template <typename Awaitable>
+        struct ClassedAwaiter
+        {
+            Awaitable& awaitable;
+            promise_type& promise;
+
+            bool await_ready()
+            {
+                return awaitable.await_ready();
+            }
+
+            auto await_suspend(std::coroutine_handle<promise_type> handle)
+            {
+                currentRequestClass() = promise.resumerClass;
+                return awaitable.await_suspend(handle);
+            }
+
+            decltype(auto) await_resume()
+            {
+                promise.resumerClass = std::exchange(currentRequestClass(),
+                                                     promise.requestClass);
+                return awaitable.await_resume();
+            }
+        };
+
+        /** @brief Wrap every awaitable of the coroutine in a ClassedAwaiter.
+         * The awaitable is a temporary of the co_await expression or an
+         * lvalue, either outlives the suspension.
+         */
+        template <typename Awaitable>
+        ClassedAwaiter<std::remove_reference_t<Awaitable>>
+            await_transform(Awaitable&& awaitable) noexcept
+        {
+            return {awaitable, *this};
+        }
+
+        /** @brief Allocate the coroutine frame from the frame pool of the
+         * thread, every polling cycle calls the same coroutines again.
+         */
+        static void* operator new(size_t size)
+        {
+            return common::FramePool::local().allocate(size);
+        }
+
+        static void operator delete(void* frame, size_t size) noexcept
+        {
+            common::FramePool::local().deallocate(frame, size);
+        }
+
         /** @brief Get the return object object
          */
         Coroutine get_return_object()
@@ -85,6 +152,7 @@ struct Coroutine
                 std::coroutine_handle<> await_suspend(
                     std::coroutine_handle<promise_type> h) noexcept
                 {
+                    currentRequestClass() = h.promise().resumerClass;
                     auto parent_handle = h.promise().parent_handle;
                     if (h.promise().detached)
                     {
@@ -0,0 +1,129 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/event.hpp>
+
+#include <coroutine>
+#include <memory>
+#include <vector>
+
+namespace common
+{
+
+/** @class CoroutineConditionVariable
+ *
+ *  Suspends coroutines until they are notified. As with the
+ *  CoroutineSemaphore, the waiters are resumed from the next tick of the event
+ *  loop rather than from within notifyAll(), which avoids nested coroutine
+ *  calls. The condition may have changed again by then, so a waiter checks it
+ *  in a loop:
+ *
+ *      while (!condition())
+ *      {
+ *          co_await conditionVariable.wait();
+ *      }
+ */
+class CoroutineConditionVariable
+{
+  public:
+    CoroutineConditionVariable(const CoroutineConditionVariable&) = delete;
+    CoroutineConditionVariable(CoroutineConditionVariable&&) = delete;
+    CoroutineConditionVariable&
+        operator=(const CoroutineConditionVariable&) = delete;
+    CoroutineConditionVariable&
+        operator=(CoroutineConditionVariable&&) = delete;
+    ~CoroutineConditionVariable() = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] event - event loop the waiters are resumed from
+     */
+    explicit CoroutineConditionVariable(const sdeventplus::Event& event) :
+        event(event)
+    {}
+
+    struct Awaiter
+    {
+        CoroutineConditionVariable& conditionVariable;
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            conditionVariable.waiters.push_back(handle);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    /** @brief Suspend the coroutine until the next notifyAll() */
+    Awaiter wait()
+    {
+        return Awaiter{*this};
+    }
+
+    /** @brief Resume every waiting coroutine on the next tick of the event
+     *         loop
+     */
+    void notifyAll()
+    {
+        if (waiters.empty())
+        {
+            return;
+        }
+        if (!resumeSource)
+        {
+            resumeSource = std::make_unique<sdeventplus::source::Defer>(
+                event, [this](sdeventplus::source::EventBase& source) {
+                source.set_enabled(sdeventplus::source::Enabled::Off);
+                resumeAll();
+            });
+        }
+        resumeSource->set_enabled(sdeventplus::source::Enabled::OneShot);
+    }
+
+    /** @brief Number of waiting coroutines */
+    size_t size() const
+    {
+        return waiters.size();
+    }
+
+  private:
+    void resumeAll()
+    {
+        // a resumed coroutine which waits again joins the next notification
+        resuming.swap(waiters);
+        for (auto handle : resuming)
+        {
+            handle.resume();
+        }
+        resuming.clear();
+    }
+
+    sdeventplus::Event event;
+    std::vector<std::coroutine_handle<>> waiters;
+    std::vector<std::coroutine_handle<>> resuming;
+    std::unique_ptr<sdeventplus::source::Defer> resumeSource;
+};
+
+} // namespace common
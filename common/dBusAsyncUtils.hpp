@@ -19,6 +19,7 @@
 #include "coroutine.hpp"
 #include "utils.hpp"
 
+#include <optional>
 #include <queue>
 
 namespace utils
@@ -109,6 +110,97 @@ struct coGetDbusProperty
     {}
 };
 
+/** @struct coGetOptionalDbusProperty
+ *
+ * An awaitable object needed by co_await operator to get the value of an
+ * optional D-Bus Property. A missing property is logged as debug and a value
+ * of another type as error, neither throws.
+ * e.g.
+ * auto value = co_await coGetOptionalDbusProperty<uint64_t>(objPath,
+ * "PollingPeriod", interface);
+ *
+ * @tparam type - property data type
+ */
+template <typename type>
+struct coGetOptionalDbusProperty
+{
+    const std::string service;
+    const std::string objectPath;
+    const std::string interface;
+    const std::string property;
+
+    /** @brief For keeping the return value, empty if the property is missing
+     * or malformed.
+     */
+    std::optional<type> ret;
+
+    /** @brief Returning false to make await_suspend() to be called.
+     */
+    bool await_ready() noexcept
+    {
+        return false;
+    }
+
+    /** @brief Called by co_await operator before suspending coroutine. The
+     * method will send out the D-Bus method call and register a call back
+     * function for the event when D-Bus method done.
+     */
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        auto& asioConnection = utils::DBusHandler::getAsioConnection();
+
+        asioConnection->async_method_call(
+            [resumeHandle = handle, this](boost::system::error_code ec,
+                                          PropertyValue value) {
+            if (ec)
+            {
+                lg2::debug(
+                    "{PROPERTY} not set for intf={INTERFACE} and path={OBJECT_PATH}. {ERROR_MESSAGE}",
+                    "PROPERTY", property, "INTERFACE", interface,
+                    "OBJECT_PATH", objectPath, "ERROR_MESSAGE", ec.message());
+                ret = std::nullopt;
+            }
+            else if (auto data = std::get_if<type>(&value))
+            {
+                ret = *data;
+            }
+            else
+            {
+                lg2::error(
+                    "malformed {PROPERTY} for intf={INTERFACE} and path={OBJECT_PATH}",
+                    "PROPERTY", property, "INTERFACE", interface,
+                    "OBJECT_PATH", objectPath);
+                ret = std::nullopt;
+            }
+            resumeHandle();
+        },
+            service.c_str(), objectPath.c_str(),
+            "org.freedesktop.DBus.Properties", "Get", interface.c_str(),
+            property.c_str());
+
+        return true;
+    }
+
+    /** @brief Called by co_await operator to get return value when awaitable
+     * object completed.
+     */
+    std::optional<type> await_resume() const noexcept
+    {
+        return ret;
+    }
+
+    /** @brief Constructor of awaitable object to initialize necessary member
+     * variables.
+     */
+    coGetOptionalDbusProperty(const std::string& objectPath,
+                              const std::string& property,
+                              const std::string& interface,
+                              const std::string service = entityManagerService) :
+        service(service),
+        objectPath(objectPath), interface(interface), property(property)
+    {}
+};
+
 /** @struct coGetServiceMap
  *
  * An awaitable object needed by co_await operator to get service map which has
@@ -255,6 +347,50 @@ struct coGetDbusProperty
     {}
 };
 
+template <typename type>
+struct coGetOptionalDbusProperty
+{
+    const std::string service;
+    const std::string objectPath;
+    const std::string interface;
+    const std::string property;
+
+    std::optional<type> ret;
+
+    bool await_ready() noexcept
+    {
+        auto& values = MockDbusAsync::getValues();
+        auto it = values[objectPath].find(property);
+        if (it != values[objectPath].end())
+        {
+            if (auto data = std::get_if<type>(&it->second))
+            {
+                ret = *data;
+            }
+        }
+
+        return true;
+    }
+
+    bool await_suspend([[maybe_unused]] std::coroutine_handle<> handle) noexcept
+    {
+        return true;
+    }
+
+    std::optional<type> await_resume() const noexcept
+    {
+        return ret;
+    }
+
+    coGetOptionalDbusProperty(const std::string& objectPath,
+                              const std::string& property,
+                              const std::string& interface,
+                              const std::string service = entityManagerService) :
+        service(service),
+        objectPath(objectPath), interface(interface), property(property)
+    {}
+};
+
 struct coGetServiceMap
 {
     const std::string& objectPath;
@@ -0,0 +1,199 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "config.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace common
+{
+
+/** @struct FramePoolStats
+ *
+ *  Counters of a FramePool. hits counts the allocations served from a free
+ *  list, oversize the allocations larger than the largest size class which
+ *  always go to the heap.
+ */
+struct FramePoolStats
+{
+    uint64_t allocations = 0;
+    uint64_t hits = 0;
+    uint64_t oversize = 0;
+    size_t live = 0;
+    size_t peakLive = 0;
+    size_t cached = 0;
+
+    /** @brief Fraction of the allocations served from a free list */
+    double hitRate() const
+    {
+        return allocations ? static_cast<double>(hits) / allocations : 0;
+    }
+};
+
+/** @class FramePool
+ *
+ *  Allocator of coroutine frames with a free list per size class. The frames
+ *  of a coroutine have the same size every time it is called, so once the
+ *  polling loops have run a cycle the frames are recycled instead of going
+ *  through the heap allocator. Up to capacity frames are kept per size
+ *  class, a capacity of 0 disables the pool.
+ *
+ *  The pool is not thread safe, each thread uses its own through local().
+ */
+class FramePool
+{
+  public:
+    /** @brief Frame sizes are rounded up to a multiple of granularity */
+    static constexpr size_t granularity = 64;
+
+    /** @brief Largest frame size served from a free list */
+    static constexpr size_t maxPooledSize = 4096;
+
+    FramePool(const FramePool&) = delete;
+    FramePool(FramePool&&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+    FramePool& operator=(FramePool&&) = delete;
+
+    /** @brief Constructor
+     *
+     *  @param[in] capacity - frames kept per size class
+     */
+    explicit FramePool(size_t capacity) : capacity(capacity) {}
+
+    ~FramePool()
+    {
+        trim(0);
+    }
+
+    /** @brief Get the pool of the calling thread. It is never destroyed, as
+     *         frames may be freed during static destruction.
+     */
+    static FramePool& local()
+    {
+        thread_local FramePool* pool =
+            new FramePool(COROUTINE_FRAME_POOL_CAPACITY);
+        return *pool;
+    }
+
+    void* allocate(size_t size)
+    {
+        stats.allocations++;
+        stats.live++;
+        stats.peakLive = std::max(stats.peakLive, stats.live);
+
+        if (size > maxPooledSize)
+        {
+            stats.oversize++;
+            return ::operator new(size);
+        }
+
+        auto sizeClass = classOf(size);
+        auto& head = freeLists[sizeClass];
+        if (head)
+        {
+            auto frame = head;
+            head = frame->next;
+            counts[sizeClass]--;
+            stats.cached--;
+            stats.hits++;
+            return frame;
+        }
+        return ::operator new(classSize(sizeClass));
+    }
+
+    void deallocate(void* frame, size_t size) noexcept
+    {
+        stats.live--;
+        if (size > maxPooledSize)
+        {
+            ::operator delete(frame, size);
+            return;
+        }
+
+        auto sizeClass = classOf(size);
+        if (counts[sizeClass] >= capacity)
+        {
+            ::operator delete(frame, classSize(sizeClass));
+            return;
+        }
+        freeLists[sizeClass] = new (frame) FreeFrame{freeLists[sizeClass]};
+        counts[sizeClass]++;
+        stats.cached++;
+    }
+
+    /** @brief Set the number of frames kept per size class, releasing the
+     *         frames beyond it
+     */
+    void setCapacity(size_t frames)
+    {
+        capacity = frames;
+        trim(frames);
+    }
+
+    /** @brief Get the counters of the pool */
+    const FramePoolStats& getStats() const
+    {
+        return stats;
+    }
+
+  private:
+    static constexpr size_t numClasses = maxPooledSize / granularity;
+
+    /** @brief Link of a cached frame, stored in the frame itself */
+    struct FreeFrame
+    {
+        FreeFrame* next;
+    };
+
+    static constexpr size_t classOf(size_t size)
+    {
+        return size == 0 ? 0 : (size - 1) / granularity;
+    }
+
+    static constexpr size_t classSize(size_t sizeClass)
+    {
+        return (sizeClass + 1) * granularity;
+    }
+
+    /** @brief Release the cached frames beyond the given number per class */
+    void trim(size_t frames)
+    {
+        for (size_t sizeClass = 0; sizeClass < numClasses; sizeClass++)
+        {
+            while (counts[sizeClass] > frames)
+            {
+                auto frame = freeLists[sizeClass];
+                freeLists[sizeClass] = frame->next;
+                counts[sizeClass]--;
+                stats.cached--;
+                ::operator delete(frame, classSize(sizeClass));
+            }
+        }
+    }
+
+    size_t capacity;
+    std::array<FreeFrame*, numClasses> freeLists{};
+    std::array<size_t, numClasses> counts{};
+    FramePoolStats stats;
+};
+
+} // namespace common
@@ -0,0 +1,108 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/coroutine.hpp"
+#include "common/frame_pool.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace common;
+
+TEST(FramePoolTest, FreedFramesAreReused)
+{
+    FramePool pool(4);
+    auto first = pool.allocate(100);
+    pool.deallocate(first, 100);
+    EXPECT_EQ(pool.getStats().cached, 1u);
+
+    // same size class
+    auto second = pool.allocate(120);
+    EXPECT_EQ(second, first);
+    pool.deallocate(second, 120);
+
+    auto& stats = pool.getStats();
+    EXPECT_EQ(stats.allocations, 2u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_DOUBLE_EQ(stats.hitRate(), 0.5);
+    EXPECT_EQ(stats.live, 0u);
+    EXPECT_EQ(stats.peakLive, 1u);
+}
+
+TEST(FramePoolTest, SizeClassesAreSeparate)
+{
+    FramePool pool(4);
+    auto small = pool.allocate(FramePool::granularity);
+    pool.deallocate(small, FramePool::granularity);
+
+    auto large = pool.allocate(FramePool::granularity + 1);
+    EXPECT_NE(large, small);
+    pool.deallocate(large, FramePool::granularity + 1);
+    EXPECT_EQ(pool.getStats().hits, 0u);
+    EXPECT_EQ(pool.getStats().cached, 2u);
+}
+
+TEST(FramePoolTest, CapacityBoundsCachedFrames)
+{
+    FramePool pool(2);
+    void* frames[3];
+    for (auto& frame : frames)
+    {
+        frame = pool.allocate(64);
+    }
+    EXPECT_EQ(pool.getStats().peakLive, 3u);
+    for (auto frame : frames)
+    {
+        pool.deallocate(frame, 64);
+    }
+    EXPECT_EQ(pool.getStats().cached, 2u);
+
+    pool.setCapacity(0);
+    EXPECT_EQ(pool.getStats().cached, 0u);
+    pool.deallocate(pool.allocate(64), 64);
+    EXPECT_EQ(pool.getStats().cached, 0u);
+}
+
+TEST(FramePoolTest, OversizeFramesBypassThePool)
+{
+    FramePool pool(4);
+    pool.deallocate(pool.allocate(FramePool::maxPooledSize + 1),
+                    FramePool::maxPooledSize + 1);
+    EXPECT_EQ(pool.getStats().oversize, 1u);
+    EXPECT_EQ(pool.getStats().cached, 0u);
+}
+
+static requester::Coroutine ready()
+{
+    // coverity[missing_return]
+    co_return 0;
+}
+
+TEST(FramePoolTest, CoroutineFramesComeFromThePool)
+{
+    auto& stats = FramePool::local().getStats();
+    ready();
+    auto allocations = stats.allocations;
+    auto hits = stats.hits;
+
+    ready();
+    EXPECT_EQ(stats.allocations, allocations + 1);
+    if (COROUTINE_FRAME_POOL_CAPACITY > 0)
+    {
+        EXPECT_EQ(stats.hits, hits + 1);
+    }
+    EXPECT_EQ(stats.live, 0u);
+}
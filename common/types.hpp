@@ -23,6 +23,7 @@
 
 #include <bitset>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -32,6 +33,9 @@
 using eid_t = uint8_t;
 using uuid_t = std::string;
 using Request = std::vector<uint8_t>;
+/** @brief Encoded request shared between polls of a sensor, the transport
+ *  sends it with the instance ID of each request */
+using RequestTemplate = std::shared_ptr<const Request>;
 using Response = std::vector<uint8_t>;
 using Command = uint8_t;
 using NsmType = uint8_t;
@@ -58,6 +62,17 @@ enum PollingState
     POLL_NON_PRIORITY,
 };
 
+/** @struct PollingThrottleStats
+ *
+ *  Round-robin and long-running polling of a device waiting for the priority
+ *  polling of the devices to end, logged per device on LogDump.
+ */
+struct PollingThrottleStats
+{
+    uint64_t throttled = 0;
+    uint64_t throttledTimeInUsec = 0;
+};
+
 } // namespace nsm
 
 namespace dbus
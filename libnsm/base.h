@@ -146,7 +146,8 @@ enum nsm_sw_codes {
 	NSM_SW_ERROR_DATA = 0x02,
 	NSM_SW_ERROR_LENGTH = 0x03,
 	NSM_SW_ERROR_NULL = 0x04,
-	NSM_SW_ERROR_COMMAND_FAIL = 0x05
+	NSM_SW_ERROR_COMMAND_FAIL = 0x05,
+	NSM_SW_ERROR_UNAVAILABLE = 0x06
 };
 
 /** @brief NSM event class
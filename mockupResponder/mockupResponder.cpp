@@ -47,7 +47,7 @@ namespace MockupResponder
 MockupResponder::MockupResponder(bool verbose, sdeventplus::Event& event,
                                  sdbusplus::asio::object_server& server,
                                  eid_t eid, uint8_t deviceType,
-                                 uint8_t instanceId) :
+                                 uint8_t instanceId, bool connectSocket) :
     event(event),
     verbose(verbose), server(server), eventReceiverEid(0),
     globalEventGenerationSetting(GLOBAL_EVENT_GENERATION_DISABLE),
@@ -158,7 +158,7 @@ MockupResponder::MockupResponder(bool verbose, sdeventplus::Event& event,
     mockDeviceType = deviceType;
     mockInstanceId = instanceId;
 
-    sockFd = initSocket();
+    sockFd = connectSocket ? initSocket() : -1;
 }
 
 int MockupResponder::initSocket()
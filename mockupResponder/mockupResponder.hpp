@@ -62,9 +62,15 @@ struct HeaderType
 class MockupResponder
 {
   public:
+    /** @brief Constructor
+     *
+     *  @param[in] connectSocket - connect to the MCTP demux daemon, false
+     *                             when processRxMsg is driven in-process
+     */
     MockupResponder(bool verbose, sdeventplus::Event& event,
                     sdbusplus::asio::object_server& server, eid_t eid,
-                    uint8_t deviceType, uint8_t instanceId);
+                    uint8_t deviceType, uint8_t instanceId,
+                    bool connectSocket = true);
     ~MockupResponder() {}
 
     int initSocket();
@@ -0,0 +1,113 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "buffer_pool.hpp"
+
+#include <new>
+
+namespace mctp_socket
+{
+
+BufferPool::BufferPool(size_t bufferSize, size_t maxIdle) :
+    slab(std::make_shared<Slab>())
+{
+    slab->bufferSize = bufferSize;
+    slab->maxIdle = maxIdle;
+    slab->idleBuffers.reserve(maxIdle);
+    slab->idleControls.reserve(maxIdle);
+}
+
+BufferPool::Buffer BufferPool::acquire()
+{
+    std::unique_ptr<uint8_t[]> buffer;
+    if (slab->idleBuffers.empty())
+    {
+        buffer = std::make_unique_for_overwrite<uint8_t[]>(slab->bufferSize);
+        slab->stats.allocated++;
+    }
+    else
+    {
+        buffer = std::move(slab->idleBuffers.back());
+        slab->idleBuffers.pop_back();
+    }
+    slab->stats.acquired++;
+    slab->stats.inUse++;
+    slab->stats.idle = slab->idleBuffers.size();
+
+    return Buffer(buffer.release(), Release{slab},
+                  ControlAllocator<uint8_t>{slab});
+}
+
+size_t BufferPool::getBufferSize() const
+{
+    return slab->bufferSize;
+}
+
+const BufferPoolStats& BufferPool::getStats() const
+{
+    return slab->stats;
+}
+
+void BufferPool::Release::operator()(uint8_t* buffer) const
+{
+    slab->stats.inUse--;
+    if (slab->idleBuffers.size() < slab->maxIdle)
+    {
+        slab->idleBuffers.emplace_back(buffer);
+    }
+    else
+    {
+        delete[] buffer;
+    }
+    slab->stats.idle = slab->idleBuffers.size();
+}
+
+BufferPool::Slab::~Slab()
+{
+    for (auto control : idleControls)
+    {
+        ::operator delete(control);
+    }
+}
+
+void* BufferPool::Slab::allocateControl(size_t size)
+{
+    // every control block of the pool has the same type, hence the same size
+    if (size == controlSize && !idleControls.empty())
+    {
+        auto control = idleControls.back();
+        idleControls.pop_back();
+        return control;
+    }
+    return ::operator new(size);
+}
+
+void BufferPool::Slab::deallocateControl(void* control, size_t size)
+{
+    if (controlSize == 0)
+    {
+        controlSize = size;
+    }
+    if (size == controlSize && idleControls.size() < maxIdle)
+    {
+        idleControls.push_back(control);
+        return;
+    }
+    ::operator delete(control);
+}
+
+} // namespace mctp_socket
@@ -0,0 +1,145 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mctp_socket
+{
+
+/** @struct BufferPoolStats
+ *
+ *  Counters of a BufferPool. allocated only grows when no idle buffer was
+ *  available, so a steady state shows acquired growing while allocated
+ *  stays flat.
+ */
+struct BufferPoolStats
+{
+    uint64_t acquired = 0;
+    uint64_t allocated = 0;
+    size_t inUse = 0;
+    size_t idle = 0;
+};
+
+/** @class BufferPool
+ *
+ *  Slab of fixed-size, reference counted message buffers. A buffer handed out
+ *  by acquire() goes back to the slab when its last owner drops it, so
+ *  received messages can be shared with any number of consumers and kept
+ *  beyond the receive callback without copying them. The shared_ptr control
+ *  blocks are recycled by the slab as well, so a warmed up pool does no heap
+ *  allocation. The slab outlives the pool while buffers are still owned.
+ */
+class BufferPool
+{
+  public:
+    using Buffer = std::shared_ptr<uint8_t[]>;
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool(BufferPool&&) = default;
+    BufferPool& operator=(const BufferPool&) = delete;
+    BufferPool& operator=(BufferPool&&) = default;
+    ~BufferPool() = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] bufferSize - size of each buffer in bytes
+     *  @param[in] maxIdle - number of released buffers kept for reuse, the
+     *                       buffers released beyond that are freed
+     */
+    BufferPool(size_t bufferSize, size_t maxIdle);
+
+    /** @brief Get a buffer of getBufferSize() bytes, its content is
+     *         undefined
+     */
+    Buffer acquire();
+
+    size_t getBufferSize() const;
+
+    const BufferPoolStats& getStats() const;
+
+  private:
+    struct Slab;
+
+    /** @brief Deleter returning a buffer to the slab */
+    struct Release
+    {
+        std::shared_ptr<Slab> slab;
+        void operator()(uint8_t* buffer) const;
+    };
+
+    /** @brief Allocator recycling the shared_ptr control blocks */
+    template <typename T>
+    struct ControlAllocator
+    {
+        using value_type = T;
+
+        std::shared_ptr<Slab> slab;
+
+        explicit ControlAllocator(std::shared_ptr<Slab> slab) :
+            slab(std::move(slab))
+        {}
+
+        template <typename U>
+        ControlAllocator(const ControlAllocator<U>& other) : slab(other.slab)
+        {}
+
+        T* allocate(size_t n);
+        void deallocate(T* p, size_t n);
+
+        template <typename U>
+        bool operator==(const ControlAllocator<U>& other) const
+        {
+            return slab == other.slab;
+        }
+    };
+
+    struct Slab
+    {
+        size_t bufferSize;
+        size_t maxIdle;
+        std::vector<std::unique_ptr<uint8_t[]>> idleBuffers;
+        std::vector<void*> idleControls;
+        size_t controlSize = 0;
+        BufferPoolStats stats;
+
+        ~Slab();
+
+        void* allocateControl(size_t size);
+        void deallocateControl(void* control, size_t size);
+    };
+
+    std::shared_ptr<Slab> slab;
+};
+
+template <typename T>
+T* BufferPool::ControlAllocator<T>::allocate(size_t n)
+{
+    return static_cast<T*>(slab->allocateControl(n * sizeof(T)));
+}
+
+template <typename T>
+void BufferPool::ControlAllocator<T>::deallocate(T* p, size_t n)
+{
+    slab->deallocateControl(p, n * sizeof(T));
+}
+
+} // namespace mctp_socket
@@ -20,15 +20,55 @@
 #include "base.h"
 #include "platform-environmental.h"
 
+#include "eid_registry.hpp"
 #include "nsmDevice.hpp"
 #include "sensorManager.hpp"
 
 #include <cstdint>
 #include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace nsm
 {
+namespace
+{
+/** @brief Assign an EID to the bus of its MCTP binding and medium on its
+ *  network, so the EIDs behind a slow bus share its budget
+ *
+ *  The MCTP endpoint objects do not expose the physical bus of an EID, so
+ *  all the EIDs of a binding and medium on a network share one budget, even
+ *  when they sit on separate physical buses.
+ */
+void setEndpointBus(RequesterHandler& handler, const MctpInfo& mctpInfo)
+{
+    const auto& [eid, mctpUuid, mctpMedium, networkId,
+                 mctpBinding] = mctpInfo;
+    auto isOn = [&](std::string_view bus) {
+        return mctpBinding.ends_with(bus) || mctpMedium.ends_with(bus);
+    };
+
+    uint32_t requestsPerSecond = 0;
+    uint32_t bytesPerSecond = 0;
+    if (isOn(".SMBus") || isOn(".I2C") || isOn(".I3C"))
+    {
+        requestsPerSecond = SMBUS_REQUESTS_PER_SECOND;
+        bytesPerSecond = SMBUS_BYTES_PER_SECOND;
+    }
+    else if (isOn(".PCIe"))
+    {
+        requestsPerSecond = PCIE_REQUESTS_PER_SECOND;
+        bytesPerSecond = PCIE_BYTES_PER_SECOND;
+    }
+
+    handler.setEndpointBus(eid,
+                           mctpBinding + ":" + mctpMedium + ":" +
+                               std::to_string(networkId),
+                           requestsPerSecond, bytesPerSecond);
+}
+} // namespace
+
 // Definition of the static instance pointer
 DeviceManager* DeviceManager::instance = nullptr;
 
@@ -62,6 +102,7 @@ requester::Coroutine DeviceManager::discoverNsmDeviceTask()
             // try ping
             auto& [eid, mctpUuid, mctpMedium, networkdId,
                    mctpBinding] = mctpInfo;
+            setEndpointBus(handler, mctpInfo);
             auto rc = co_await ping(eid);
             if (rc != NSM_SW_SUCCESS)
             {
@@ -92,6 +133,8 @@ requester::Coroutine DeviceManager::discoverNsmDeviceTask()
             // update eid table [from UUID from MCTP dbus property]
             eidTable.insert(std::make_pair(
                 mctpUuid, std::make_tuple(eid, mctpMedium, mctpBinding)));
+            // the EID answers, and may now resolve to another device
+            EidRegistry::getInstance().setOnline(eid);
         }
         queuedMctpInfos.pop();
     }
@@ -527,6 +570,10 @@ requester::Coroutine DeviceManager::SendRecvNsmMsg(eid_t eid, Request& request,
 
 void DeviceManager::onlineMctpEndpoint(const MctpInfo& mctpInfo)
 {
+    // The endpoint is reachable again, do not wait for the next probe
+    handler.resetCircuitBreaker(std::get<0>(mctpInfo));
+    EidRegistry::getInstance().setOnline(std::get<0>(mctpInfo));
+
     MctpInfos mctpInfos{mctpInfo};
     discoverNsmDevice(mctpInfos);
 }
@@ -539,6 +586,7 @@ void DeviceManager::offlineMctpEndpoint(const MctpInfo& mctpInfo)
         auto& value = discoveredEIDs[eid];
         std::get<3>(value) = false; // set EID is inactive
     }
+    EidRegistry::getInstance().setOffline(eid);
 
     const std::string uuid = std::get<1>(mctpInfo);
     auto nsmDevice = findNsmDeviceByUUID(nsmDevices, uuid);
@@ -548,6 +596,33 @@ void DeviceManager::offlineMctpEndpoint(const MctpInfo& mctpInfo)
     }
 }
 
+void DeviceManager::updateCircuitBreakerIntf(
+    eid_t eid, const requester::CircuitBreaker& breaker)
+{
+    const std::string state{
+        requester::CircuitBreaker::toString(breaker.getState())};
+
+    auto& intf = circuitBreakerIntfs[eid];
+    if (!intf)
+    {
+        std::string objPath = "/xyz/openbmc_project/NSM/Endpoint/" +
+                              std::to_string(eid);
+        intf = objServer.add_unique_interface(objPath,
+                                              "com.nvidia.NSM.CircuitBreaker");
+        intf->register_property("State", state);
+        intf->register_property("OpenCount", breaker.getOpenCount());
+        intf->register_property("CloseCount", breaker.getCloseCount());
+        intf->register_property("ProbeCount", breaker.getProbeCount());
+        intf->initialize();
+        return;
+    }
+
+    intf->set_property("State", state);
+    intf->set_property("OpenCount", breaker.getOpenCount());
+    intf->set_property("CloseCount", breaker.getCloseCount());
+    intf->set_property("ProbeCount", breaker.getProbeCount());
+}
+
 requester::Coroutine
     DeviceManager::updateFruDeviceIntf(std::shared_ptr<NsmDevice> nsmDevice,
                                        uint8_t eid)
@@ -142,7 +142,10 @@ class DeviceManager : public mctp::MctpDiscoveryHandlerIntf
         event(event),
         handler(handler), instanceIdDb(instanceIdDb), objServer(objServer),
         eidTable(eidTable), nsmDevices(nsmDevices)
-    {}
+    {
+        handler.setCircuitStateHandler(
+            std::bind_front(&DeviceManager::updateCircuitBreakerIntf, this));
+    }
 
     void discoverNsmDevice(const MctpInfos& mctpInfos);
 
@@ -169,6 +172,14 @@ class DeviceManager : public mctp::MctpDiscoveryHandlerIntf
     uint8_t remapInstanceNumber(uint8_t instanceNumber, uint8_t deviceType,
                                 uuid_t& uuid, mctp_eid_t eid);
 
+    /** @brief Expose the circuit breaker state of an EID on D-Bus
+     *
+     *  @param[in] eid - endpoint ID of the circuit breaker
+     *  @param[in] breaker - circuit breaker of the requester handler
+     */
+    void updateCircuitBreakerIntf(eid_t eid,
+                                  const requester::CircuitBreaker& breaker);
+
     sdeventplus::Event& event;
     requester::Handler<requester::Request>& handler;
     nsm::InstanceIdDb& instanceIdDb;
@@ -179,5 +190,7 @@ class DeviceManager : public mctp::MctpDiscoveryHandlerIntf
     std::coroutine_handle<> discoverNsmDeviceTaskHandle;
     NsmDeviceTable& nsmDevices;
     DiscoveredEIDs discoveredEIDs;
+    std::map<eid_t, std::unique_ptr<sdbusplus::asio::dbus_interface>>
+        circuitBreakerIntfs;
 };
 } // namespace nsm
@@ -0,0 +1,113 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "common/types.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+namespace nsm
+{
+
+class NsmDevice;
+
+/** @brief State of an EID as reported by the MCTP endpoint events */
+enum class EidState : uint8_t
+{
+    Unknown,
+    Online,
+    Offline,
+};
+
+/** @struct EidEntry
+ *
+ *  NSM device bound to an EID and the state of the EID. The device is
+ *  resolved from the EID table on the first request to the EID, requests to
+ *  an Offline EID fail without resolving it.
+ */
+struct EidEntry
+{
+    std::shared_ptr<NsmDevice> device;
+    EidState state = EidState::Unknown;
+};
+
+/** @class EidRegistry
+ *
+ *  NSM devices indexed by EID, so the request path finds the device of an
+ *  EID without scanning the EID table and the device table. DeviceManager
+ *  keeps it in sync: a binding is dropped whenever the EID is discovered
+ *  again or goes online, as the EID may then belong to another device.
+ */
+class EidRegistry
+{
+  public:
+    static EidRegistry& getInstance()
+    {
+        static EidRegistry instance;
+        return instance;
+    }
+
+    /** @brief Get the entry of an EID */
+    const EidEntry& get(eid_t eid) const
+    {
+        return entries[eid];
+    }
+
+    /** @brief Get the device bound to an EID, nullptr if none is */
+    const std::shared_ptr<NsmDevice>& getDevice(eid_t eid) const
+    {
+        return entries[eid].device;
+    }
+
+    /** @brief Bind the device resolved for an EID */
+    void bind(eid_t eid, std::shared_ptr<NsmDevice> device)
+    {
+        entries[eid].device = std::move(device);
+    }
+
+    /** @brief Drop the device binding of an EID */
+    void unbind(eid_t eid)
+    {
+        entries[eid].device.reset();
+    }
+
+    /** @brief The EID is online again or was discovered, its device is
+     *         resolved again on the next request
+     */
+    void setOnline(eid_t eid)
+    {
+        entries[eid] = {nullptr, EidState::Online};
+    }
+
+    /** @brief The EID went offline, requests to it fail until it is online
+     *         again. Its device stays bound and reports itself inactive.
+     */
+    void setOffline(eid_t eid)
+    {
+        entries[eid].state = EidState::Offline;
+    }
+
+  private:
+    EidRegistry() = default;
+
+    std::array<EidEntry, 256> entries{};
+};
+
+} // namespace nsm
@@ -28,6 +28,7 @@
 #include <cassert>
 #include <functional>
 #include <map>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -36,9 +37,9 @@ using NsmEventId = uint8_t;
 namespace nsm
 {
 
-using EventHandlerFunc =
-    std::function<void(eid_t eid, NsmType type, NsmEventId eventId,
-                       const nsm_msg* event, size_t eventLen)>;
+using EventHandlerFunc = std::function<void(
+    eid_t eid, NsmType type, NsmEventId eventId,
+    const std::shared_ptr<const nsm_msg>& event, size_t eventLen)>;
 using Level = sdbusplus::xyz::openbmc_project::Logging::server::Entry::Level;
 
 class EventHandler
@@ -53,7 +54,7 @@ class EventHandler
      *  @param[in] eventLen - nsm event size
      */
     void handle(eid_t eid, NsmType type, NsmEventId eventId,
-                const nsm_msg* event, size_t eventLen)
+                const std::shared_ptr<const nsm_msg>& event, size_t eventLen)
     {
         if (handlers.find(eventId) == handlers.end())
         {
@@ -61,7 +62,7 @@ class EventHandler
             lg2::info(
                 "No event id={EVENTID} handler found for received NSM event from EID={EID}.",
                 "EVENTID", eventId, "EID", eid);
-            unsupportedEvent(eid, event, eventLen);
+            unsupportedEvent(eid, event.get(), eventLen);
             return;
         }
 
@@ -54,9 +54,9 @@ class EventManager
      *  @param[in] eventLen - NSM event size
      *  @return NSM response message
      */
-    std::optional<Response> handle(eid_t eid, NsmType nsmType,
-                                   NsmEventId eventId, const nsm_msg* eventMsg,
-                                   size_t eventLen)
+    std::optional<Response>
+        handle(eid_t eid, NsmType nsmType, NsmEventId eventId,
+               const std::shared_ptr<const nsm_msg>& eventMsg, size_t eventLen)
     {
         if (evenTypeHandlers.find(nsmType) == evenTypeHandlers.end())
         {
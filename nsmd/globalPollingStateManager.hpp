@@ -15,8 +15,11 @@
  * limitations under the License.
  */
 
+#include <common/coroutine.hpp>
+#include <common/coroutine_condition_variable.hpp>
 #include <common/types.hpp>
 #include <nsmd/nsmDevice.hpp>
+#include <sdeventplus/event.hpp>
 
 namespace nsm
 {
@@ -26,28 +29,82 @@ namespace nsm
  * state of devices.
  *
  * This class acts as a centralized interface for retrieving and managing
- * device state.
+ * device state. It counts the devices in the priority polling phase, the
+ * devices throttling their other polling wait until the count drops to zero
+ * instead of checking it periodically.
  */
 class GlobalPollingStateManager
 {
   public:
-    GlobalPollingStateManager(const NsmDeviceTable& nsmDevices) :
-        nsmDevices(nsmDevices)
+    explicit GlobalPollingStateManager(const sdeventplus::Event& event) :
+        event(event), nonPriority(event)
     {}
-    inline PollingState getState()
+
+    inline PollingState getState() const
     {
-        for (const auto& device : nsmDevices)
+        return numPriorityDevices != 0 ? POLL_PRIORITY : POLL_NON_PRIORITY;
+    }
+
+    /** @brief Set the polling state of a device, the waiters of
+     *         waitForNonPriority() are woken once no device is in the
+     *         priority polling phase
+     *
+     *  @param[in] device - the device
+     *  @param[in] state - new polling state of the device
+     */
+    void setPollingState(NsmDevice& device, const PollingState state)
+    {
+        if (device.getPollingState() == state)
+        {
+            return;
+        }
+        device.setPollingState(state);
+
+        if (state == POLL_PRIORITY)
         {
-            if (device->getPollingState() == POLL_PRIORITY)
-            {
-                return POLL_PRIORITY;
-            }
+            ++numPriorityDevices;
         }
-        return POLL_NON_PRIORITY;
+        else if (--numPriorityDevices == 0)
+        {
+            nonPriority.notifyAll();
+        }
+    }
+
+    /** @brief Wait until no device is in the priority polling phase, the
+     *         time waited is added to the throttle stats of the device
+     *
+     *  @param[in] device - the throttled device
+     */
+    requester::Coroutine waitForNonPriority(NsmDevice& device)
+    {
+        if (numPriorityDevices == 0)
+        {
+            // coverity[missing_return]
+            co_return NSM_SW_SUCCESS;
+        }
+
+        uint64_t t0 = 0;
+        uint64_t t1 = 0;
+        sd_event_now(event.get(), CLOCK_MONOTONIC, &t0);
+
+        do
+        {
+            co_await nonPriority.wait();
+        } while (numPriorityDevices != 0);
+
+        sd_event_now(event.get(), CLOCK_MONOTONIC, &t1);
+        auto& stats = device.pollingThrottleStats;
+        ++stats.throttled;
+        stats.throttledTimeInUsec += t1 - t0;
+
+        // coverity[missing_return]
+        co_return NSM_SW_SUCCESS;
     }
 
   private:
-    const NsmDeviceTable& nsmDevices;
+    sdeventplus::Event event;
+    size_t numPriorityDevices = 0;
+    common::CoroutineConditionVariable nonPriority;
 };
 
 } // namespace nsm
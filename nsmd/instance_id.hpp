@@ -17,13 +17,18 @@
 
 #pragma once
 
+#include "libnsm/base.h"
 #include "libnsm/instance-id.h"
 
 #include <phosphor-logging/lg2.hpp>
 
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cerrno>
 #include <cstdint>
 #include <exception>
+#include <stdexcept>
 #include <string>
 #include <system_error>
 
@@ -32,18 +37,22 @@ namespace nsm
 
 /** @class InstanceId
  *  @brief Implementation of NSM instance id
+ *
+ *  By default instance IDs are allocated in process from a bitmap per EID,
+ *  which costs a few atomic operations per request. The libnsm instance ID
+ *  database, which serialises allocations through OFD locks on a file, is
+ *  only needed when several processes share instance IDs of the same
+ *  endpoints and is used when the allocator is constructed with its path.
  */
 class InstanceIdDb
 {
   public:
-    InstanceIdDb()
-    {
-        int rc = instance_db_init_default(&instanceIdDb);
-        if (rc)
-        {
-            throw std::system_category().default_error_condition(rc);
-        }
-    }
+    /** @brief Path of the instance ID database shared between processes */
+    static constexpr auto defaultDbPath =
+        "/usr/share/libnsm/instance-db/default";
+
+    /** @brief Constructor of the in-process allocator */
+    InstanceIdDb() = default;
 
     /** @brief Constructor
      *
@@ -58,6 +67,9 @@ class InstanceIdDb
         }
     }
 
+    InstanceIdDb(const InstanceIdDb&) = delete;
+    InstanceIdDb& operator=(const InstanceIdDb&) = delete;
+
     ~InstanceIdDb()
     {
         int rc = instance_db_destroy(instanceIdDb);
@@ -67,6 +79,14 @@ class InstanceIdDb
         }
     }
 
+    /** @brief Check whether instance IDs are shared with other processes
+     *         through the instance ID database
+     */
+    bool isShared() const
+    {
+        return instanceIdDb != nullptr;
+    }
+
     /** @brief Allocate an instance ID for the given terminus
      *  @param[in] eid - the Endpoint ID the instance ID is associated with
      *  @return - instance id or -EAGAIN if there are no available instance
@@ -74,6 +94,11 @@ class InstanceIdDb
      */
     uint8_t next(uint8_t eid)
     {
+        if (!instanceIdDb)
+        {
+            return allocate(eid);
+        }
+
         uint8_t id;
         int rc = instance_id_alloc(instanceIdDb, eid, &id);
 
@@ -96,7 +121,8 @@ class InstanceIdDb
      */
     void free(uint8_t eid, uint8_t instanceId)
     {
-        int rc = instance_id_free(instanceIdDb, eid, instanceId);
+        int rc = instanceIdDb ? instance_id_free(instanceIdDb, eid, instanceId)
+                              : release(eid, instanceId);
         if (rc == -EINVAL)
         {
             throw std::runtime_error(
@@ -110,7 +136,68 @@ class InstanceIdDb
     }
 
   private:
+    static constexpr unsigned numInstanceIds = NSM_INSTANCE_MAX + 1;
+    static_assert(numInstanceIds == 32, "one bitmap word per EID");
+
+    /** @brief In-process allocation state of an EID */
+    struct EidState
+    {
+        /** @brief Bit i is set while instance ID i is allocated */
+        std::atomic<uint32_t> allocated{0};
+
+        /** @brief Last allocated instance ID. IDs are handed out round robin
+         *         so a late response does not match a newer request.
+         */
+        std::atomic<uint8_t> prev{numInstanceIds - 1};
+    };
+
+    /** @brief Allocate the first free instance ID after the previous one */
+    uint8_t allocate(uint8_t eid)
+    {
+        auto& state = eids[eid];
+        auto bitmap = state.allocated.load(std::memory_order_relaxed);
+        while (true)
+        {
+            if (bitmap == UINT32_MAX)
+            {
+                throw std::runtime_error("No free instance ids");
+            }
+
+            auto first = (state.prev.load(std::memory_order_relaxed) + 1) %
+                         numInstanceIds;
+            auto offset = std::countr_zero(std::rotr(~bitmap, first));
+            auto id = static_cast<uint8_t>((first + offset) % numInstanceIds);
+
+            if (state.allocated.compare_exchange_weak(
+                    bitmap, bitmap | (1u << id), std::memory_order_acquire,
+                    std::memory_order_relaxed))
+            {
+                state.prev.store(id, std::memory_order_relaxed);
+                return id;
+            }
+        }
+    }
+
+    /** @brief Release an instance ID allocated in process
+     *
+     *  @return 0 on success, -EINVAL if the ID was not allocated
+     */
+    int release(uint8_t eid, uint8_t instanceId)
+    {
+        if (instanceId >= numInstanceIds)
+        {
+            return -EINVAL;
+        }
+
+        auto bit = 1u << instanceId;
+        auto bitmap = eids[eid].allocated.fetch_and(~bit,
+                                                    std::memory_order_release);
+        return (bitmap & bit) ? 0 : -EINVAL;
+    }
+
     instance_db* instanceIdDb = nullptr;
+
+    std::array<EidState, 256> eids{};
 };
 
 } // namespace nsm
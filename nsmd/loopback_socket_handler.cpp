@@ -0,0 +1,208 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "loopback_socket_handler.hpp"
+
+#include "libnsm/base.h"
+
+#include "common/utils.hpp"
+#include "requester/handler.hpp"
+
+#include <sys/eventfd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <system_error>
+
+namespace mctp_socket
+{
+
+constexpr uint8_t tagOwnerBitPos = 3;
+constexpr uint8_t tagOwnerMask = ~(1 << tagOwnerBitPos);
+
+/** @brief Create the placeholder fd the endpoints are registered on */
+static int openLoopbackFd()
+{
+    int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "MCTP loopback setup");
+    }
+    return fd;
+}
+
+LoopbackHandler::LoopbackHandler(
+    sdeventplus::Event& event, requester::Handler<requester::Request>& handler,
+    nsm::EventManager& eventManager, Manager& manager, bool verbose,
+    std::chrono::microseconds latency) :
+    Handler(event, handler, eventManager, manager, verbose),
+    latency(latency), loopbackFd(openLoopbackFd()),
+    timer(event.get(), [this]() { deliver(); })
+{}
+
+void LoopbackHandler::addResponder(
+    eid_t eid, Responder responder,
+    std::optional<std::chrono::microseconds> endpointLatency)
+{
+    endpoints[eid] = {std::move(responder),
+                      endpointLatency ? *endpointLatency : latency};
+    // the responders answer synchronously, no send buffer to grow
+    manager.registerEndpoint(eid, loopbackFd(), MCTP_RX_BUFFER_SIZE);
+}
+
+int LoopbackHandler::registerMctpEndpoint(
+    eid_t eid, [[maybe_unused]] int type, [[maybe_unused]] int protocol,
+    [[maybe_unused]] const std::vector<uint8_t>& pathName)
+{
+    if (!endpoints.contains(eid))
+    {
+        lg2::error("No loopback responder for EID={EID}", "EID", eid);
+        return -ENOENT;
+    }
+    manager.registerEndpoint(eid, loopbackFd(), MCTP_RX_BUFFER_SIZE);
+    return 0;
+}
+
+int LoopbackHandler::sendMsg(uint8_t tag, eid_t eid,
+                             [[maybe_unused]] int mctpFd,
+                             const uint8_t* nsmMsg, size_t nsmMsgLen,
+                             std::optional<uint8_t> instanceId) const
+{
+    if (!endpoints.contains(eid))
+    {
+        stats.unroutable++;
+        lg2::error("No loopback responder for EID={EID}", "EID", eid);
+        return NSM_SW_ERROR;
+    }
+
+    uint8_t hdr[MCTP_DEMUX_PREFIX] = {tag, eid, MCTP_MSG_TYPE_VDM};
+    TxMessage tx(hdr, {nsmMsg, nsmMsgLen}, instanceId);
+
+    if (verbose)
+    {
+        utils::printBuffer(utils::Tx, tx.nsmMsg(), tag, eid);
+    }
+
+    Request msg(tx.head().begin(), tx.head().end());
+    msg.insert(msg.end(), tx.body().begin(), tx.body().end());
+
+    stats.requests++;
+    schedule({eid, true, std::move(msg)});
+    return NSM_SW_SUCCESS;
+}
+
+void LoopbackHandler::schedule(Delivery&& delivery) const
+{
+    auto now = Clock::now();
+    auto due = now + endpoints.at(delivery.eid).latency;
+    auto entry = pending.emplace(due, std::move(delivery));
+    if (entry == pending.begin())
+    {
+        timer.start(std::chrono::ceil<std::chrono::microseconds>(due - now));
+    }
+}
+
+void LoopbackHandler::deliver()
+{
+    auto now = Clock::now();
+    // messages scheduled by the deliveries are due later than now, so this
+    // terminates even without latency
+    while (!pending.empty() && pending.begin()->first <= now)
+    {
+        auto node = pending.extract(pending.begin());
+        if (node.mapped().toResponder)
+        {
+            deliverToResponder(node.mapped());
+        }
+        else
+        {
+            deliverToNsmd(node.mapped(), node.key());
+        }
+    }
+
+    if (!pending.empty())
+    {
+        timer.start(std::chrono::ceil<std::chrono::microseconds>(
+            pending.begin()->first - Clock::now()));
+    }
+}
+
+void LoopbackHandler::deliverToResponder(Delivery& delivery)
+{
+    auto endpoint = endpoints.find(delivery.eid);
+    if (endpoint == endpoints.end())
+    {
+        return;
+    }
+
+    std::optional<Request> longRunningEvent;
+    auto response = endpoint->second.responder(delivery.msg,
+                                               longRunningEvent);
+    if (response)
+    {
+        Response msg(delivery.msg.begin(),
+                     delivery.msg.begin() + MCTP_DEMUX_PREFIX);
+        msg[0] &= tagOwnerMask;
+        msg.insert(msg.end(), response->begin(), response->end());
+        stats.responses++;
+        schedule({delivery.eid, false, std::move(msg)});
+    }
+    if (longRunningEvent)
+    {
+        Request msg{MCTP_MSG_TAG_REQ, delivery.eid, MCTP_MSG_TYPE_VDM};
+        msg.insert(msg.end(), longRunningEvent->begin(),
+                   longRunningEvent->end());
+        stats.events++;
+        schedule({delivery.eid, false, std::move(msg)});
+    }
+}
+
+void LoopbackHandler::deliverToNsmd(Delivery& delivery,
+                                    Clock::time_point received)
+{
+    if (delivery.msg.size() < MCTP_DEMUX_PREFIX + sizeof(nsm_msg_hdr))
+    {
+        return;
+    }
+
+    uint8_t tag = delivery.msg[0];
+    uint8_t type = delivery.msg[2];
+    size_t nsmMsgLen = delivery.msg.size() - MCTP_DEMUX_PREFIX;
+    // the NSM message aliases the delivered buffer, which the response
+    // handlers may keep
+    auto buffer = std::make_shared<Request>(std::move(delivery.msg));
+    std::shared_ptr<const nsm_msg> nsmMsg(
+        buffer,
+        reinterpret_cast<const nsm_msg*>(buffer->data() + MCTP_DEMUX_PREFIX));
+
+    if (verbose)
+    {
+        utils::printBuffer(utils::Rx, buffer->data() + MCTP_DEMUX_PREFIX,
+                           nsmMsgLen, tag, delivery.eid);
+    }
+
+    auto response = processRxMsg(tag, delivery.eid, type, nsmMsg, nsmMsgLen,
+                                 received);
+    if (response)
+    {
+        // acknowledgement of an event, back to the responder like on MCTP
+        sendMsg(tag & tagOwnerMask, delivery.eid, loopbackFd(),
+                response->data(), response->size(), std::nullopt);
+    }
+}
+
+} // namespace mctp_socket
@@ -0,0 +1,171 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "socket_handler.hpp"
+#include "utils.hpp"
+
+#include <sdbusplus/timer.hpp>
+
+#include <chrono>
+#include <map>
+#include <optional>
+#include <unordered_map>
+
+namespace mctp_socket
+{
+
+/** @struct LoopbackStats
+ *
+ *  Counters of the loopback transport. unroutable counts the requests sent
+ *  to an EID without a responder.
+ */
+struct LoopbackStats
+{
+    uint64_t requests = 0;
+    uint64_t responses = 0;
+    uint64_t events = 0;
+    uint64_t unroutable = 0;
+};
+
+/** @class LoopbackHandler
+ *
+ *  Socket handler which routes the NSM messages to in-process responders
+ *  keyed by EID, such as MockupResponder instances, instead of MCTP sockets.
+ *  Every message is delivered from the event loop after the latency of its
+ *  endpoint, so nsmd can be load tested against many emulated endpoints in a
+ *  single process.
+ *
+ *  The endpoints are registered with the socket manager on a placeholder
+ *  eventfd which never carries any traffic.
+ */
+class LoopbackHandler : public Handler
+{
+  public:
+    /** @brief Processes a message in the demux framing (tag, EID, MCTP
+     *         message type and NSM message) and returns the response, if
+     *         any. An event to send after the response may be returned in
+     *         longRunningEvent, as MockupResponder::processRxMsg does.
+     */
+    using Responder = std::function<std::optional<Response>(
+        const Request& rxMsg, std::optional<Request>& longRunningEvent)>;
+
+    LoopbackHandler() = delete;
+    LoopbackHandler(const LoopbackHandler&) = delete;
+    LoopbackHandler(LoopbackHandler&&) = delete;
+    LoopbackHandler& operator=(const LoopbackHandler&) = delete;
+    LoopbackHandler& operator=(LoopbackHandler&&) = delete;
+    ~LoopbackHandler() override = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] event - NSM daemon's main event loop
+     *  @param[in] handler - NSM request handler
+     *  @param[in] eventManager - NSM event Manager
+     *  @param[in/out] manager - MCTP socket manager
+     *  @param[in] verbose - Verbose tracing flag
+     *  @param[in] latency - default one way latency of the endpoints
+     *
+     *  @throws std::system_error if the placeholder eventfd cannot be created
+     */
+    LoopbackHandler(sdeventplus::Event& event,
+                    requester::Handler<requester::Request>& handler,
+                    nsm::EventManager& eventManager, Manager& manager,
+                    bool verbose, std::chrono::microseconds latency = {});
+
+    /** @brief Route the messages of an EID to a responder and register the
+     *         EID with the socket manager
+     *
+     *  @param[in] eid - endpoint ID emulated by the responder
+     *  @param[in] responder - processes the messages sent to eid
+     *  @param[in] latency - one way latency of the endpoint, the default
+     *                       latency of the handler if unset
+     */
+    void addResponder(eid_t eid, Responder responder,
+                      std::optional<std::chrono::microseconds> latency = {});
+
+    /** @brief Register an EID discovered over D-Bus, the socket parameters
+     *         are ignored. Fails unless a responder was added for eid.
+     */
+    int registerMctpEndpoint(eid_t eid, int type, int protocol,
+                             const std::vector<uint8_t>& pathName) override;
+
+    int sendMsg(uint8_t tag, eid_t eid, int mctpFd, const uint8_t* nsmMsg,
+                size_t nsmMsgLen,
+                std::optional<uint8_t> instanceId) const override;
+
+    /** @brief Get the number of messages waiting for their latency */
+    size_t getNumPending() const
+    {
+        return pending.size();
+    }
+
+    /** @brief Get the counters of the loopback transport */
+    const LoopbackStats& getLoopbackStats() const
+    {
+        return stats;
+    }
+
+  private:
+    /** @struct Endpoint
+     *
+     *  An emulated endpoint.
+     */
+    struct Endpoint
+    {
+        Responder responder;
+        Clock::duration latency;
+    };
+
+    /** @struct Delivery
+     *
+     *  A message in the demux framing on its way to the responder of eid, or
+     *  from it to nsmd.
+     */
+    struct Delivery
+    {
+        eid_t eid;
+        bool toResponder;
+        Request msg;
+    };
+
+    /** @brief Nothing to receive, messages are delivered by the timer */
+    void handleReceivedMsg(IO&, int, uint32_t) override {}
+
+    /** @brief Queue a message for delivery after the latency of its EID */
+    void schedule(Delivery&& delivery) const;
+
+    /** @brief Deliver the messages whose latency has elapsed */
+    void deliver();
+
+    /** @brief Hand a message to the responder of its EID */
+    void deliverToResponder(Delivery& delivery);
+
+    /** @brief Hand a message from a responder to nsmd */
+    void deliverToNsmd(Delivery& delivery, Clock::time_point received);
+
+    Clock::duration latency;
+    utils::CustomFD loopbackFd;
+    std::unordered_map<eid_t, Endpoint> endpoints;
+
+    /** @brief Messages by delivery time, in sending order for equal times */
+    mutable std::multimap<Clock::time_point, Delivery> pending;
+    mutable sdbusplus::Timer timer;
+    mutable LoopbackStats stats;
+};
+
+} // namespace mctp_socket
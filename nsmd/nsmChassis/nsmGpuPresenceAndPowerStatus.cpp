@@ -45,6 +45,8 @@ requester::Coroutine
          state <= (int)State::GetPowerStatus && rc == NSM_SW_SUCCESS; state++)
     {
         NsmGpuPresenceAndPowerStatus::state = (State)state;
+        // The request depends on the state, it is encoded again every time
+        invalidateRequestTemplate();
         rc = co_await NsmSensor::update(manager, eid);
     }
 
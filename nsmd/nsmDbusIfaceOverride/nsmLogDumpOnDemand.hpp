@@ -19,8 +19,10 @@
 #include "platform-environmental.h"
 
 #include "nsmDevice.hpp"
+#include "requester/handler.hpp"
 #include "requester/request_timeout_tracker.hpp"
 #include "sensorManager.hpp"
+#include "socket_handler.hpp"
 
 #include <com/nvidia/Common/LogDump/server.hpp>
 #include <phosphor-logging/lg2.hpp>
@@ -33,15 +35,25 @@ using LogDumpIntf = sdbusplus::server::object_t<
 class NsmLogDumpIntf : public LogDumpIntf
 {
   public:
-    NsmLogDumpIntf(sdbusplus::bus::bus& bus, const char* path) :
-        LogDumpIntf(bus, path)
+    NsmLogDumpIntf(sdbusplus::bus::bus& bus, const char* path,
+                   const requester::Handler<requester::Request>& reqHandler,
+                   const mctp_socket::Handler& sockHandler) :
+        LogDumpIntf(bus, path),
+        reqHandler(reqHandler), sockHandler(sockHandler)
     {}
 
     void logDump() override
     {
         nsm::SensorManagerImpl::dumpReadinessLogs();
         nsm::DeviceRequestTimeOutTracker::logFailuresForAllEids();
+        nsm::SensorManager::getInstance().logPollingStats();
+        reqHandler.logRequestClassStats();
+        sockHandler.logStats();
     }
+
+  private:
+    const requester::Handler<requester::Request>& reqHandler;
+    const mctp_socket::Handler& sockHandler;
 };
 
 class NsmLogDumpTracker
@@ -59,14 +71,17 @@ class NsmLogDumpTracker
     }
 
     // Initialization method to create and setup the singleton instance
-    static void initialize(sdbusplus::bus::bus& bus, const char* path)
+    static void
+        initialize(sdbusplus::bus::bus& bus, const char* path,
+                   const requester::Handler<requester::Request>& reqHandler,
+                   const mctp_socket::Handler& sockHandler)
     {
         if (instance)
         {
             throw std::logic_error(
                 "Initialize called on an already initialized NsmLogDumpTracker");
         }
-        static NsmLogDumpTracker inst(bus, path);
+        static NsmLogDumpTracker inst(bus, path, reqHandler, sockHandler);
         instance = &inst;
     }
 
@@ -77,10 +92,13 @@ class NsmLogDumpTracker
 
   private:
     // Private constructor to prevent direct instantiation
-    NsmLogDumpTracker(sdbusplus::bus::bus& bus, const char* path)
+    NsmLogDumpTracker(sdbusplus::bus::bus& bus, const char* path,
+                      const requester::Handler<requester::Request>& reqHandler,
+                      const mctp_socket::Handler& sockHandler)
 
     {
-        dumpIntf = std::make_unique<NsmLogDumpIntf>(bus, path);
+        dumpIntf = std::make_unique<NsmLogDumpIntf>(bus, path, reqHandler,
+                                                    sockHandler);
     }
 
     static inline NsmLogDumpTracker* instance = nullptr;
@@ -26,6 +26,9 @@
 
 #include <phosphor-logging/lg2.hpp>
 
+#include <algorithm>
+#include <chrono>
+
 namespace nsm
 {
 
@@ -187,6 +190,34 @@ void NsmDevice::setOffline()
     }
 }
 
+void NsmDevice::expediteSensors(const NsmObject* sensor)
+{
+    // CLOCK_MONOTONIC, the clock of the polling loop
+    const uint64_t nowInUsec =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    if (sensor)
+    {
+        sensorScheduler.expedite(sensor, nowInUsec);
+    }
+    else
+    {
+        sensorScheduler.expediteAll(nowInUsec);
+    }
+
+    // long-running sensors are polled once their refresh limit elapsed
+    for (const auto& longRunningSensor : longRunningSensors)
+    {
+        if (sensor && longRunningSensor.get() != sensor)
+        {
+            continue;
+        }
+        longRunningSensor->markChanged();
+        longRunningSensor->setRefreshLimit(DEFAULT_RR_REFRESH_LIMIT_IN_USEC);
+    }
+}
+
 NsmLongRunningEventHandler& NsmDevice::registerLongRunningEventHandler()
 {
     auto longRunningEventHandler =
@@ -197,58 +228,75 @@ NsmLongRunningEventHandler& NsmDevice::registerLongRunningEventHandler()
     return *longRunningEventHandler;
 }
 
+LongRunningLane& NsmDevice::getLongRunningLane(uint8_t messageType,
+                                               uint8_t commandCode)
+{
+    auto& lane = longRunningLanes[longRunningKey(messageType, commandCode)];
+    if (!lane)
+    {
+        lane = std::make_unique<LongRunningLane>();
+    }
+    return *lane;
+}
+
 void NsmDevice::registerLongRunningHandler(
     uint8_t messageType, uint8_t commandCode,
     std::shared_ptr<NsmLongRunningEvent> sensorInstance)
 {
-    clearLongRunningHandler();
     lg2::debug(
         "Registering long-running handler for MessageType={MT}, CommandCode={CC}",
         "MT", messageType, "CC", commandCode);
 
-    longRunningHandler = ActiveLongRunningHandlerInfo{messageType, commandCode,
-                                                      sensorInstance};
+    getLongRunningLane(messageType, commandCode).handler =
+        ActiveLongRunningHandlerInfo{messageType, commandCode, sensorInstance};
 }
 
-void NsmDevice::clearLongRunningHandler()
+void NsmDevice::clearLongRunningHandler(uint8_t messageType,
+                                        uint8_t commandCode)
 {
-    if (!longRunningHandler.has_value())
+    auto lane = longRunningLanes.find(longRunningKey(messageType, commandCode));
+    if (lane == longRunningLanes.end() || !lane->second->handler.has_value())
     {
         return;
     }
 
     lg2::debug(
         "Clearing long-running handler for MessageType={MT}, CommandCode={CC}",
-        "MT", longRunningHandler->messageType, "CC",
-        longRunningHandler->commandCode);
+        "MT", messageType, "CC", commandCode);
 
-    longRunningHandler.reset();
+    lane->second->handler.reset();
 }
 
 std::optional<ActiveLongRunningHandlerInfo>
-    NsmDevice::getActiveLongRunningHandler() const
+    NsmDevice::getActiveLongRunningHandler(uint8_t messageType,
+                                           uint8_t commandCode) const
+{
+    auto lane = longRunningLanes.find(longRunningKey(messageType, commandCode));
+    if (lane == longRunningLanes.end())
+    {
+        return std::nullopt;
+    }
+    return lane->second->handler;
+}
+
+size_t NsmDevice::getNumActiveLongRunningHandlers() const
 {
-    return longRunningHandler;
+    return static_cast<size_t>(
+        std::ranges::count_if(longRunningLanes, [](const auto& lane) {
+        return lane.second->handler.has_value();
+    }));
 }
 
-int NsmDevice::invokeLongRunningHandler(eid_t eid, NsmType type,
-                                        NsmEventId eventId,
-                                        const nsm_msg* event, size_t eventLen)
+int NsmDevice::invokeLongRunningHandler(
+    eid_t eid, NsmType type, NsmEventId eventId,
+    const std::shared_ptr<const nsm_msg>& event, size_t eventLen)
 {
     // TODO: Add CC and RC error log tracking to prevent log flooding.
     // Track issue: "Refactor error handling and logging in NSM components" MR.
     // Link: https://gitlab-master.nvidia.com/dgx/bmc/nsmd/-/merge_requests/527
-    if (!longRunningHandler.has_value())
-    {
-        lg2::debug(
-            "NsmDevice::invokeLongRunningHandler: No active handler registered for long-running event, EID={EID}",
-            "EID", eid);
-        return NSM_SW_ERROR_DATA;
-    }
-
     uint16_t eventState = 0;
     uint8_t dataSize = 0;
-    auto rc = decode_nsm_event(event, eventLen, eventId,
+    auto rc = decode_nsm_event(event.get(), eventLen, eventId,
                                NSM_NVIDIA_GENERAL_EVENT_CLASS, &eventState,
                                &dataSize);
 
@@ -262,25 +310,23 @@ int NsmDevice::invokeLongRunningHandler(eid_t eid, NsmType type,
     nsm_long_running_event_state state{};
     memcpy(&state, &eventState, sizeof(uint16_t));
 
-    const auto& [messageType, commandCode,
-                 sensorInstance] = *longRunningHandler;
-
-    if (state.nvidia_message_type != messageType ||
-        state.command != commandCode)
+    // The event is routed to the lane of its message type and command code
+    auto handler = getActiveLongRunningHandler(state.nvidia_message_type,
+                                               state.command);
+    if (!handler.has_value())
     {
-        lg2::error(
-            "NsmDevice::invokeLongRunningHandler: Mismatched message type or command code, "
-            "Expected MessageType={EXPECTED_MSG_TYPE}, Received MessageType={RECEIVED_MSG_TYPE}, "
-            "Expected CommandCode={EXPECTED_COMMAND_CODE}, Received CommandCode={RECEIVED_COMMAND_CODE}, EID={EID}",
-            "EXPECTED_MSG_TYPE", messageType, "RECEIVED_MSG_TYPE",
-            uint8_t(state.nvidia_message_type), "EXPECTED_COMMAND_CODE",
-            commandCode, "RECEIVED_COMMAND_CODE", uint8_t(state.command), "EID",
-            eid);
+        lg2::debug(
+            "NsmDevice::invokeLongRunningHandler: No active handler registered for long-running event, "
+            "MessageType={MSG_TYPE}, CommandCode={COMMAND_CODE}, EID={EID}",
+            "MSG_TYPE", uint8_t(state.nvidia_message_type), "COMMAND_CODE",
+            uint8_t(state.command), "EID", eid);
         return NSM_SW_ERROR_DATA;
     }
+    const auto& sensorInstance = handler->sensorInstance;
 
     // Call the `handle` method directly on the instance
-    return sensorInstance->handle(eid, type, eventId, event, eventLen);
+    return sensorInstance->handleEventBuffer(eid, type, eventId, event,
+                                             eventLen);
 }
 
 } // namespace nsm
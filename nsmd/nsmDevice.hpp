@@ -27,6 +27,7 @@
 #include "nsmInterface.hpp"
 #include "nsmObject.hpp"
 #include "nsmSensor.hpp"
+#include "sensor_scheduler.hpp"
 #include "types.hpp"
 #include "utils.hpp"
 
@@ -35,7 +36,11 @@
 
 #include <coroutine>
 #include <deque>
+#include <memory>
+#include <optional>
 #include <ranges> // For ranges::find_if
+#include <unordered_map>
+#include <unordered_set>
 
 namespace nsm
 {
@@ -54,6 +59,19 @@ struct ActiveLongRunningHandlerInfo
     std::shared_ptr<NsmLongRunningEvent> sensorInstance;
 };
 
+/** @struct LongRunningLane
+ *
+ *  Long-running operations of a device with the same message type and
+ *  command code. The completion event only identifies the operation by
+ *  message type and command code, so operations of a lane run one at a time
+ *  while operations of other lanes are outstanding at the same time.
+ */
+struct LongRunningLane
+{
+    common::CoroutineSemaphore semaphore;
+    std::optional<ActiveLongRunningHandlerInfo> handler;
+};
+
 class NsmDevice
 {
   public:
@@ -87,7 +105,14 @@ class NsmDevice
     std::vector<std::shared_ptr<NsmObject>> deviceSensors;
     std::vector<std::shared_ptr<NsmObject>> prioritySensors;
     std::deque<std::shared_ptr<NsmObject>> roundRobinSensors;
+    PollingThrottleStats pollingThrottleStats;
+    // polling schedule of prioritySensors and roundRobinSensors
+    SensorScheduler sensorScheduler{SENSOR_POLLING_TIME * 1000,
+                                    DEFAULT_RR_REFRESH_LIMIT_IN_USEC,
+                                    ADAPTIVE_POLLING_MAX_PERIOD_IN_USEC};
     std::vector<std::shared_ptr<NsmObject>> longRunningSensors;
+    // long-running sensors whose update is waiting for its completion event
+    std::unordered_set<const NsmObject*> longRunningSensorsInFlight;
     std::vector<std::shared_ptr<NsmObject>> setSensors;
     std::vector<std::shared_ptr<NsmObject>> capabilityRefreshSensors;
     std::vector<std::shared_ptr<NsmNumericAggregator>> sensorAggregators;
@@ -102,6 +127,10 @@ class NsmDevice
 
     void setEventMode(uint8_t mode);
     uint8_t getEventMode();
+    /** @brief Handle of the next event log record to fetch when the
+     *         device is in polling event mode
+     */
+    uint32_t nextEventHandle = 0;
     std::vector<std::vector<bool>> messageTypesToCommandCodeMatrix;
     bool isCommandSupported(uint8_t messageType, uint8_t commandCode);
     /** @brief set the nsmDevice to online state */
@@ -110,6 +139,13 @@ class NsmDevice
     /** @brief set the nsmDevice to offline state */
     void setOffline();
 
+    /** @brief Poll adaptive sensors at their base period again, after a set
+     *         or an event which may have changed their value
+     *
+     *  @param[in] sensor - the sensor, nullptr for every sensor of the device
+     */
+    void expediteSensors(const NsmObject* sensor = nullptr);
+
     /**
      * @brief Inserts device/static sensor to to NsmDevice.
      *
@@ -257,10 +293,13 @@ class NsmDevice
         return instanceNumber;
     }
 
-    /** @brief Getter for the longRunningSemaphore */
-    common::CoroutineSemaphore& getSemaphore()
+    /** @brief Getter for the semaphore of the long-running lane of a
+     *         message type and command code
+     */
+    common::CoroutineSemaphore& getSemaphore(uint8_t messageType,
+                                             uint8_t commandCode)
     {
-        return longRunningSemaphore;
+        return getLongRunningLane(messageType, commandCode).semaphore;
     }
 
     inline PollingState getPollingState()
@@ -289,20 +328,34 @@ class NsmDevice
         std::shared_ptr<NsmLongRunningEvent> sensorInstance);
 
     /**
-     * @brief Clears the registered long-running handler.
+     * @brief Clears the long-running handler registered for a specific
+     * message type and command code.
+     *
+     * @param messageType The message type of the long-running event.
+     * @param commandCode The command code of the long-running event.
      */
-    void clearLongRunningHandler();
+    void clearLongRunningHandler(uint8_t messageType, uint8_t commandCode);
 
     /**
-     * @brief Retrieves the active long-running handler, if any.
+     * @brief Retrieves the active long-running handler of a message type and
+     * command code, if any.
+     *
+     * @param messageType The message type of the long-running event.
+     * @param commandCode The command code of the long-running event.
      *
      * @return std::optional<ActiveLongRunningHandlerInfo> containing the active
      * handler, or an empty optional if no handler is active.
      */
     std::optional<nsm::ActiveLongRunningHandlerInfo>
-        getActiveLongRunningHandler() const;
+        getActiveLongRunningHandler(uint8_t messageType,
+                                    uint8_t commandCode) const;
+
+    /** @brief Get the number of long-running handlers currently active */
+    size_t getNumActiveLongRunningHandlers() const;
+
     int invokeLongRunningHandler(eid_t eid, NsmType type, NsmEventId eventId,
-                                 const nsm_msg* event, size_t eventLen);
+                                 const std::shared_ptr<const nsm_msg>& event,
+                                 size_t eventLen);
 
   private:
     std::vector<std::vector<bitfield8_t>> commands;
@@ -310,11 +363,27 @@ class NsmDevice
     uint8_t deviceType = 0;
     uint8_t instanceNumber = 0;
     NsmLongRunningEventHandler& registerLongRunningEventHandler();
-    common::CoroutineSemaphore
-        longRunningSemaphore; // Semaphore for synchronizing long running
-                              // commands
-    std::optional<ActiveLongRunningHandlerInfo> longRunningHandler;
-    PollingState devicePollingState;
+
+    /** @brief Key of a long-running lane, the message type in the high byte
+     *         and the command code in the low byte
+     */
+    static constexpr uint16_t longRunningKey(uint8_t messageType,
+                                             uint8_t commandCode)
+    {
+        return static_cast<uint16_t>((messageType << 8) | commandCode);
+    }
+
+    /** @brief Get the long-running lane of a message type and command code,
+     *         creating it on first use
+     */
+    LongRunningLane& getLongRunningLane(uint8_t messageType,
+                                        uint8_t commandCode);
+
+    // Long-running lanes by message type and command code, the semaphore of
+    // a lane is awaited across its operations so a lane never moves
+    std::unordered_map<uint16_t, std::unique_ptr<LongRunningLane>>
+        longRunningLanes;
+    PollingState devicePollingState = POLL_NON_PRIORITY;
 
     /**
      * @brief Adds dynamic sensor to NsmDevice. It read dbus property 'Priority'
@@ -21,9 +21,20 @@
 #include "eventHandler.hpp"
 #include "sensorManager.hpp"
 
+#include <cstring>
+
 namespace nsm
 {
 
+std::shared_ptr<const nsm_msg> NsmEvent::copyEvent(const nsm_msg* event,
+                                                   size_t eventLen)
+{
+    auto buffer = std::make_shared_for_overwrite<uint8_t[]>(eventLen);
+    memcpy(buffer.get(), event, eventLen);
+    return std::shared_ptr<const nsm_msg>(
+        buffer, reinterpret_cast<const nsm_msg*>(buffer.get()));
+}
+
 int logEvent(const std::string& messageId, Level level,
              const std::map<std::string, std::string>& data)
 {
@@ -70,8 +81,8 @@ int EventDispatcher::addEvent(NsmType type, NsmEventId eventId,
     return NSM_SW_SUCCESS;
 }
 
-int EventDispatcher::handle(eid_t eid, NsmType type, NsmEventId eventId,
-                            const nsm_msg* event, size_t eventLen) const
+std::shared_ptr<NsmEvent> EventDispatcher::findEvent(eid_t eid, NsmType type,
+                                                     NsmEventId eventId) const
 {
     auto events = eventsMap.find(type);
     if (events == eventsMap.end())
@@ -79,7 +90,7 @@ int EventDispatcher::handle(eid_t eid, NsmType type, NsmEventId eventId,
         lg2::error(
             "No NsmEvents found for NSM Message Type {TYPE} : EventId={ID}, EID={EID}",
             "TYPE", type, "ID", eventId, "EID", eid);
-        return NSM_SW_ERROR_DATA;
+        return nullptr;
     }
 
     auto eventObj = events->second.find(eventId);
@@ -88,10 +99,35 @@ int EventDispatcher::handle(eid_t eid, NsmType type, NsmEventId eventId,
         lg2::error(
             "No NsmEvent found for EventId {ID} in NSM Message Type {TYPE} : EID={EID}",
             "ID", eventId, "TYPE", type, "EID", eid);
+        return nullptr;
+    }
+
+    return eventObj->second;
+}
+
+int EventDispatcher::handle(eid_t eid, NsmType type, NsmEventId eventId,
+                            const nsm_msg* event, size_t eventLen) const
+{
+    auto eventObj = findEvent(eid, type, eventId);
+    if (!eventObj)
+    {
+        return NSM_SW_ERROR_DATA;
+    }
+
+    return eventObj->handle(eid, type, eventId, event, eventLen);
+}
+
+int EventDispatcher::handle(eid_t eid, NsmType type, NsmEventId eventId,
+                            const std::shared_ptr<const nsm_msg>& event,
+                            size_t eventLen) const
+{
+    auto eventObj = findEvent(eid, type, eventId);
+    if (!eventObj)
+    {
         return NSM_SW_ERROR_DATA;
     }
 
-    return eventObj->second->handle(eid, type, eventId, event, eventLen);
+    return eventObj->handleEventBuffer(eid, type, eventId, event, eventLen);
 }
 
 int DelegatingEventHandler::enableDelegation(NsmEventId eventId)
@@ -110,9 +146,9 @@ int DelegatingEventHandler::enableDelegation(NsmEventId eventId)
     return NSM_SW_SUCCESS;
 }
 
-void DelegatingEventHandler::delegate(eid_t eid, NsmType type,
-                                      NsmEventId eventId, const nsm_msg* event,
-                                      size_t eventLen)
+void DelegatingEventHandler::delegate(
+    eid_t eid, NsmType type, NsmEventId eventId,
+    const std::shared_ptr<const nsm_msg>& event, size_t eventLen)
 {
     DeviceManager& deviceManager = DeviceManager::getInstance();
     SensorManager& sensorManager = SensorManager::getInstance();
@@ -40,6 +40,17 @@ class NsmEvent
     virtual int handle(eid_t eid, NsmType type, NsmEventId eventId,
                        const nsm_msg* event, size_t eventLen) = 0;
 
+    /** @brief Handle an event held in a reference counted buffer. Events
+     *  which keep the message beyond the call override this to retain the
+     *  buffer instead of copying it.
+     */
+    virtual int handleEventBuffer(eid_t eid, NsmType type, NsmEventId eventId,
+                                  const std::shared_ptr<const nsm_msg>& event,
+                                  size_t eventLen)
+    {
+        return handle(eid, type, eventId, event.get(), eventLen);
+    }
+
     const std::string& getName() const
     {
         return name;
@@ -50,6 +61,13 @@ class NsmEvent
         return type;
     }
 
+  protected:
+    /** @brief Copy an event into a reference counted buffer, for the callers
+     *  of handle() which do not own the event
+     */
+    static std::shared_ptr<const nsm_msg> copyEvent(const nsm_msg* event,
+                                                    size_t eventLen);
+
   private:
     const std::string name;
     const std::string type;
@@ -66,7 +84,14 @@ class EventDispatcher
     int handle(eid_t eid, NsmType type, NsmEventId eventId,
                const nsm_msg* event, size_t eventLen) const;
 
+    int handle(eid_t eid, NsmType type, NsmEventId eventId,
+               const std::shared_ptr<const nsm_msg>& event,
+               size_t eventLen) const;
+
   private:
+    std::shared_ptr<NsmEvent> findEvent(eid_t eid, NsmType type,
+                                        NsmEventId eventId) const;
+
     std::unordered_map<
         NsmType, std::unordered_map<NsmEventId, std::shared_ptr<NsmEvent>>>
         eventsMap{};
@@ -79,7 +104,7 @@ class DelegatingEventHandler : public EventHandler
 
   private:
     void delegate(eid_t eid, NsmType type, NsmEventId eventId,
-                  const nsm_msg* event, size_t eventLen);
+                  const std::shared_ptr<const nsm_msg>& event, size_t eventLen);
 };
 
 } // namespace nsm
@@ -29,6 +29,14 @@ NsmLongRunningEventHandler::NsmLongRunningEventHandler() :
 int NsmLongRunningEventHandler::handle(eid_t eid, NsmType type,
                                        NsmEventId eventId, const nsm_msg* event,
                                        size_t eventLen)
+{
+    return handleEventBuffer(eid, type, eventId, copyEvent(event, eventLen),
+                             eventLen);
+}
+
+int NsmLongRunningEventHandler::handleEventBuffer(
+    eid_t eid, NsmType type, NsmEventId eventId,
+    const std::shared_ptr<const nsm_msg>& event, size_t eventLen)
 {
     DeviceManager& deviceManager = DeviceManager::getInstance();
     SensorManager& sensorManager = SensorManager::getInstance();
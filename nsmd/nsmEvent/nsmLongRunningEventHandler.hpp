@@ -32,6 +32,9 @@ class NsmLongRunningEventHandler : public NsmEvent
   private:
     int handle(eid_t eid, NsmType type, NsmEventId eventId,
                const nsm_msg* event, size_t eventLen) override;
+    int handleEventBuffer(eid_t eid, NsmType type, NsmEventId eventId,
+                          const std::shared_ptr<const nsm_msg>& event,
+                          size_t eventLen) override;
 };
 
 } // namespace nsm
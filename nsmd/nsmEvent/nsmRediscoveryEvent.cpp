@@ -92,6 +92,8 @@ int NsmRediscoveryEvent::handle(eid_t eid, NsmType /*type*/,
             lg2::info(
                 "Rediscovery event : The NSM device has been discovered for , uuid={UUID}",
                 "UUID", uuid);
+            // the capabilities and static values may have changed
+            nsmDevice->expediteSensors();
             deviceManager.updateNsmDevice(nsmDevice, eid).detach();
         }
         else
@@ -20,6 +20,7 @@
 #include "platform-environmental.h"
 
 #include "dBusAsyncUtils.hpp"
+#include "nsmDevice.hpp"
 #include "sensorManager.hpp"
 
 #include <fmt/args.h>
@@ -78,6 +79,14 @@ int NsmResetRequiredEvent::handle(eid_t eid, NsmType /*type*/,
 
     logEvent("NsmResetRequiredEvent", info.severity, eventData);
 
+    // A pending configuration change, such as the ECC or MIG mode, is
+    // reported by the stable sensors of the device. The EID may not be
+    // bound yet after discovery, resolve it like a request to it would.
+    if (auto nsmDevice = SensorManager::getInstance().resolveNsmDevice(eid))
+    {
+        nsmDevice->expediteSensors();
+    }
+
     return NSM_SW_SUCCESS;
 }
 
@@ -32,6 +32,17 @@ class NsmSubSensor
   public:
     virtual uint8_t handleResponse(const nsm_msg* responseMsg,
                                    size_t responseLen) = 0;
+
+    /** @brief Handle a response held in a reference counted buffer, shared
+     *  by all subsensors of the group. Subsensors which keep the response
+     *  beyond the call override this to retain the buffer.
+     */
+    virtual uint8_t
+        handleResponseBuffer(const std::shared_ptr<const nsm_msg>& responseMsg,
+                             size_t responseLen)
+    {
+        return handleResponse(responseMsg.get(), responseLen);
+    }
 };
 
 /**
@@ -60,6 +71,26 @@ class NsmGroupSensor : public NsmSensor, public NsmSubSensor
         return rc;
     }
 
+    uint8_t
+        handleResponseBuffer(const std::shared_ptr<const nsm_msg>& responseMsg,
+                             size_t responseLen) override final
+    {
+        uint8_t rc = handleResponse(responseMsg.get(), responseLen);
+        if (rc != NSM_SW_SUCCESS)
+        {
+            return rc;
+        }
+        for (auto sensor : sensors)
+        {
+            rc = sensor->handleResponseBuffer(responseMsg, responseLen);
+            if (rc != NSM_SW_SUCCESS)
+            {
+                break;
+            }
+        }
+        return rc;
+    }
+
   public:
     using NsmSensor::NsmSensor;
     std::vector<std::shared_ptr<NsmSubSensor>> sensors;
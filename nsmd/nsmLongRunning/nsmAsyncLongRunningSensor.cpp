@@ -39,7 +39,7 @@ requester::Coroutine NsmAsyncLongRunningSensor::update(SensorManager& manager,
     uint8_t rc = NSM_SW_SUCCESS;
 
     // Acquire the semaphore before proceeding
-    co_await device->getSemaphore().acquire(eid);
+    co_await device->getSemaphore(messageType, commandCode).acquire(eid);
     // by default command will be treated as long running
     isLongRunning = true;
     // Register the active handler in the device with messageType and
@@ -68,9 +68,9 @@ requester::Coroutine NsmAsyncLongRunningSensor::update(SensorManager& manager,
     }
 
     // Unregister the active handler in the device
-    device->clearLongRunningHandler();
+    device->clearLongRunningHandler(messageType, commandCode);
     // Release the semaphore after the update is complete
-    device->getSemaphore().release();
+    device->getSemaphore(messageType, commandCode).release();
 
     // coverity[missing_return]
     co_return rc;
@@ -113,7 +113,7 @@ requester::Coroutine
     {
         // treat it as normal request and return here itself
         isLongRunning = false;
-        rc = handleResponseMsg(responseMsg.get(), responseLen);
+        rc = handleResponseBuffer(responseMsg, responseLen);
         // coverity[missing_return]
         co_return rc;
     }
@@ -136,13 +136,22 @@ requester::Coroutine
     co_return rc;
 }
 
-int NsmAsyncLongRunningSensor::handle(eid_t eid, NsmType, NsmEventId,
-                                      const nsm_msg* event, size_t eventLen)
+int NsmAsyncLongRunningSensor::handle(eid_t eid, NsmType type,
+                                      NsmEventId eventId, const nsm_msg* event,
+                                      size_t eventLen)
 {
-    int rc = validateEvent(eid, event, eventLen);
+    return handleEventBuffer(eid, type, eventId, copyEvent(event, eventLen),
+                             eventLen);
+}
+
+int NsmAsyncLongRunningSensor::handleEventBuffer(
+    eid_t eid, NsmType, NsmEventId,
+    const std::shared_ptr<const nsm_msg>& event, size_t eventLen)
+{
+    int rc = validateEvent(eid, event.get(), eventLen);
     if (rc == NSM_SW_SUCCESS)
     {
-        rc = handleResponseMsg(event, eventLen);
+        rc = handleResponseBuffer(event, eventLen);
     }
     if (!timer.stop())
     {
@@ -36,6 +36,9 @@ class NsmAsyncLongRunningSensor :
                                        uint8_t commandCode);
     int handle(eid_t eid, NsmType type, NsmEventId eventId,
                const nsm_msg* event, size_t eventLen) override;
+    int handleEventBuffer(eid_t eid, NsmType type, NsmEventId eventId,
+                          const std::shared_ptr<const nsm_msg>& event,
+                          size_t eventLen) override;
 
   private:
     requester::Coroutine update(SensorManager& manager,
@@ -41,7 +41,7 @@ requester::Coroutine NsmLongRunningSensor::update(SensorManager& manager,
     uint8_t rc = NSM_SW_SUCCESS;
 
     // Acquire the semaphore before proceeding
-    co_await device->getSemaphore().acquire(eid);
+    co_await device->getSemaphore(messageType, commandCode).acquire(eid);
     // by default command will be treated as long running
     isLongRunning = true;
     // Register the active handler in the device with messageType and
@@ -68,10 +68,15 @@ requester::Coroutine NsmLongRunningSensor::update(SensorManager& manager,
         }
     }
 
+    if (rc != NSM_SW_SUCCESS)
+    {
+        trackResponse(nullptr, 0, rc);
+    }
+
     // Unregister the active handler in the device
-    device->clearLongRunningHandler();
+    device->clearLongRunningHandler(messageType, commandCode);
     // Release the semaphore after the update is complete
-    device->getSemaphore().release();
+    device->getSemaphore(messageType, commandCode).release();
 
     // coverity[missing_return]
     co_return rc;
@@ -114,7 +119,8 @@ requester::Coroutine
     {
         // treat it as normal request and return here itself
         isLongRunning = false;
-        rc = handleResponseMsg(responseMsg.get(), responseLen);
+        rc = handleResponseBuffer(responseMsg, responseLen);
+        trackResponse(responseMsg.get(), responseLen, rc);
         // coverity[missing_return]
         co_return rc;
     }
@@ -137,14 +143,23 @@ requester::Coroutine
     co_return rc;
 }
 
-int NsmLongRunningSensor::handle(eid_t eid, NsmType, NsmEventId,
+int NsmLongRunningSensor::handle(eid_t eid, NsmType type, NsmEventId eventId,
                                  const nsm_msg* event, size_t eventLen)
 {
-    auto rc = validateEvent(eid, event, eventLen);
+    return handleEventBuffer(eid, type, eventId, copyEvent(event, eventLen),
+                             eventLen);
+}
+
+int NsmLongRunningSensor::handleEventBuffer(
+    eid_t eid, NsmType, NsmEventId,
+    const std::shared_ptr<const nsm_msg>& event, size_t eventLen)
+{
+    auto rc = validateEvent(eid, event.get(), eventLen);
     if (rc == NSM_SW_SUCCESS)
     {
-        rc = handleResponseMsg(event, eventLen);
+        rc = handleResponseBuffer(event, eventLen);
     }
+    trackResponse(event.get(), eventLen, rc);
     if (!timer.stop())
     {
         lg2::error(
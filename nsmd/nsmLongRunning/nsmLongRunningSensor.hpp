@@ -37,6 +37,9 @@ class NsmLongRunningSensor : public NsmSensor, public NsmLongRunningEvent
                                                  eid_t eid);
     int handle(eid_t eid, NsmType type, NsmEventId eventId,
                const nsm_msg* event, size_t eventLen) override;
+    int handleEventBuffer(eid_t eid, NsmType type, NsmEventId eventId,
+                          const std::shared_ptr<const nsm_msg>& event,
+                          size_t eventLen) override;
     std::shared_ptr<NsmDevice> device = nullptr;
     uint8_t messageType;
     uint8_t commandCode;
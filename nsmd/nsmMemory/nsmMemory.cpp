@@ -118,6 +118,7 @@ NsmRowRemapState::NsmRowRemapState(
 {
     lg2::info("NsmRowRemapIntf: create sensor:{NAME}", "NAME", name.c_str());
     memoryRowRemappingStateIntf = memoryRowRemappingIntf;
+    setAdaptivePolling(true);
     updateMetricOnSharedMemory();
 }
 
@@ -203,6 +204,7 @@ NsmRowRemappingCounts::NsmRowRemappingCounts(
     lg2::info("NsmRowRemappingCount: create sensor:{NAME}", "NAME",
               name.c_str());
     memoryRowRemappingCountsIntf = memoryRowRemappingIntf;
+    setAdaptivePolling(true);
     updateMetricOnSharedMemory();
 }
 
@@ -829,6 +831,8 @@ requester::Coroutine createNsmMemorySensor(SensorManager& manager,
                 bus, inventoryObjPath.c_str());
             auto sensor = std::make_shared<NsmEccErrorCountsDram>(
                 name, type, eccModeIntf, inventoryObjPath);
+            sensor->setPollingPeriod(
+                co_await coGetPollingPeriodInUsec(objPath, interface));
             if (priority)
             {
                 nsmDevice->prioritySensors.push_back(sensor);
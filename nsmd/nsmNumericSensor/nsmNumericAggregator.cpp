@@ -75,8 +75,8 @@ int NsmNumericAggregator::updateSensorNotWorking(uint8_t tag, bool valid)
 requester::Coroutine NsmNumericAggregator::update(SensorManager& manager,
                                                   eid_t eid)
 {
-    auto requestMsg = genRequestMsg(eid, 0);
-    if (!requestMsg.has_value())
+    auto requestMsg = getRequestTemplate(eid);
+    if (!requestMsg)
     {
         lg2::error(
             "NsmNumericAggregator::update: genRequestMsg failed, name={NAME}, eid={EID}",
@@ -86,7 +86,7 @@ requester::Coroutine NsmNumericAggregator::update(SensorManager& manager,
 
     std::shared_ptr<const nsm_msg> responseMsg;
     size_t responseLen = 0;
-    auto rc = co_await manager.SendRecvNsmMsg(eid, *requestMsg, responseMsg,
+    auto rc = co_await manager.SendRecvNsmMsg(eid, requestMsg, responseMsg,
                                               responseLen);
     if (rc)
     {
@@ -101,7 +101,7 @@ requester::Coroutine NsmNumericAggregator::update(SensorManager& manager,
         co_return rc;
     }
 
-    rc = handleResponseMsg(responseMsg.get(), responseLen);
+    rc = handleResponseBuffer(responseMsg, responseLen);
     co_return rc;
 }
 } // namespace nsm
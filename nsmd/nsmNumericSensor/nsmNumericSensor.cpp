@@ -298,8 +298,8 @@ void NsmNumericSensorCompositeChildValue::updateReading(double value,
 
 requester::Coroutine NsmNumericSensor::update(SensorManager& manager, eid_t eid)
 {
-    auto requestMsg = genRequestMsg(eid, 0);
-    if (!requestMsg.has_value())
+    auto requestMsg = getRequestTemplate(eid);
+    if (!requestMsg)
     {
         lg2::error(
             "NsmNumericSensorComposite::update: genRequestMsg failed, name={NAME}, eid={EID}",
@@ -309,7 +309,7 @@ requester::Coroutine NsmNumericSensor::update(SensorManager& manager, eid_t eid)
 
     std::shared_ptr<const nsm_msg> responseMsg;
     size_t responseLen = 0;
-    auto rc = co_await manager.SendRecvNsmMsg(eid, *requestMsg, responseMsg,
+    auto rc = co_await manager.SendRecvNsmMsg(eid, requestMsg, responseMsg,
                                               responseLen);
     if (rc)
     {
@@ -321,7 +321,7 @@ requester::Coroutine NsmNumericSensor::update(SensorManager& manager, eid_t eid)
         co_return rc;
     }
 
-    rc = handleResponseMsg(responseMsg.get(), responseLen);
+    rc = handleResponseBuffer(responseMsg, responseLen);
     co_return rc;
 }
 } // namespace nsm
@@ -99,6 +99,9 @@ requester::Coroutine NumericSensorFactory::make(SensorManager& manager,
     catch (const std::exception& e)
     {}
 
+    info.pollingPeriodInUsec = co_await coGetPollingPeriodInUsec(objPath,
+                                                                interface);
+
     co_await utils::coGetAssociations(objPath, interface + ".Associations",
                                       info.associations);
 
@@ -140,9 +143,12 @@ requester::Coroutine NumericSensorFactory::make(SensorManager& manager,
     makeAggregatorAndAddSensor(builder.get(), info, sensor, uuid,
                                nsmDevice.get());
 
+    const auto peakValuePollingPeriodInUsec =
+        co_await coGetPollingPeriodInUsec(objPath, interface + ".PeakValue");
     try
     {
-        makePeakValueAndAdd(interface, objPath, info, uuid, nsmDevice.get());
+        makePeakValueAndAdd(interface, objPath, info, uuid, nsmDevice.get(),
+                            peakValuePollingPeriodInUsec);
     }
     catch (const std::exception& e)
     {}
@@ -158,7 +164,8 @@ void NumericSensorFactory::makePeakValueAndAdd(const std::string& interface,
                                                const std::string& objPath,
                                                const NumericSensorInfo& info,
                                                const uuid_t& uuid,
-                                               NsmDevice* nsmDevice)
+                                               NsmDevice* nsmDevice,
+                                               uint64_t pollingPeriodInUsec)
 {
     auto& bus = utils::DBusHandler::getBus();
 
@@ -179,6 +186,8 @@ void NumericSensorFactory::makePeakValueAndAdd(const std::string& interface,
     peakValueInfo.aggregated = utils::DBusHandler().getDbusProperty<bool>(
         objPath.c_str(), "Aggregated", peakValueInterface.c_str());
 
+    peakValueInfo.pollingPeriodInUsec = pollingPeriodInUsec;
+
     if (info.type == "NSM_Power")
     {
         PeakPowerSensorBuilder builder;
@@ -240,6 +249,14 @@ void NumericSensorFactory::makeAggregatorAndAddSensor(
                 nsmDevice->roundRobinSensors.push_back(aggregator);
             }
         }
+
+        // The aggregator is polled at the shortest period of its sensors
+        const auto period = aggregator->getPollingPeriod();
+        if (info.pollingPeriodInUsec != 0 &&
+            (period == 0 || info.pollingPeriodInUsec < period))
+        {
+            aggregator->setPollingPeriod(info.pollingPeriodInUsec);
+        }
     }
 
     nsmDevice->deviceSensors.emplace_back(sensor);
@@ -263,6 +280,7 @@ void NumericSensorFactory::makeAggregatorAndAddSensor(
     }
     else
     {
+        sensor->setPollingPeriod(info.pollingPeriodInUsec);
         if (info.priority)
         {
             nsmDevice->prioritySensors.emplace_back(sensor);
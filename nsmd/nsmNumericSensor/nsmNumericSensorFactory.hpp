@@ -42,6 +42,8 @@ struct NumericSensorInfo
     double maxAllowableValue{std::numeric_limits<double>::infinity()};
     std::unique_ptr<std::string> readingBasis{};
     std::unique_ptr<std::string> description{};
+    // 0 when the sensor is polled at the period of its scheduler lane
+    uint64_t pollingPeriodInUsec{0};
 };
 
 class NumericSensorAggregatorBuilder
@@ -87,7 +89,8 @@ class NumericSensorFactory
     static void makePeakValueAndAdd(const std::string& interface,
                                     const std::string& objPath,
                                     const NumericSensorInfo& info,
-                                    const uuid_t& uuid, NsmDevice* nsmDevice);
+                                    const uuid_t& uuid, NsmDevice* nsmDevice,
+                                    uint64_t pollingPeriodInUsec);
 
   private:
     std::unique_ptr<NumericSensorBuilder> builder;
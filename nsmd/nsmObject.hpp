@@ -16,6 +16,7 @@
  */
 
 #pragma once
+#include "dBusAsyncUtils.hpp"
 #include "requester/handler.hpp"
 #include "types.hpp"
 #include "utils.hpp"
@@ -23,12 +24,17 @@
 #include <phosphor-logging/lg2.hpp>
 #include <tal.hpp>
 
+#include <utility>
+
 static constexpr const uint64_t INIT_TIMESTAMP =
     std::numeric_limits<uint64_t>().min();
 
 static constexpr const uint64_t DEFAULT_RR_REFRESH_LIMIT_IN_USEC =
     DEFAULT_RR_REFRESH_LIMIT_IN_MS * 1000;
 
+static constexpr const uint64_t ADAPTIVE_POLLING_MAX_PERIOD_IN_USEC =
+    static_cast<uint64_t>(ADAPTIVE_POLLING_MAX_PERIOD_IN_MS) * 1000;
+
 namespace nsm
 {
 
@@ -72,6 +78,56 @@ class NsmObject
         return (deltaInUsec > refreshLimitInUsec);
     }
 
+    uint64_t getRefreshLimit() const
+    {
+        return refreshLimitInUsec;
+    }
+
+    void setRefreshLimit(const uint64_t limitInUsec)
+    {
+        refreshLimitInUsec = limitInUsec;
+    }
+
+    /** @brief Polling period of the sensor in microseconds, 0 when the
+     *         sensor is polled at the period of its scheduler lane
+     */
+    uint64_t getPollingPeriod() const
+    {
+        return pollingPeriodInUsec;
+    }
+
+    void setPollingPeriod(const uint64_t periodInUsec)
+    {
+        pollingPeriodInUsec = periodInUsec;
+    }
+
+    /** @brief Let the scheduler stretch the polling period of the sensor
+     *         while its value stays the same
+     */
+    void setAdaptivePolling(const bool adaptive)
+    {
+        adaptivePolling = adaptive;
+    }
+
+    bool isAdaptivePolling() const
+    {
+        return adaptivePolling;
+    }
+
+    /** @brief Mark the value of the sensor changed, an adaptive sensor is
+     *         polled at its base period again
+     */
+    void markChanged()
+    {
+        changed = true;
+    }
+
+    /** @brief Whether the value changed since the last call */
+    bool takeChanged()
+    {
+        return std::exchange(changed, false);
+    }
+
     void logHandleResponseMsg(const std::string funcName,
                               const uint16_t& reason_code, const int& cc,
                               const int& rc)
@@ -152,9 +208,36 @@ class NsmObject
     const std::string type;
     uint64_t lastUpdatedTimeStampInUsec = INIT_TIMESTAMP;
     uint64_t refreshLimitInUsec = DEFAULT_RR_REFRESH_LIMIT_IN_USEC;
+    uint64_t pollingPeriodInUsec = 0;
+    bool adaptivePolling = false;
+    bool changed = true;
     utils::bitfield256_err_code cc_map;
     utils::bitfield256_err_code rc_map;
     std::string deviceIdentifier;
     // deviceIdentifier = deviceName_deviceInstanceNumber
 };
+
+/** @struct coGetPollingPeriodInUsec
+ *
+ *  Awaitable reading the optional PollingPeriod property of a sensor
+ *  configuration PDI, in milliseconds. The sensor must get the period before
+ *  it is added to the device.
+ *  e.g. auto period = co_await coGetPollingPeriodInUsec(objPath, interface);
+ *
+ *  The co_await returns the polling period in microseconds, 0 when it is not
+ *  configured.
+ */
+struct coGetPollingPeriodInUsec : utils::coGetOptionalDbusProperty<uint64_t>
+{
+    coGetPollingPeriodInUsec(const std::string& objPath,
+                             const std::string& interface) :
+        coGetOptionalDbusProperty(objPath, "PollingPeriod", interface)
+    {}
+
+    uint64_t await_resume() const noexcept
+    {
+        return ret.value_or(0) * 1000;
+    }
+};
+
 } // namespace nsm
@@ -27,7 +27,9 @@ NsmPowerSmoothing::NsmPowerSmoothing(
     std::shared_ptr<OemPowerSmoothingFeatIntf> pwrSmoothingIntf) :
     NsmSensor(name, type),
     pwrSmoothingIntf(pwrSmoothingIntf), inventoryObjPath(inventoryObjPath)
-{}
+{
+    setAdaptivePolling(true);
+}
 
 std::optional<std::vector<uint8_t>>
     NsmPowerSmoothing::genRequestMsg(eid_t eid, uint8_t instanceId)
@@ -190,7 +192,9 @@ NsmCurrentPowerSmoothingProfile::NsmCurrentPowerSmoothingProfile(
         pwrSmoothingSupportedCollectionSensor),
     adminProfileSensor(adminProfileSensor), inventoryObjPath(inventoryObjPath)
 
-{}
+{
+    setAdaptivePolling(true);
+}
 
 std::optional<std::vector<uint8_t>>
     NsmCurrentPowerSmoothingProfile::genRequestMsg(eid_t eid,
@@ -301,7 +305,9 @@ NsmPowerSmoothingAdminOverride::NsmPowerSmoothingAdminOverride(
     std::string& inventoryObjPath) :
     NsmSensor(name, type),
     adminProfileIntf(adminProfileIntf), inventoryObjPath(inventoryObjPath)
-{}
+{
+    setAdaptivePolling(true);
+}
 
 std::optional<std::vector<uint8_t>>
     NsmPowerSmoothingAdminOverride::genRequestMsg(eid_t eid, uint8_t instanceId)
@@ -393,7 +399,9 @@ NsmPowerProfileCollection::NsmPowerProfileCollection(
     std::shared_ptr<NsmDevice> device) :
     NsmSensor(name, type),
     inventoryObjPath(inventoryObjPath), device(device)
-{}
+{
+    setAdaptivePolling(true);
+}
 
 bool NsmPowerProfileCollection::hasProfileId(uint8_t profileId)
 
@@ -361,6 +361,7 @@ NsmMigMode::NsmMigMode(sdbusplus::bus::bus& bus, std::string& name,
 {
     lg2::info("NsmMigMode: create sensor:{NAME}", "NAME", name.c_str());
     migModeIntf = std::make_unique<MigModeIntf>(bus, inventoryObjPath.c_str());
+    setAdaptivePolling(true);
     updateMetricOnSharedMemory();
 }
 
@@ -440,6 +441,7 @@ NsmEccMode::NsmEccMode(std::string& name, std::string& type,
 
 {
     eccModeIntf = eccIntf;
+    setAdaptivePolling(true);
     updateMetricOnSharedMemory();
 }
 
@@ -1296,6 +1298,7 @@ NsmClockLimitGraphics::NsmClockLimitGraphics(
     lg2::info("NsmClockLimitGraphics: create sensor:{NAME}", "NAME",
               name.c_str());
     cpuOperatingConfigIntf = cpuConfigIntf;
+    setAdaptivePolling(true);
     updateMetricOnSharedMemory();
 }
 
@@ -3360,6 +3363,8 @@ requester::Coroutine createNsmProcessorSensor(SensorManager& manager,
         auto eccErrorCntSensor = std::make_shared<NsmEccErrorCounts>(
             name, type, eccIntf, inventoryObjPath);
 
+        eccErrorCntSensor->setPollingPeriod(
+            co_await coGetPollingPeriodInUsec(objPath, interface));
         nsmDevice->addSensor(eccErrorCntSensor, priority);
         nsmDevice->setSensors.emplace_back(setEccModeEnabled);
 
@@ -3432,6 +3437,10 @@ requester::Coroutine createNsmProcessorSensor(SensorManager& manager,
         nsmDevice->addStaticSensor(defaultBaseClockSpeed);
         nsmDevice->addStaticSensor(defaultBoostClockSpeed);
 
+        const auto pollingPeriodInUsec =
+            co_await coGetPollingPeriodInUsec(objPath, interface);
+        clockFreqSensor->setPollingPeriod(pollingPeriodInUsec);
+        clockLimitSensor->setPollingPeriod(pollingPeriodInUsec);
         nsmDevice->addSensor(clockFreqSensor, priority);
         nsmDevice->addSensor(clockLimitSensor, priority);
         nsmDevice->addSensor(currentUtilization, priority, isLongRunning);
@@ -91,7 +91,8 @@ requester::Coroutine NsmRawCommandHandler::doSendLongRunningRequest(
         }
 
         // Acquire the semaphore before proceeding
-        co_await device->getSemaphore().acquire(device->eid);
+        co_await device->getSemaphore(messageType, commandCode)
+            .acquire(device->eid);
         // Create the long-running event handler
         auto longRunningHandler =
             std::make_shared<NsmRawLongRunningEventHandler>(
@@ -113,8 +114,11 @@ requester::Coroutine NsmRawCommandHandler::doSendLongRunningRequest(
         auto eid = manager.getEid(device);
         std::shared_ptr<const nsm_msg> responseMsg;
         size_t responseLen = 0;
-        rc = co_await manager.SendRecvNsmMsg(eid, request, responseMsg,
-                                             responseLen);
+        rc = co_await requester::withRequestClass(
+            requester::RequestClass::User, [&] {
+            return manager.SendRecvNsmMsg(eid, request, responseMsg,
+                                          responseLen);
+        });
         uint8_t cc;
         uint16_t reasonCode = 0;
         if (rc == NSM_ERR_UNSUPPORTED_COMMAND_CODE)
@@ -192,8 +196,8 @@ requester::Coroutine NsmRawCommandHandler::doSendLongRunningRequest(
         statusInterface->status(AsyncOperationStatusType::InternalFailure);
     }
     // degister handler and release semaphore
-    device->clearLongRunningHandler();
-    device->getSemaphore().release();
+    device->clearLongRunningHandler(messageType, commandCode);
+    device->getSemaphore(messageType, commandCode).release();
     // coverity[missing_return]
     co_return rc;
 }
@@ -245,8 +249,11 @@ requester::Coroutine NsmRawCommandHandler::doSendRequest(
         auto eid = manager.getEid(device);
         std::shared_ptr<const nsm_msg> responseMsg;
         size_t responseLen = 0;
-        rc = co_await manager.SendRecvNsmMsg(eid, request, responseMsg,
-                                             responseLen);
+        rc = co_await requester::withRequestClass(
+            requester::RequestClass::User, [&] {
+            return manager.SendRecvNsmMsg(eid, request, responseMsg,
+                                          responseLen);
+        });
 
         uint8_t cc;
         uint16_t reasonCode;
@@ -16,14 +16,43 @@
  */
 #include "nsmSensor.hpp"
 
+#include "base.h"
 #include "sensorManager.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
 namespace nsm
 {
+namespace
+{
+/** @brief Compare two encoded requests, ignoring their instance ID
+ */
+bool sameRequest(const Request& lhs, const Request& rhs)
+{
+    if (lhs.size() != rhs.size() || lhs.size() < sizeof(nsm_msg_hdr))
+    {
+        return lhs == rhs;
+    }
+
+    nsm_msg_hdr lhsHdr;
+    nsm_msg_hdr rhsHdr;
+    std::memcpy(&lhsHdr, lhs.data(), sizeof(lhsHdr));
+    std::memcpy(&rhsHdr, rhs.data(), sizeof(rhsHdr));
+    lhsHdr.instance_id = 0;
+    rhsHdr.instance_id = 0;
+    return std::memcmp(&lhsHdr, &rhsHdr, sizeof(nsm_msg_hdr)) == 0 &&
+           std::equal(lhs.begin() + sizeof(nsm_msg_hdr), lhs.end(),
+                      rhs.begin() + sizeof(nsm_msg_hdr));
+}
+} // namespace
+
 requester::Coroutine NsmSensor::update(SensorManager& manager, eid_t eid)
 {
-    auto requestMsg = genRequestMsg(eid, 0);
-    if (!requestMsg.has_value())
+    auto requestMsg = getRequestTemplate(eid);
+    if (!requestMsg)
     {
         lg2::error(
             "NsmSensor::update: genRequestMsg failed, name={NAME}, eid={EID}",
@@ -34,26 +63,69 @@ requester::Coroutine NsmSensor::update(SensorManager& manager, eid_t eid)
 
     std::shared_ptr<const nsm_msg> responseMsg;
     size_t responseLen = 0;
-    auto rc = co_await manager.SendRecvNsmMsg(eid, *requestMsg, responseMsg,
+    auto rc = co_await manager.SendRecvNsmMsg(eid, requestMsg, responseMsg,
                                               responseLen);
     if (rc)
     {
+        trackResponse(nullptr, 0, rc);
         // coverity[missing_return]
         co_return rc;
     }
 
-    rc = handleResponseMsg(responseMsg.get(), responseLen);
+    rc = handleResponseBuffer(responseMsg, responseLen);
+    trackResponse(responseMsg.get(), responseLen, rc);
     // coverity[missing_return]
     co_return rc;
 }
 
+void NsmSensor::trackResponse(const nsm_msg* responseMsg, size_t responseLen,
+                              uint8_t rc)
+{
+    if (!isAdaptivePolling())
+    {
+        return;
+    }
+    if (rc != NSM_SW_SUCCESS || !responseMsg ||
+        responseLen < sizeof(nsm_msg_hdr))
+    {
+        responseDigest.reset();
+        markChanged();
+        return;
+    }
+
+    // the header carries the instance ID, which differs on every poll
+    auto digest = std::hash<std::string_view>{}(std::string_view(
+        reinterpret_cast<const char*>(responseMsg) + sizeof(nsm_msg_hdr),
+        responseLen - sizeof(nsm_msg_hdr)));
+    if (responseDigest != digest)
+    {
+        responseDigest = digest;
+        markChanged();
+    }
+}
+
+RequestTemplate NsmSensor::getRequestTemplate(eid_t eid)
+{
+    if (!requestTemplate)
+    {
+        auto requestMsg = genRequestMsg(eid, 0);
+        if (requestMsg.has_value())
+        {
+            requestTemplate =
+                std::make_shared<const Request>(std::move(*requestMsg));
+        }
+    }
+    return requestTemplate;
+}
+
 bool NsmSensor::equals(const NsmSensor& other) const
 {
     // name and type are used only for debbuging purposes
     // comparing shall be only based on the request data sended to the device
-    auto requestMsg = const_cast<NsmSensor*>(this)->genRequestMsg(0, 0);
-    auto sensorRequestMsg = const_cast<NsmSensor&>(other).genRequestMsg(0, 0);
-    return requestMsg && sensorRequestMsg && *requestMsg == *sensorRequestMsg;
+    auto requestMsg = const_cast<NsmSensor*>(this)->getRequestTemplate(0);
+    auto sensorRequestMsg = const_cast<NsmSensor&>(other).getRequestTemplate(0);
+    return requestMsg && sensorRequestMsg &&
+           sameRequest(*requestMsg, *sensorRequestMsg);
 }
 
 bool NsmSensor::operator==(const NsmSensor& other) const
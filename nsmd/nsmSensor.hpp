@@ -39,11 +39,59 @@ class NsmSensor : public NsmObject
     virtual uint8_t handleResponseMsg(const nsm_msg* responseMsg,
                                       size_t responseLen) = 0;
 
+    /** @brief Handle a response held in a reference counted buffer. Sensors
+     *  which keep the response beyond the call override this to retain the
+     *  buffer instead of copying it.
+     */
+    virtual uint8_t
+        handleResponseBuffer(const std::shared_ptr<const nsm_msg>& responseMsg,
+                             size_t responseLen)
+    {
+        return handleResponseMsg(responseMsg.get(), responseLen);
+    }
+
     virtual requester::Coroutine update(SensorManager& manager,
                                         eid_t eid) override;
 
+    /** @brief Get the encoded request of the sensor. The request is encoded
+     *  by genRequestMsg() on first use and shared by the later polls, the
+     *  requester only patches the instance ID in.
+     *
+     *  @param[in] eid - endpoint ID of the device
+     *
+     *  @return the request template, nullptr if encoding the request failed
+     */
+    RequestTemplate getRequestTemplate(eid_t eid);
+
+    /** @brief Drop the cached request. Sensors whose request depends on
+     *  state which changes after construction call this when it changes.
+     */
+    void invalidateRequestTemplate()
+    {
+        requestTemplate.reset();
+    }
+
     virtual bool equals(const NsmSensor& other) const;
     bool operator==(const NsmSensor& other) const;
+
+  protected:
+    /** @brief Follow the value of an adaptive sensor through its responses.
+     *  A payload which differs from the previous one, or a failed update,
+     *  marks the sensor changed.
+     *
+     *  @param[in] responseMsg - response of the update, may be nullptr
+     *  @param[in] responseLen - length of the response
+     *  @param[in] rc - result of the update
+     */
+    void trackResponse(const nsm_msg* responseMsg, size_t responseLen,
+                       uint8_t rc);
+
+  private:
+    /** @brief Request encoded on first use by getRequestTemplate() */
+    RequestTemplate requestTemplate;
+
+    /** @brief Hash of the payload of the last successful response */
+    std::optional<size_t> responseDigest;
 };
 
 } // namespace nsm
@@ -217,7 +217,18 @@ requester::Coroutine AsyncSetOperationDispatcher::setImpl(
 
     try
     {
-        co_await operation.handler(value, &status, operation.device);
+        // User initiated, sent ahead of queued telemetry of the device
+        co_await requester::withRequestClass(
+            requester::RequestClass::User, [&] {
+            return operation.handler(value, &status, operation.device);
+        });
+
+        // The set changed a value, poll it at its base period again. Sets
+        // without a sensor refreshing the value may change any sensor.
+        if (operation.device)
+        {
+            operation.device->expediteSensors(operation.sensor.get());
+        }
 
         if (operation.sensor)
         {
@@ -225,8 +236,11 @@ requester::Coroutine AsyncSetOperationDispatcher::setImpl(
             {
                 const eid_t eid =
                     SensorManager::getInstance().getEid(operation.device);
-                co_await operation.sensor->update(SensorManager::getInstance(),
-                                                  eid);
+                co_await requester::withRequestClass(
+                    requester::RequestClass::User, [&] {
+                    return operation.sensor->update(
+                        SensorManager::getInstance(), eid);
+                });
             }
         }
     }
@@ -68,7 +68,7 @@ requester::Coroutine NsmAsyncSensor::update(SensorManager& manager, eid_t eid)
         co_return rc;
     }
 
-    rc = handleResponseMsg(responseMsg.get(), responseLen);
+    rc = handleResponseBuffer(responseMsg, responseLen);
 
     if (rc != NSM_SW_SUCCESS)
     {
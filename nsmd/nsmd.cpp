@@ -29,6 +29,14 @@
 #include "sensorManager.hpp"
 #include "socket_handler.hpp"
 #include "socket_manager.hpp"
+#include "threaded_socket_handler.hpp"
+#ifdef NSM_IO_URING
+#include "uring_socket_handler.hpp"
+#endif
+#ifdef NSM_LOOPBACK
+#include "loopback_socket_handler.hpp"
+#include "mockupResponder/mockupResponder.hpp"
+#endif
 
 #include <err.h>
 #include <getopt.h>
@@ -43,6 +51,12 @@
 #include <tal.hpp>
 
 #include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
 
 using namespace phosphor::logging;
 
@@ -52,19 +66,71 @@ void optionUsage(void)
     std::cerr << "Options:\n";
     std::cerr << " [--verbose] - would enable verbosity\n";
     std::cerr << " [--eid <EID>] - local EID\n";
+    std::cerr << " [--io-thread] - own the MCTP sockets in a dedicated thread\n";
+#ifdef NSM_IO_URING
+    std::cerr << " [--io-uring] - use io_uring for the MCTP sockets\n";
+#endif
+#ifdef NSM_LOOPBACK
+    std::cerr
+        << " [--loopback <EID>:<DeviceType>] - answer the EID from an in-process mockup responder [GPU, Switch, PCIeBridge, Baseboard and EROT], may be repeated\n";
+#endif
+}
+
+/** @brief Parse the <EID>:<DeviceType> argument of --loopback */
+static std::optional<std::pair<eid_t, uint8_t>>
+    parseLoopbackEndpoint(const std::string& arg)
+{
+    static const std::map<std::string, uint8_t> deviceTypes{
+        {"GPU", NSM_DEV_ID_GPU},
+        {"Switch", NSM_DEV_ID_SWITCH},
+        {"PCIeBridge", NSM_DEV_ID_PCIE_BRIDGE},
+        {"Baseboard", NSM_DEV_ID_BASEBOARD},
+        {"EROT", NSM_DEV_ID_EROT},
+    };
+
+    auto pos = arg.find(':');
+    if (pos == std::string::npos)
+    {
+        return std::nullopt;
+    }
+    auto deviceType = deviceTypes.find(arg.substr(pos + 1));
+    if (deviceType == deviceTypes.end())
+    {
+        return std::nullopt;
+    }
+    try
+    {
+        auto eid = std::stoi(arg.substr(0, pos));
+        if (eid < 0 || eid > 255)
+        {
+            return std::nullopt;
+        }
+        return std::make_pair(static_cast<eid_t>(eid), deviceType->second);
+    }
+    catch (const std::exception&)
+    {
+        return std::nullopt;
+    }
 }
 
 int main(int argc, char** argv)
 {
     bool verbose = false;
     int argflag;
+    bool ioUring = false;
+    bool ioThread = false;
+    std::vector<std::pair<eid_t, uint8_t>> loopbackEndpoints;
     int localEid = LOCAL_EID;
     static struct option long_options[] = {{"verbose", no_argument, 0, 'v'},
                                            {"help", no_argument, 0, 'h'},
                                            {"eid", required_argument, 0, 'e'},
+                                           {"io-uring", no_argument, 0, 'u'},
+                                           {"io-thread", no_argument, 0, 't'},
+                                           {"loopback", required_argument, 0,
+                                            'l'},
                                            {0, 0, 0, 0}};
 
-    while ((argflag = getopt_long(argc, argv, "hvre:", long_options,
+    while ((argflag = getopt_long(argc, argv, "hvrutl:e:", long_options,
                                   nullptr)) >= 0)
     {
         switch (argflag)
@@ -76,6 +142,23 @@ int main(int argc, char** argv)
             case 'v':
                 verbose = true;
                 break;
+            case 'u':
+                ioUring = true;
+                break;
+            case 't':
+                ioThread = true;
+                break;
+            case 'l':
+                if (auto endpoint = parseLoopbackEndpoint(optarg))
+                {
+                    loopbackEndpoints.push_back(*endpoint);
+                }
+                else
+                {
+                    optionUsage();
+                    exit(EXIT_FAILURE);
+                }
+                break;
             case 'e':
                 localEid = std::stoi(optarg);
                 if (localEid < 0 || localEid > 255)
@@ -109,7 +192,11 @@ int main(int argc, char** argv)
             bus, "/xyz/openbmc_project/inventory");
 
         bus.request_name("xyz.openbmc_project.NSM");
+#ifdef SHARED_INSTANCE_ID_DB
+        nsm::InstanceIdDb instanceIdDb(nsm::InstanceIdDb::defaultDbPath);
+#else
         nsm::InstanceIdDb instanceIdDb;
+#endif
         mctp_socket::Manager sockManager;
         nsm::EventManager eventManager;
         // corresponding to a UUID there could be multiple occurance of same eid
@@ -120,15 +207,93 @@ int main(int argc, char** argv)
         requester::Handler<requester::Request> reqHandler(event, instanceIdDb,
                                                           sockManager, verbose);
 
+#ifdef NSM_LOOPBACK
+        std::vector<std::unique_ptr<MockupResponder::MockupResponder>>
+            responders;
+#endif
+        std::unique_ptr<mctp_socket::Handler> sockHandler;
 #ifdef MCTP_IN_KERNEL
-        mctp_socket::InKernelHandler sockHandler(
-            event, reqHandler, eventManager, sockManager, verbose);
+        auto framing = mctp_socket::Framing::InKernel;
 #else
-        mctp_socket::DaemonHandler sockHandler(event, reqHandler, eventManager,
-                                               sockManager, verbose);
+        auto framing = mctp_socket::Framing::Demux;
 #endif
+#ifdef NSM_LOOPBACK
+        // The EIDs are still discovered over D-Bus, from the MCTP service or
+        // its emulation, but their messages never leave the process
+        if (!loopbackEndpoints.empty())
+        {
+            auto loopback = std::make_unique<mctp_socket::LoopbackHandler>(
+                event, reqHandler, eventManager, sockManager, verbose);
+            uint8_t instanceId = 0;
+            for (const auto& [eid, deviceType] : loopbackEndpoints)
+            {
+                auto& responder = *responders.emplace_back(
+                    std::make_unique<MockupResponder::MockupResponder>(
+                        verbose, event, objServer, eid, deviceType,
+                        instanceId++, false));
+                loopback->addResponder(
+                    eid, [&responder](const Request& rxMsg,
+                                      std::optional<Request>& longRunningEvent) {
+                    return responder.processRxMsg(rxMsg, longRunningEvent);
+                });
+            }
+            sockHandler = std::move(loopback);
+        }
+#else
+        if (!loopbackEndpoints.empty())
+        {
+            lg2::error("nsmd is built without loopback support");
+        }
+#endif
+#ifdef NSM_IO_URING
+        if (!sockHandler && ioUring)
+        {
+            try
+            {
+                sockHandler = std::make_unique<mctp_socket::IoUringHandler>(
+                    event, reqHandler, eventManager, sockManager, verbose,
+                    framing);
+            }
+            catch (const std::system_error& e)
+            {
+                lg2::error(
+                    "Failed to set up io_uring, using the socket handler. ERROR={ERROR}",
+                    "ERROR", e.what());
+            }
+        }
+#else
+        if (ioUring)
+        {
+            lg2::error("nsmd is built without io_uring support");
+        }
+#endif
+        if (!sockHandler && ioThread)
+        {
+            try
+            {
+                sockHandler = std::make_unique<mctp_socket::ThreadedHandler>(
+                    event, reqHandler, eventManager, sockManager, verbose,
+                    framing);
+            }
+            catch (const std::system_error& e)
+            {
+                lg2::error(
+                    "Failed to start the MCTP I/O thread, using the socket handler. ERROR={ERROR}",
+                    "ERROR", e.what());
+            }
+        }
+        if (!sockHandler)
+        {
+#ifdef MCTP_IN_KERNEL
+            sockHandler = std::make_unique<mctp_socket::InKernelHandler>(
+                event, reqHandler, eventManager, sockManager, verbose);
+#else
+            sockHandler = std::make_unique<mctp_socket::DaemonHandler>(
+                event, reqHandler, eventManager, sockManager, verbose);
+#endif
+        }
 
-        reqHandler.setSocketHandler(&sockHandler);
+        reqHandler.setSocketHandler(sockHandler.get());
 
         nsm::NsmDeviceTable nsmDevices;
 
@@ -138,7 +303,8 @@ int main(int argc, char** argv)
 
         // Initialize the singleton instance for on demand logging of critical
         // logs
-        nsm::NsmLogDumpTracker::initialize(bus, "/xyz/openbmc_project/NSM");
+        nsm::NsmLogDumpTracker::initialize(bus, "/xyz/openbmc_project/NSM",
+                                           reqHandler, *sockHandler);
 
         // Initialize the DeviceManager before getting its instance
         nsm::DeviceManager::initialize(event, reqHandler, instanceIdDb,
@@ -146,14 +312,15 @@ int main(int argc, char** argv)
         nsm::DeviceManager& deviceManager = nsm::DeviceManager::getInstance();
         std::unique_ptr<mctp::MctpDiscovery> mctpDiscoveryHandler =
             std::make_unique<mctp::MctpDiscovery>(
-                bus, sockHandler,
+                bus, *sockHandler,
                 std::initializer_list<mctp::MctpDiscoveryHandlerIntf*>{
                     &deviceManager});
 
         // Initialize the SensorManager before getting its instance
         nsm::SensorManagerImpl::initialize(bus, event, reqHandler, instanceIdDb,
                                            objServer, eidTable, nsmDevices,
-                                           localEid, sockManager, verbose);
+                                           localEid, sockManager,
+                                           eventManager, verbose);
 
         nsm::NsmRawCommandHandler::initialize(bus,
                                               "/xyz/openbmc_project/NSM/Raw");
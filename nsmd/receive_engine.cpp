@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "receive_engine.hpp"
+
+#include <algorithm>
+
+namespace mctp_socket
+{
+
+ReceiveEngine::ReceiveEngine(size_t batchSize, size_t bufferSize) :
+    bufferSize(bufferSize), pool(bufferSize, MCTP_RX_BUFFER_POOL_SIZE),
+    slots(batchSize), iovs(batchSize), addrs(batchSize), headers(batchSize)
+{
+    stats.batchHistogram.resize(batchSize + 1);
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+        slots[i] = pool.acquire();
+        iovs[i].iov_base = slots[i].get();
+        iovs[i].iov_len = bufferSize;
+        headers[i].msg_hdr = {};
+        headers[i].msg_hdr.msg_name = &addrs[i];
+        headers[i].msg_hdr.msg_iov = &iovs[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+    }
+    resetHeaders();
+}
+
+void ReceiveEngine::resetHeaders()
+{
+    for (size_t i = 0; i < headers.size(); ++i)
+    {
+        if (slots[i].use_count() > 1)
+        {
+            slots[i] = pool.acquire();
+            iovs[i].iov_base = slots[i].get();
+        }
+        auto& hdr = headers[i];
+        hdr.msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+        hdr.msg_hdr.msg_flags = 0;
+        hdr.msg_len = 0;
+    }
+}
+
+void ReceiveEngine::record(size_t handled)
+{
+    stats.wakeups++;
+    stats.messages += handled;
+    stats.lastBatch = handled;
+    stats.maxBatch = std::max(stats.maxBatch, handled);
+    stats.batchHistogram[std::min(handled,
+                                  stats.batchHistogram.size() - 1)]++;
+}
+
+} // namespace mctp_socket
@@ -0,0 +1,202 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.h"
+
+#include "libnsm/base.h"
+
+#include "buffer_pool.hpp"
+
+#include <sys/socket.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mctp_socket
+{
+
+/** @struct RxMessage
+ *
+ *  A received datagram. The data points into a pooled buffer which the
+ *  ReceiveEngine reuses once the callback returns, unless a consumer took a
+ *  reference to it with share().
+ */
+struct RxMessage
+{
+    uint8_t* data;
+    size_t length;
+    const sockaddr_storage& addr;
+    socklen_t addrLen;
+    const BufferPool::Buffer& buffer;
+
+    /** @brief Get a reference counted view of the NSM message starting at
+     *         the given offset, keeping the underlying buffer alive
+     */
+    std::shared_ptr<const nsm_msg> share(size_t offset) const
+    {
+        return std::shared_ptr<const nsm_msg>(
+            buffer, reinterpret_cast<const nsm_msg*>(data + offset));
+    }
+};
+
+/** @struct ReceiveStats
+ *
+ *  Counters of the ReceiveEngine. batchHistogram[n] is the number of wakeups
+ *  which handled n messages, the last bucket also counts larger batches.
+ */
+struct ReceiveStats
+{
+    uint64_t wakeups = 0;
+    uint64_t messages = 0;
+    uint64_t truncated = 0;
+    size_t lastBatch = 0;
+    size_t maxBatch = 0;
+    std::vector<uint64_t> batchHistogram;
+};
+
+/** @class ReceiveEngine
+ *
+ *  Drains a socket with recvmmsg into a ring of pooled buffers, so that a
+ *  wakeup of the event loop receives every pending datagram with as few
+ *  syscalls as possible and without any per-message heap allocation. A ring
+ *  slot whose buffer is still referenced by a consumer gets a fresh buffer
+ *  from the pool before the next receive.
+ */
+class ReceiveEngine
+{
+  public:
+    ReceiveEngine(const ReceiveEngine&) = delete;
+    ReceiveEngine(ReceiveEngine&&) = default;
+    ReceiveEngine& operator=(const ReceiveEngine&) = delete;
+    ReceiveEngine& operator=(ReceiveEngine&&) = default;
+    ~ReceiveEngine() = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] batchSize - number of datagrams received per recvmmsg
+     *  @param[in] bufferSize - size of each receive buffer in bytes
+     */
+    explicit ReceiveEngine(size_t batchSize = MCTP_RX_BATCH_SIZE,
+                           size_t bufferSize = MCTP_RX_BUFFER_SIZE);
+
+    /** @brief Receive every datagram pending on the socket
+     *
+     *  @param[in] fd - socket to receive from
+     *  @param[in] callback - invoked with each RxMessage, returns false to
+     *                        stop draining
+     *
+     *  @return number of handled messages, or -errno if the first recvmmsg
+     *          failed
+     */
+    template <typename Callback>
+    ssize_t drain(int fd, Callback&& callback)
+    {
+        size_t handled = 0;
+
+        for (size_t round = 0; round < maxRoundsPerWakeup; ++round)
+        {
+            resetHeaders();
+            int count = recvmmsg(fd, headers.data(), headers.size(),
+                                 MSG_DONTWAIT | MSG_TRUNC, nullptr);
+            if (count < 0)
+            {
+                int rc = -errno;
+                if (rc == -EAGAIN || rc == -EWOULDBLOCK || rc == -EINTR ||
+                    handled)
+                {
+                    break;
+                }
+                record(handled);
+                return rc;
+            }
+
+            for (int i = 0; i < count; ++i)
+            {
+                auto& hdr = headers[i];
+                if (hdr.msg_len > bufferSize ||
+                    (hdr.msg_hdr.msg_flags & MSG_TRUNC))
+                {
+                    stats.truncated++;
+                    lg2::error(
+                        "Dropping MCTP message larger than the receive buffer. Length={LEN}, BufferSize={SIZE}",
+                        "LEN", hdr.msg_len, "SIZE", bufferSize);
+                    continue;
+                }
+
+                ++handled;
+                RxMessage msg{slots[i].get(), hdr.msg_len, addrs[i],
+                              hdr.msg_hdr.msg_namelen, slots[i]};
+                if (!callback(msg))
+                {
+                    record(handled);
+                    return handled;
+                }
+            }
+
+            if (static_cast<size_t>(count) < headers.size())
+            {
+                // socket is empty
+                break;
+            }
+        }
+
+        record(handled);
+        return handled;
+    }
+
+    /** @brief Get the receive counters */
+    const ReceiveStats& getStats() const
+    {
+        return stats;
+    }
+
+    /** @brief Get the counters of the receive buffer pool */
+    const BufferPoolStats& getBufferStats() const
+    {
+        return pool.getStats();
+    }
+
+  private:
+    /** @brief Upper bound of recvmmsg calls per wakeup, so that a flooding
+     *         socket cannot starve the rest of the event loop
+     */
+    static constexpr size_t maxRoundsPerWakeup = 4;
+
+    size_t bufferSize;
+    BufferPool pool;
+    std::vector<BufferPool::Buffer> slots;
+    std::vector<iovec> iovs;
+    std::vector<sockaddr_storage> addrs;
+    std::vector<mmsghdr> headers;
+    ReceiveStats stats;
+
+    /** @brief Replace the buffers retained by consumers and restore the
+     *         fields recvmmsg updates on each header
+     */
+    void resetHeaders();
+
+    /** @brief Account a wakeup which handled the given number of messages */
+    void record(size_t handled);
+};
+
+} // namespace mctp_socket
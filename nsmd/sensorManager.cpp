@@ -25,6 +25,7 @@
 
 #include "common/sleep.hpp"
 #include "deviceManager.hpp"
+#include "eid_registry.hpp"
 #include "nsmObject.hpp"
 #include "nsmObjectFactory.hpp"
 #include "nsmSensor.hpp"
@@ -48,11 +49,13 @@ SensorManagerImpl::SensorManagerImpl(
     sdbusplus::asio::object_server& objServer,
     std::multimap<uuid_t, std::tuple<eid_t, MctpMedium, MctpBinding>>& eidTable,
     NsmDeviceTable& nsmDevices, eid_t localEid,
-    mctp_socket::Manager& sockManager, bool verbose) :
+    mctp_socket::Manager& sockManager, EventManager& eventManager,
+    bool verbose) :
     SensorManager(nsmDevices, localEid),
     bus(bus), event(event), handler(handler), instanceIdDb(instanceIdDb),
     objServer(objServer), eidTable(eidTable), sockManager(sockManager),
-    verbose(verbose), globalPollingStateManager(nsmDevices)
+    eventManager(eventManager), verbose(verbose),
+    globalPollingStateManager(event)
 {
     deferScanInventory = std::make_unique<sdeventplus::source::Defer>(
         event, std::bind(&SensorManagerImpl::scanInventory, this));
@@ -575,26 +578,27 @@ requester::Coroutine SensorManagerImpl::doPollingTaskLongRunning(
         {
             if (globalPollingStateManager.getState() != POLL_NON_PRIORITY)
             {
-                // Sleep for 20ms and then check again if we have time.
-                co_await common::Sleep(event.get(), 20000, common::Priority);
+                // Wait for the priority polling to end and then check again
+                // if we have time.
+                co_await globalPollingStateManager.waitForNonPriority(
+                    *nsmDevice);
                 sd_event_now(event.get(), CLOCK_MONOTONIC, &t1);
                 continue;
             }
 
             auto sensor = sensors[sensorIndex];
 
-            if (!sensor->needsUpdate(t1))
+            if (!sensor->needsUpdate(t1) ||
+                nsmDevice->longRunningSensorsInFlight.contains(sensor.get()))
             {
                 // Skip the LongRunning Sensor
                 ++sensorIndex;
                 continue;
             }
 
-            co_await sensor->update(*this, eid);
-
-            sd_event_now(event.get(), CLOCK_MONOTONIC, &t1);
-
-            sensor->setLastUpdatedTimeStamp(t1);
+            // The update waits for the completion event of its lane, the
+            // sensors of the other lanes are started meanwhile
+            updateLongRunningSensor(nsmDevice, sensor, eid).detach();
 
             ++sensorIndex;
         }
@@ -625,6 +629,30 @@ requester::Coroutine SensorManagerImpl::doPollingTaskLongRunning(
     co_return NSM_SW_SUCCESS;
 }
 
+requester::Coroutine SensorManagerImpl::updateLongRunningSensor(
+    std::shared_ptr<NsmDevice> nsmDevice, std::shared_ptr<NsmObject> sensor,
+    eid_t eid)
+{
+    nsmDevice->longRunningSensorsInFlight.insert(sensor.get());
+
+    auto rc = co_await requester::withRequestClass(
+        requester::RequestClass::RoundRobin,
+        [&] { return sensor->update(*this, eid); });
+
+    uint64_t t = 0;
+    sd_event_now(event.get(), CLOCK_MONOTONIC, &t);
+    sensor->setLastUpdatedTimeStamp(t);
+    // a stable adaptive sensor waits longer before its next update
+    sensor->setRefreshLimit(SensorScheduler::adaptPeriod(
+        *sensor, sensor->getRefreshLimit(), DEFAULT_RR_REFRESH_LIMIT_IN_USEC,
+        ADAPTIVE_POLLING_MAX_PERIOD_IN_USEC));
+
+    nsmDevice->longRunningSensorsInFlight.erase(sensor.get());
+
+    // coverity[missing_return]
+    co_return rc;
+}
+
 requester::Coroutine
     SensorManagerImpl::doPollingTask(std::shared_ptr<NsmDevice> nsmDevice)
 {
@@ -686,110 +714,97 @@ requester::Coroutine
 
         eid_t eid = getEid(nsmDevice);
         hasFailedToSearchEID = false;
-#if false
-//place holder: to be implemented once related specification is available
+        // A device which cannot push its events queues them instead, fetch
+        // those queued since the last cycle before updating the sensors
         if (nsmDevice->getEventMode() == GLOBAL_EVENT_GENERATION_ENABLE_POLLING)
         {
-            // poll event from device
-            co_await pollEvents(eid);
+            co_await requester::withRequestClass(
+                requester::RequestClass::Priority,
+                [&] { return pollEvents(nsmDevice, eid, eventManager); });
         }
-#endif
-        // update all priority sensors
-        nsmDevice->setPollingState(POLL_PRIORITY);
-
-        auto& sensors = nsmDevice->prioritySensors;
-        const size_t prioritySensorCount = sensors.size();
-
-        // Insertion into container NsmDevice::prioritySensors, triggered by
-        // Configuration PDI added event, may invalidate container's
-        // iterators and hence using index based element access.
-        size_t sensorIndex{0};
-
-        while (sensorIndex < prioritySensorCount)
+        // Sensors added by Configuration PDI added events since the last
+        // cycle join the schedule. Sensors due within the allowed buffer are
+        // released with this cycle rather than delaying them by a whole one.
+        auto& scheduler = nsmDevice->sensorScheduler;
+        scheduler.sync(nsmDevice->prioritySensors,
+                       nsmDevice->roundRobinSensors, t0);
+        scheduler.release(t0 + allowedBufferInUsec);
+
+        // update all released priority sensors
+        globalPollingStateManager.setPollingState(*nsmDevice, POLL_PRIORITY);
+
+        while (auto index = scheduler.next(SensorScheduler::Lane::Priority))
         {
-            auto sensor = sensors[sensorIndex];
-            co_await sensor->update(*this, eid);
-            ++sensorIndex;
+            auto sensor = scheduler.getSensor(*index);
+            co_await requester::withRequestClass(
+                requester::RequestClass::Priority,
+                [&] { return sensor->update(*this, eid); });
+            sd_event_now(event.get(), CLOCK_MONOTONIC, &t1);
+            scheduler.complete(*index, t1);
         }
 
-        // update roundRobin sensors for rest of polling time interval
-        nsmDevice->setPollingState(POLL_NON_PRIORITY);
-
-        auto toBeUpdated = nsmDevice->roundRobinSensors.size();
+        // update released roundRobin sensors, earliest deadline first, for
+        // rest of polling time interval
+        globalPollingStateManager.setPollingState(*nsmDevice,
+                                                  POLL_NON_PRIORITY);
 
-        // Make sure the first round-robin sensor is not compared
-        // to an uninitialised timestamp
         sd_event_now(event.get(), CLOCK_MONOTONIC, &t1);
 
-        while ((t1 - t0) < pollingTimeInUsec)
+        while ((t1 - t0) < pollingTimeInUsec &&
+               scheduler.hasReleased(SensorScheduler::Lane::RoundRobin))
         {
-            if (!toBeUpdated)
-            {
-                // Either we were able to succesfully update all sensors in one
-                // iteration or there are no sensors in the queue. Mark ready in
-                // both cases.
-                if (!nsmDevice->isDeviceReady && isReadyForReadinessCheck)
-                {
-                    nsmDevice->isDeviceReady = true;
-                    checkAllDevicesReady();
-                }
-                break;
-            }
-
             if (globalPollingStateManager.getState() != POLL_NON_PRIORITY &&
                 nsmDevice
                     ->isDeviceReady) // Throttling logic shouldn't affect HMC
                                      // Ready. Check if the device is ready and
                                      // only then implement the throttling logic
             {
-                // Sleep for 20ms and then check again if we have time.
-                co_await common::Sleep(event.get(), 20000, common::Priority);
+                // Wait for the priority polling to end and then check again
+                // if we have time.
+                co_await globalPollingStateManager.waitForNonPriority(
+                    *nsmDevice);
                 sd_event_now(event.get(), CLOCK_MONOTONIC, &t1);
                 continue;
             }
 
-            auto sensor = nsmDevice->roundRobinSensors.front();
-
-            nsmDevice->roundRobinSensors.pop_front();
-            toBeUpdated--;
-
-            if (!sensor->needsUpdate(t1))
-            {
-                // Skip the RR-sensor
-                nsmDevice->roundRobinSensors.push_back(sensor);
-                continue;
-            }
-
-            // ServiceReady Logic:
-            // The round-robin queue is circular hence encountering the first
-            // refreshed sensor marks a "complete iteration" of the queue.
-            if (!nsmDevice->isDeviceReady && sensor->isRefreshed &&
-                isReadyForReadinessCheck)
-            {
-                // The Device isn't ready but we have found our first
-                // refreshed sensor. Mark the device ready.
-                nsmDevice->isDeviceReady = true;
-                checkAllDevicesReady();
-            }
+            auto index = scheduler.next(SensorScheduler::Lane::RoundRobin);
+            auto sensor = scheduler.getSensor(*index);
 
-            auto cc = co_await sensor->update(*this, eid);
+            // Static inventory reads yield to the telemetry of the device
+            auto cc = co_await requester::withRequestClass(
+                sensor->isStatic ? requester::RequestClass::Background
+                                 : requester::RequestClass::RoundRobin,
+                [&] { return sensor->update(*this, eid); });
             sensor->isRefreshed = true;
 
-            if (!(sensor->isStatic && cc == NSM_SUCCESS))
+            // Filter out succesfully updated static sensor. Only non-static
+            // sensors or static sensors that failed to update succesfully
+            // stay scheduled.
+            const bool retire = sensor->isStatic && cc == NSM_SUCCESS;
+            if (retire)
             {
-                // Filter out succesfully updated static sensor.
-                // Only re-queue non-static sensors or static sensors that
-                // failed to update succesfully.
-                nsmDevice->roundRobinSensors.push_back(sensor);
+                std::erase(nsmDevice->roundRobinSensors, sensor);
             }
 
             sd_event_now(event.get(), CLOCK_MONOTONIC, &t1);
             sensor->setLastUpdatedTimeStamp(t1);
+            scheduler.complete(*index, t1, retire);
+        }
+
+        // ServiceReady Logic:
+        // The device is ready once every round-robin sensor, including the
+        // ones with a long period, was updated since it was marked
+        // unrefreshed.
+        if (!nsmDevice->isDeviceReady && isReadyForReadinessCheck &&
+            scheduler.isRefreshed(SensorScheduler::Lane::RoundRobin))
+        {
+            nsmDevice->isDeviceReady = true;
+            checkAllDevicesReady();
         }
 
         sd_event_now(event.get(), CLOCK_MONOTONIC, &t1);
 
-        if (prioritySensorCount == 0)
+        if (nsmDevice->prioritySensors.empty())
         {
             // The timer event for devices with no priority sensors can be
             // of low priority.
@@ -818,65 +833,241 @@ requester::Coroutine
     co_return NSM_SW_SUCCESS;
 }
 
-requester::Coroutine SensorManagerImpl::SendRecvNsmMsg(
-    eid_t eid, Request& request, std::shared_ptr<const nsm_msg>& responseMsg,
-    size_t& responseLen)
+uint8_t SensorManagerImpl::checkRequest(eid_t eid, const Request& request)
 {
-    auto requestMsg = reinterpret_cast<nsm_msg*>(request.data());
+    auto requestMsg = reinterpret_cast<const nsm_msg*>(request.data());
 
     uint8_t messageType = requestMsg->hdr.nvidia_msg_type;
     uint8_t commandCode = requestMsg->payload[0];
 
-    auto uuid = utils::getUUIDFromEID(eidTable, eid);
-    if (!uuid)
+    // The device of the EID is resolved from the EID table once, until
+    // DeviceManager drops the binding
+    auto& registry = EidRegistry::getInstance();
+    if (registry.get(eid).state == EidState::Offline)
     {
-        lg2::error(
-            "SensorManager::SendRecvNsmMsg  : No UUID found for EID {EID}",
-            "EID", eid);
-        // coverity[missing_return]
-        co_return NSM_ERROR;
+        // the MCTP endpoint is gone, fail before resolving its device
+        return NSM_ERR_UNSUPPORTED_COMMAND_CODE;
     }
-
-    auto nsmDevice = getNsmDevice(*uuid);
+    auto nsmDevice = registry.getDevice(eid).get();
     if (!nsmDevice)
     {
-        lg2::error(
-            "SensorManager::SendRecvNsmMsg : No nsmDevice found for eid={EID} , uuid={UUID}",
-            "EID", eid, "UUID", *uuid);
-        // coverity[missing_return]
-        co_return NSM_ERROR;
+        auto device = resolveNsmDevice(eid);
+        if (!device)
+        {
+            return NSM_ERROR;
+        }
+        // the registry holds the device from now on
+        nsmDevice = device.get();
     }
 
     if (!nsmDevice->isDeviceActive ||
         !nsmDevice->isCommandSupported(messageType, commandCode))
     {
-        // coverity[missing_return]
-        co_return NSM_ERR_UNSUPPORTED_COMMAND_CODE;
+        return NSM_ERR_UNSUPPORTED_COMMAND_CODE;
     }
 
-    const nsm_msg* response = nullptr;
-    auto rc = co_await requester::SendRecvNsmMsg<RequesterHandler>(
-        handler, eid, request, &response, &responseLen);
-    responseMsg = std::shared_ptr<const nsm_msg>(response, [](auto) {
-    }); // the memory is allocated and free at sock_handler.cpp
+    return NSM_SW_SUCCESS;
+}
+
+void SensorManagerImpl::logSendRecvError(eid_t eid, uint8_t rc)
+{
     // NSM_SW_ERROR_NULL: indicates no nsm response which is possible for
     // request that timedout
-    if (rc && rc != NSM_SW_ERROR_NULL)
+    // NSM_SW_ERROR_UNAVAILABLE: the circuit breaker of the EID is open
+    if (rc && rc != NSM_SW_ERROR_NULL && rc != NSM_SW_ERROR_UNAVAILABLE)
     {
         lg2::error("SendRecvNsmMsg failed. eid={EID} rc={RC}", "EID", eid, "RC",
                    rc);
     }
+}
+
+requester::Coroutine SensorManagerImpl::SendRecvNsmMsg(
+    eid_t eid, Request& request, std::shared_ptr<const nsm_msg>& responseMsg,
+    size_t& responseLen)
+{
+    auto rc = checkRequest(eid, request);
+    if (rc)
+    {
+        // coverity[missing_return]
+        co_return rc;
+    }
+
+    // The response is a reference counted view of the pooled receive buffer,
+    // it stays valid for as long as the caller keeps it
+    rc = co_await requester::SendRecvNsmMsg<RequesterHandler>(
+        handler, eid, request, &responseMsg, &responseLen);
+    logSendRecvError(eid, rc);
     // coverity[missing_return]
     co_return rc;
 }
 
-requester::Coroutine SensorManagerImpl::pollEvents([[maybe_unused]] eid_t eid)
+requester::Coroutine SensorManagerImpl::SendRecvNsmMsg(
+    eid_t eid, const RequestTemplate& requestTemplate,
+    std::shared_ptr<const nsm_msg>& responseMsg, size_t& responseLen)
 {
-    // placeholder
+    if (!requestTemplate)
+    {
+        // coverity[missing_return]
+        co_return NSM_SW_ERROR_NULL;
+    }
+
+    auto rc = checkRequest(eid, *requestTemplate);
+    if (rc)
+    {
+        // coverity[missing_return]
+        co_return rc;
+    }
+
+    // The template is sent as is, with the instance ID of the request
+    rc = co_await requester::SendRecvNsmMsg<RequesterHandler>(
+        handler, eid, requestTemplate, &responseMsg, &responseLen);
+    logSendRecvError(eid, rc);
+    // coverity[missing_return]
+    co_return rc;
+}
+
+requester::Coroutine
+    SensorManager::pollEvents(std::shared_ptr<NsmDevice> nsmDevice, eid_t eid,
+                              EventManager& eventManager)
+{
+    // Event log records are selected by their handle
+    constexpr uint8_t eventHandleSelector = 0;
+
+    for (size_t i = 0; i < maxEventsPerCycle; ++i)
+    {
+        Request request(sizeof(nsm_msg_hdr) +
+                        sizeof(nsm_get_event_log_record_req));
+        auto requestMsg = reinterpret_cast<nsm_msg*>(request.data());
+        auto rc = encode_nsm_get_event_log_record_req(
+            0, eventHandleSelector, nsmDevice->nextEventHandle, requestMsg);
+        if (rc != NSM_SW_SUCCESS)
+        {
+            lg2::error("pollEvents: encode request failed, eid={EID} rc={RC}",
+                       "EID", eid, "RC", rc);
+            // coverity[missing_return]
+            co_return rc;
+        }
+
+        std::shared_ptr<const nsm_msg> responseMsg;
+        size_t responseLen = 0;
+        rc = co_await SendRecvNsmMsg(eid, request, responseMsg, responseLen);
+        if (rc != NSM_SW_SUCCESS)
+        {
+            // coverity[missing_return]
+            co_return rc;
+        }
+
+        uint8_t cc = NSM_SUCCESS;
+        uint8_t nsmType = 0;
+        uint8_t eventId = 0;
+        uint32_t eventHandle = 0;
+        uint64_t timestamp = 0;
+        uint8_t* payload = nullptr;
+        uint16_t payloadLen = 0;
+        rc = decode_nsm_get_event_log_record_resp(
+            responseMsg.get(), responseLen, &cc, &nsmType, &eventId,
+            &eventHandle, &timestamp, &payload, &payloadLen);
+        if (rc != NSM_SW_SUCCESS || cc != NSM_SUCCESS ||
+            eventHandle < nsmDevice->nextEventHandle)
+        {
+            // No record is queued past the last one fetched
+            break;
+        }
+        nsmDevice->nextEventHandle = eventHandle + 1;
+
+        if (payloadLen > UINT8_MAX)
+        {
+            lg2::error(
+                "pollEvents: event data too long, eid={EID} type={TYPE} id={ID} len={LEN}",
+                "EID", eid, "TYPE", nsmType, "ID", eventId, "LEN", payloadLen);
+            continue;
+        }
+
+        // A record carries neither the class nor the state of its event.
+        // libnsm encodes every event but the long running one in the general
+        // class with state 0. The state of a long running event names the
+        // request it completes, so its record cannot be replayed.
+        if (nsmType == NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY &&
+            eventId == NSM_LONG_RUNNING_EVENT)
+        {
+            lg2::error(
+                "pollEvents: long running event record skipped, eid={EID} handle={HANDLE}",
+                "EID", eid, "HANDLE", eventHandle);
+            continue;
+        }
+
+        // The record is handed over as the event the device would have pushed
+        auto eventLen = sizeof(nsm_msg_hdr) + NSM_EVENT_MIN_LEN + payloadLen;
+        auto eventBuffer = std::make_shared<std::vector<uint8_t>>(eventLen);
+        auto eventMsg = reinterpret_cast<nsm_msg*>(eventBuffer->data());
+        rc = encode_nsm_event(0, nsmType, false, NSM_EVENT_VERSION, eventId,
+                              NSM_GENERAL_EVENT_CLASS, 0,
+                              static_cast<uint8_t>(payloadLen), payload,
+                              eventMsg);
+        if (rc != NSM_SW_SUCCESS)
+        {
+            continue;
+        }
+        eventManager.handle(eid, nsmType, eventId,
+                            std::shared_ptr<const nsm_msg>(eventBuffer,
+                                                           eventMsg),
+                            eventLen);
+    }
+
     // coverity[missing_return]
     co_return NSM_SW_SUCCESS;
 }
 
+requester::Coroutine
+    SensorManager::SendRecvNsmMsg(eid_t eid,
+                                  const RequestTemplate& requestTemplate,
+                                  std::shared_ptr<const nsm_msg>& responseMsg,
+                                  size_t& responseLen)
+{
+    if (!requestTemplate)
+    {
+        // coverity[missing_return]
+        co_return NSM_SW_ERROR_NULL;
+    }
+
+    Request request(*requestTemplate);
+    auto rc = co_await SendRecvNsmMsg(eid, request, responseMsg, responseLen);
+    // coverity[missing_return]
+    co_return rc;
+}
+
+void SensorManager::logPollingStats() const
+{
+    lg2::error("******logPollingStats Start*****");
+    for (const auto& nsmDevice : nsmDevices)
+    {
+        const auto& scheduler = nsmDevice->sensorScheduler;
+        uint64_t deadlineMisses = 0;
+        for (SensorScheduler::Index index = 0; index < scheduler.size();
+             ++index)
+        {
+            const auto& sensor = scheduler.getSensor(index);
+            auto misses = scheduler.getDeadlineMisses(sensor.get());
+            if (misses)
+            {
+                lg2::error(
+                    "logPollingStats: UUID={UUID}, SENSOR={NAME}, DEADLINEMISSES={MISSES}",
+                    "UUID", nsmDevice->uuid, "NAME", sensor->getName(),
+                    "MISSES", misses);
+            }
+            deadlineMisses += misses;
+        }
+        const auto& throttle = nsmDevice->pollingThrottleStats;
+        lg2::error(
+            "logPollingStats: UUID={UUID}, EID={EID}, SENSORS={COUNT}, DEADLINEMISSES={MISSES}, "
+            "THROTTLED={THROTTLED}, THROTTLEDTIME={THROTTLEDTIME}us",
+            "UUID", nsmDevice->uuid, "EID", nsmDevice->eid, "COUNT",
+            scheduler.size(), "MISSES", deadlineMisses, "THROTTLED",
+            throttle.throttled, "THROTTLEDTIME", throttle.throttledTimeInUsec);
+    }
+    lg2::error("******logPollingStats End*****");
+}
+
 std::shared_ptr<NsmDevice> SensorManager::getNsmDevice(uint8_t deviceType,
                                                        uint8_t instanceNumber)
 {
@@ -911,6 +1102,35 @@ std::shared_ptr<NsmDevice> SensorManager::getNsmDevice(uuid_t uuid)
     return nsmDevice;
 }
 
+std::shared_ptr<NsmDevice> SensorManagerImpl::resolveNsmDevice(eid_t eid)
+{
+    auto& registry = EidRegistry::getInstance();
+    if (auto device = registry.getDevice(eid))
+    {
+        return device;
+    }
+
+    auto uuid = utils::getUUIDFromEID(eidTable, eid);
+    if (!uuid)
+    {
+        lg2::error(
+            "SensorManager::resolveNsmDevice : No UUID found for EID {EID}",
+            "EID", eid);
+        return nullptr;
+    }
+
+    auto device = getNsmDevice(*uuid);
+    if (!device)
+    {
+        lg2::error(
+            "SensorManager::resolveNsmDevice : No nsmDevice found for eid={EID} , uuid={UUID}",
+            "EID", eid, "UUID", *uuid);
+        return nullptr;
+    }
+    registry.bind(eid, device);
+    return device;
+}
+
 eid_t SensorManagerImpl::getEid(std::shared_ptr<NsmDevice> nsmDevice)
 {
     return utils::getEidFromUUID(eidTable, nsmDevice->uuid);
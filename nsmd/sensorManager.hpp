@@ -19,6 +19,7 @@
 
 #include "common/types.hpp"
 #include "dBusAsyncUtils.hpp"
+#include "eventManager.hpp"
 #include "instance_id.hpp"
 #include "nsmDevice.hpp"
 #include "nsmObject.hpp"
@@ -30,6 +31,7 @@
 #include <sdbusplus/asio/object_server.hpp>
 #include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/timer.hpp>
+#include <sdeventplus/source/event.hpp>
 
 #include <memory>
 #include <queue>
@@ -70,7 +72,52 @@ class SensorManager
                        std::shared_ptr<const nsm_msg>& responseMsg,
                        size_t& responseLen) = 0;
 
+    /** @brief Send a shared request template to eid and receive the response.
+     *  The default implementation sends a copy of the template, managers
+     *  which send the template itself override it.
+     *
+     *  @param[in] eid endpoint ID
+     *  @param[in] requestTemplate encoded request shared between polls
+     *  @param[out] responseMsg response NSM message
+     *  @param[out] responseLen length of response NSM message
+     *  @return return_value - nsm_requester_error_codes
+     */
+    virtual requester::Coroutine
+        SendRecvNsmMsg(eid_t eid, const RequestTemplate& requestTemplate,
+                       std::shared_ptr<const nsm_msg>& responseMsg,
+                       size_t& responseLen);
+
+    /** @brief Fetch the records of the event log of a device in polling
+     *  event mode, past the last one fetched, and hand each of them to the
+     *  event handlers as the event the device would have pushed.
+     *
+     *  @param[in] nsmDevice device whose event log is read
+     *  @param[in] eid endpoint ID of the device
+     *  @param[in] eventManager event handlers of the records
+     *  @return return_value - nsm_requester_error_codes
+     */
+    requester::Coroutine pollEvents(std::shared_ptr<NsmDevice> nsmDevice,
+                                    eid_t eid, EventManager& eventManager);
+
+    /** @brief Largest number of event log records fetched by pollEvents(),
+     *  it bounds the time a device with a flooded event log holds up its
+     *  sensors. The remaining records are fetched in the next cycles.
+     */
+    static constexpr size_t maxEventsPerCycle = 16;
+
+    /** @brief Log the polling statistics of every device, on demand
+     *  through the LogDump D-Bus method
+     */
+    void logPollingStats() const;
+
     virtual eid_t getEid(std::shared_ptr<NsmDevice> nsmDevice) = 0;
+
+    /** @brief Device of the EID, resolved from the EID table and bound in
+     *  the EidRegistry when the registry holds none
+     *
+     *  @return nullptr when no device is known for the EID
+     */
+    virtual std::shared_ptr<NsmDevice> resolveNsmDevice(eid_t eid) = 0;
     virtual void startPolling(uuid_t uuid) = 0;
     virtual sdbusplus::asio::object_server& getObjServer() = 0;
     eid_t getLocalEid()
@@ -130,7 +177,8 @@ class SensorManagerImpl : public SensorManager
         std::multimap<uuid_t, std::tuple<eid_t, MctpMedium, MctpBinding>>&
             eidTable,
         NsmDeviceTable& nsmDevices, eid_t localEid,
-        mctp_socket::Manager& sockManager, bool verbose = false)
+        mctp_socket::Manager& sockManager, EventManager& eventManager,
+        bool verbose = false)
     {
         if (instance)
         {
@@ -140,7 +188,7 @@ class SensorManagerImpl : public SensorManager
         }
         instance = std::make_unique<SensorManagerImpl>(
             bus, event, handler, instanceIdDb, objServer, eidTable, nsmDevices,
-            localEid, sockManager, verbose);
+            localEid, sockManager, eventManager, verbose);
     }
 
     sdbusplus::asio::object_server& getObjServer()
@@ -156,7 +204,8 @@ class SensorManagerImpl : public SensorManager
         std::multimap<uuid_t, std::tuple<eid_t, MctpMedium, MctpBinding>>&
             eidTable,
         NsmDeviceTable& nsmDevices, eid_t localEid,
-        mctp_socket::Manager& sockManager, bool verbose);
+        mctp_socket::Manager& sockManager, EventManager& eventManager,
+        bool verbose);
     static void dumpReadinessLogs();
 
     static bool isEMReady();
@@ -180,11 +229,20 @@ class SensorManagerImpl : public SensorManager
         SendRecvNsmMsg(eid_t eid, Request& request,
                        std::shared_ptr<const nsm_msg>& responseMsg,
                        size_t& responseLen) override;
+    requester::Coroutine
+        SendRecvNsmMsg(eid_t eid, const RequestTemplate& requestTemplate,
+                       std::shared_ptr<const nsm_msg>& responseMsg,
+                       size_t& responseLen) override;
+    uint8_t checkRequest(eid_t eid, const Request& request);
+    void logSendRecvError(eid_t eid, uint8_t rc);
     requester::Coroutine
         doPollingTaskLongRunning(std::shared_ptr<NsmDevice> nsmDevice);
+    requester::Coroutine
+        updateLongRunningSensor(std::shared_ptr<NsmDevice> nsmDevice,
+                                std::shared_ptr<NsmObject> sensor, eid_t eid);
     void scanInventory();
-    requester::Coroutine pollEvents(eid_t eid);
     eid_t getEid(std::shared_ptr<NsmDevice> nsmDevice) override;
+    std::shared_ptr<NsmDevice> resolveNsmDevice(eid_t eid) override;
 
     static bool isReadyForReadinessCheck;
     static bool isMCTPReadyCheck;
@@ -211,6 +269,7 @@ class SensorManagerImpl : public SensorManager
     std::unique_ptr<sdeventplus::source::Defer> deferScanInventory;
     std::unique_ptr<sdeventplus::source::Defer> newSensorEvent;
     mctp_socket::Manager& sockManager;
+    EventManager& eventManager;
 
     bool verbose;
 
@@ -0,0 +1,371 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sensor_scheduler.hpp"
+
+#include "nsmObject.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace nsm
+{
+
+SensorScheduler::SensorScheduler(uint64_t priorityPeriodInUsec,
+                                 uint64_t roundRobinPeriodInUsec,
+                                 uint64_t maxAdaptivePeriodInUsec) :
+    priorityPeriodInUsec(priorityPeriodInUsec),
+    roundRobinPeriodInUsec(roundRobinPeriodInUsec),
+    maxAdaptivePeriodInUsec(maxAdaptivePeriodInUsec)
+{}
+
+uint64_t SensorScheduler::adaptPeriod(NsmObject& sensor, uint64_t periodInUsec,
+                                      uint64_t basePeriodInUsec,
+                                      uint64_t maxPeriodInUsec)
+{
+    if (!sensor.isAdaptivePolling() || sensor.takeChanged() ||
+        maxPeriodInUsec <= basePeriodInUsec)
+    {
+        return basePeriodInUsec;
+    }
+    return std::clamp(periodInUsec * 2, basePeriodInUsec, maxPeriodInUsec);
+}
+
+void SensorScheduler::sync(
+    const std::vector<std::shared_ptr<NsmObject>>& prioritySensors,
+    const std::deque<std::shared_ptr<NsmObject>>& roundRobinSensors,
+    uint64_t nowInUsec)
+{
+    if (matches(prioritySensors, roundRobinSensors))
+    {
+        return;
+    }
+
+    auto previousTimings = std::move(timings);
+    auto previousSensors = std::move(sensors);
+    auto previousMisses = std::move(deadlineMisses);
+
+    std::unordered_map<const NsmObject*, Index> previous;
+    previous.reserve(previousSensors.size());
+    for (Index index = 0; index < previousSensors.size(); ++index)
+    {
+        previous.try_emplace(previousSensors[index].get(), index);
+    }
+
+    const size_t count = prioritySensors.size() + roundRobinSensors.size();
+    timings.clear();
+    timings.reserve(count);
+    sensors.clear();
+    sensors.reserve(count);
+    deadlineMisses.clear();
+    deadlineMisses.reserve(count);
+    waiting.clear();
+    released[0].clear();
+    released[1].clear();
+
+    auto carryOver = [&](const std::shared_ptr<NsmObject>& sensor, Lane lane) {
+        auto it = previous.find(sensor.get());
+        if (it == previous.end())
+        {
+            add(sensor, lane, nullptr, 0, nowInUsec);
+        }
+        else
+        {
+            add(sensor, lane, &previousTimings[it->second],
+                previousMisses[it->second], nowInUsec);
+        }
+    };
+
+    for (const auto& sensor : prioritySensors)
+    {
+        carryOver(sensor, Lane::Priority);
+    }
+    numPrioritySensors = prioritySensors.size();
+    for (const auto& sensor : roundRobinSensors)
+    {
+        carryOver(sensor, Lane::RoundRobin);
+    }
+}
+
+bool SensorScheduler::matches(
+    const std::vector<std::shared_ptr<NsmObject>>& prioritySensors,
+    const std::deque<std::shared_ptr<NsmObject>>& roundRobinSensors) const
+{
+    if (numPrioritySensors != prioritySensors.size() ||
+        sensors.size() != numPrioritySensors + roundRobinSensors.size())
+    {
+        return false;
+    }
+    return std::equal(prioritySensors.begin(), prioritySensors.end(),
+                      sensors.begin()) &&
+           std::equal(roundRobinSensors.begin(), roundRobinSensors.end(),
+                      sensors.begin() + numPrioritySensors);
+}
+
+void SensorScheduler::add(const std::shared_ptr<NsmObject>& sensor, Lane lane,
+                          const Timing* previous, uint64_t previousMisses,
+                          uint64_t nowInUsec)
+{
+    const auto periodInUsec = getPeriod(*sensor, lane);
+    Timing timing{nowInUsec, nowInUsec + periodInUsec, periodInUsec, lane,
+                  State::Waiting};
+    if (previous)
+    {
+        // a stretched period is kept until the value changes
+        if (sensor->isAdaptivePolling())
+        {
+            timing.periodInUsec = std::clamp(
+                previous->periodInUsec, periodInUsec,
+                std::max(periodInUsec, maxAdaptivePeriodInUsec));
+        }
+        timing.releaseInUsec = previous->releaseInUsec;
+        timing.deadlineInUsec = previous->releaseInUsec + timing.periodInUsec;
+    }
+
+    const auto index = static_cast<Index>(sensors.size());
+    timings.push_back(timing);
+    sensors.push_back(sensor);
+    deadlineMisses.push_back(previousMisses);
+    enqueue(index);
+}
+
+uint64_t SensorScheduler::getPeriod(const NsmObject& sensor, Lane lane) const
+{
+    const auto periodInUsec = sensor.getPollingPeriod();
+    if (periodInUsec != 0)
+    {
+        return periodInUsec;
+    }
+    return lane == Lane::Priority ? priorityPeriodInUsec
+                                  : roundRobinPeriodInUsec;
+}
+
+bool SensorScheduler::releasesLater(Index a, Index b) const
+{
+    const auto& timingA = timings[a];
+    const auto& timingB = timings[b];
+    if (timingA.releaseInUsec != timingB.releaseInUsec)
+    {
+        return timingA.releaseInUsec > timingB.releaseInUsec;
+    }
+    return a > b;
+}
+
+bool SensorScheduler::dueLater(Index a, Index b) const
+{
+    const auto& timingA = timings[a];
+    const auto& timingB = timings[b];
+    if (timingA.deadlineInUsec != timingB.deadlineInUsec)
+    {
+        return timingA.deadlineInUsec > timingB.deadlineInUsec;
+    }
+    return a > b;
+}
+
+void SensorScheduler::enqueue(Index index)
+{
+    timings[index].state = State::Waiting;
+    waiting.push_back(index);
+    std::push_heap(waiting.begin(), waiting.end(),
+                   [this](Index a, Index b) { return releasesLater(a, b); });
+}
+
+void SensorScheduler::release(uint64_t nowInUsec)
+{
+    auto laterRelease = [this](Index a, Index b) {
+        return releasesLater(a, b);
+    };
+    auto laterDeadline = [this](Index a, Index b) { return dueLater(a, b); };
+
+    while (!waiting.empty() &&
+           timings[waiting.front()].releaseInUsec <= nowInUsec)
+    {
+        std::pop_heap(waiting.begin(), waiting.end(), laterRelease);
+        const auto index = waiting.back();
+        waiting.pop_back();
+
+        auto& timing = timings[index];
+        timing.state = State::Released;
+        auto& heap = released[static_cast<size_t>(timing.lane)];
+        heap.push_back(index);
+        std::push_heap(heap.begin(), heap.end(), laterDeadline);
+    }
+}
+
+std::optional<SensorScheduler::Index> SensorScheduler::next(Lane lane)
+{
+    auto& heap = released[static_cast<size_t>(lane)];
+    if (heap.empty())
+    {
+        return std::nullopt;
+    }
+
+    std::pop_heap(heap.begin(), heap.end(),
+                  [this](Index a, Index b) { return dueLater(a, b); });
+    const auto index = heap.back();
+    heap.pop_back();
+    timings[index].state = State::Taken;
+    return index;
+}
+
+void SensorScheduler::complete(Index index, uint64_t nowInUsec, bool retire)
+{
+    auto& timing = timings[index];
+    if (nowInUsec > timing.deadlineInUsec)
+    {
+        ++deadlineMisses[index];
+    }
+
+    if (retire)
+    {
+        drop(index);
+        return;
+    }
+
+    // The next period starts one period after the release, which is the
+    // deadline unless an adaptive sensor changed its period. A late sensor
+    // starts over instead of catching up on the periods it missed.
+    timing.periodInUsec =
+        adaptPeriod(*sensors[index], timing.periodInUsec,
+                    getPeriod(*sensors[index], timing.lane),
+                    maxAdaptivePeriodInUsec);
+    timing.releaseInUsec = std::max(
+        timing.releaseInUsec + timing.periodInUsec, nowInUsec);
+    timing.deadlineInUsec = timing.releaseInUsec + timing.periodInUsec;
+    enqueue(index);
+}
+
+void SensorScheduler::drop(Index index)
+{
+    // The sensor was taken by next(), so it is in none of the heaps. Shifting
+    // the indices past it keeps their order, and so the heaps valid.
+    if (timings[index].lane == Lane::Priority)
+    {
+        --numPrioritySensors;
+    }
+    timings.erase(timings.begin() + index);
+    sensors.erase(sensors.begin() + index);
+    deadlineMisses.erase(deadlineMisses.begin() + index);
+
+    auto shift = [index](Index& other) {
+        if (other > index)
+        {
+            --other;
+        }
+    };
+    std::ranges::for_each(waiting, shift);
+    for (auto& heap : released)
+    {
+        std::ranges::for_each(heap, shift);
+    }
+}
+
+bool SensorScheduler::snapBack(Index index, uint64_t nowInUsec)
+{
+    auto& timing = timings[index];
+    // a sensor being updated gets its base period on completion
+    sensors[index]->markChanged();
+
+    const auto periodInUsec = getPeriod(*sensors[index], timing.lane);
+    if (timing.state == State::Taken || timing.periodInUsec <= periodInUsec)
+    {
+        return false;
+    }
+
+    timing.periodInUsec = periodInUsec;
+    if (timing.state == State::Waiting)
+    {
+        timing.releaseInUsec = std::min(timing.releaseInUsec, nowInUsec);
+    }
+    timing.deadlineInUsec = std::min(timing.deadlineInUsec,
+                                     std::max(timing.releaseInUsec,
+                                              nowInUsec) +
+                                         periodInUsec);
+    return true;
+}
+
+void SensorScheduler::rebuildHeaps()
+{
+    std::ranges::make_heap(waiting, [this](Index a, Index b) {
+        return releasesLater(a, b);
+    });
+    for (auto& heap : released)
+    {
+        std::ranges::make_heap(heap,
+                               [this](Index a, Index b) { return dueLater(a, b); });
+    }
+}
+
+void SensorScheduler::expedite(const NsmObject* sensor, uint64_t nowInUsec)
+{
+    auto index = find(sensor);
+    if (index && snapBack(*index, nowInUsec))
+    {
+        rebuildHeaps();
+    }
+}
+
+void SensorScheduler::expediteAll(uint64_t nowInUsec)
+{
+    bool moved = false;
+    for (Index index = 0; index < sensors.size(); ++index)
+    {
+        moved |= snapBack(index, nowInUsec);
+    }
+    if (moved)
+    {
+        rebuildHeaps();
+    }
+}
+
+std::optional<SensorScheduler::Index>
+    SensorScheduler::find(const NsmObject* sensor) const
+{
+    auto it = std::ranges::find_if(
+        sensors, [sensor](const auto& object) { return object.get() == sensor; });
+    if (it == sensors.end())
+    {
+        return std::nullopt;
+    }
+    return static_cast<Index>(it - sensors.begin());
+}
+
+uint64_t SensorScheduler::getCurrentPeriod(const NsmObject* sensor) const
+{
+    auto index = find(sensor);
+    return index ? timings[*index].periodInUsec : 0;
+}
+
+uint64_t SensorScheduler::getDeadlineMisses(const NsmObject* sensor) const
+{
+    auto index = find(sensor);
+    return index ? deadlineMisses[*index] : 0;
+}
+
+bool SensorScheduler::isRefreshed(Lane lane) const
+{
+    for (Index index = 0; index < sensors.size(); ++index)
+    {
+        if (timings[index].lane == lane && !sensors[index]->isRefreshed)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace nsm
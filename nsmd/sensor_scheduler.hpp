@@ -0,0 +1,220 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace nsm
+{
+
+class NsmObject;
+
+/** @class SensorScheduler
+ *
+ *  Earliest-deadline-first polling schedule of the sensors of a device. A
+ *  sensor is released once per period and is due by the end of it, the
+ *  released sensor with the earliest deadline is polled first. Sensors
+ *  without a period of their own take the period of their lane.
+ *
+ *  The period of an adaptive sensor doubles every time it is polled without
+ *  a change of its value, up to the maximum adaptive period, and snaps back
+ *  once the value changes or the sensor is expedited.
+ *
+ *  The schedule follows the prioritySensors and roundRobinSensors containers
+ *  of the device, which the sensor factories fill. Both the released and the
+ *  waiting sensors are binary heaps of indices into the schedule, so a
+ *  polling cycle moves plain indices rather than shared pointers.
+ */
+class SensorScheduler
+{
+  public:
+    /** @brief The released sensors of the Priority lane are all polled at
+     *         the start of a polling cycle, the RoundRobin lane gets the rest
+     *         of the cycle
+     */
+    enum class Lane : uint8_t
+    {
+        Priority,
+        RoundRobin,
+    };
+
+    using Index = uint32_t;
+
+    /** @brief Constructor
+     *
+     *  @param[in] priorityPeriodInUsec - period of the priority sensors
+     *                                    without a period of their own
+     *  @param[in] roundRobinPeriodInUsec - period of the round-robin sensors
+     *                                      without a period of their own
+     *  @param[in] maxAdaptivePeriodInUsec - longest period of an adaptive
+     *                                       sensor, 0 disables adaptive
+     *                                       polling
+     */
+    SensorScheduler(uint64_t priorityPeriodInUsec,
+                    uint64_t roundRobinPeriodInUsec,
+                    uint64_t maxAdaptivePeriodInUsec = 0);
+
+    /** @brief Get the next period of a sensor polled at periodInUsec
+     *
+     *  @param[in] sensor - the sensor, its change mark is consumed
+     *  @param[in] periodInUsec - current period of the sensor
+     *  @param[in] basePeriodInUsec - period of the sensor when it changes
+     *  @param[in] maxPeriodInUsec - longest period of an adaptive sensor
+     *
+     *  @return twice periodInUsec, up to maxPeriodInUsec, for an adaptive
+     *          sensor whose value did not change, basePeriodInUsec otherwise
+     */
+    static uint64_t adaptPeriod(NsmObject& sensor, uint64_t periodInUsec,
+                                uint64_t basePeriodInUsec,
+                                uint64_t maxPeriodInUsec);
+
+    /** @brief Follow the sensor containers of the device. Added sensors are
+     *         released right away, the schedule and the deadline misses of
+     *         the sensors which are still in the containers are kept.
+     *
+     *  @param[in] prioritySensors - sensors of the Priority lane
+     *  @param[in] roundRobinSensors - sensors of the RoundRobin lane
+     *  @param[in] nowInUsec - current time
+     *
+     *  @note Not to be called while a sensor taken by next() is updated
+     */
+    void sync(const std::vector<std::shared_ptr<NsmObject>>& prioritySensors,
+              const std::deque<std::shared_ptr<NsmObject>>& roundRobinSensors,
+              uint64_t nowInUsec);
+
+    /** @brief Release the sensors whose period starts no later than
+     *         nowInUsec
+     */
+    void release(uint64_t nowInUsec);
+
+    /** @brief Take the released sensor of a lane with the earliest deadline
+     *
+     *  @return index of the sensor, std::nullopt when the lane has no
+     *          released sensor
+     */
+    std::optional<Index> next(Lane lane);
+
+    /** @brief Whether a lane has a released sensor */
+    bool hasReleased(Lane lane) const
+    {
+        return !released[static_cast<size_t>(lane)].empty();
+    }
+
+    /** @brief Schedule the next period of a sensor taken by next()
+     *
+     *  @param[in] index - index of the sensor
+     *  @param[in] nowInUsec - time the sensor update completed, a deadline
+     *                         miss is counted when it is past the deadline
+     *  @param[in] retire - the sensor is not polled again, it is dropped
+     *                      from the schedule and must be removed from its
+     *                      container before the next sync()
+     */
+    void complete(Index index, uint64_t nowInUsec, bool retire = false);
+
+    /** @brief Poll a sensor at its base period again. A waiting adaptive
+     *         sensor whose period was stretched is released right away.
+     *
+     *  @param[in] sensor - the sensor, ignored if it is not scheduled
+     *  @param[in] nowInUsec - current time
+     */
+    void expedite(const NsmObject* sensor, uint64_t nowInUsec);
+
+    /** @brief Poll every sensor at its base period again, on an event which
+     *         may have changed the static values of the device
+     */
+    void expediteAll(uint64_t nowInUsec);
+
+    /** @brief Current polling period of a sensor, 0 if it is not scheduled
+     */
+    uint64_t getCurrentPeriod(const NsmObject* sensor) const;
+
+    const std::shared_ptr<NsmObject>& getSensor(Index index) const
+    {
+        return sensors[index];
+    }
+
+    /** @brief Number of updates of the sensor that completed past their
+     *         deadline, logged by SensorManager::logPollingStats()
+     */
+    uint64_t getDeadlineMisses(const NsmObject* sensor) const;
+
+    /** @brief Whether every sensor of a lane was updated since it was last
+     *         marked unrefreshed
+     */
+    bool isRefreshed(Lane lane) const;
+
+    size_t size() const
+    {
+        return sensors.size();
+    }
+
+  private:
+    enum class State : uint8_t
+    {
+        Waiting,
+        Released,
+        Taken,
+    };
+
+    struct Timing
+    {
+        uint64_t releaseInUsec;
+        uint64_t deadlineInUsec;
+        uint64_t periodInUsec;
+        Lane lane;
+        State state;
+    };
+
+    bool matches(
+        const std::vector<std::shared_ptr<NsmObject>>& prioritySensors,
+        const std::deque<std::shared_ptr<NsmObject>>& roundRobinSensors) const;
+    void add(const std::shared_ptr<NsmObject>& sensor, Lane lane,
+             const Timing* previous, uint64_t previousMisses,
+             uint64_t nowInUsec);
+    void enqueue(Index index);
+    void drop(Index index);
+    bool snapBack(Index index, uint64_t nowInUsec);
+    void rebuildHeaps();
+    std::optional<Index> find(const NsmObject* sensor) const;
+    uint64_t getPeriod(const NsmObject& sensor, Lane lane) const;
+    // heap orderings, ties go to the sensor earlier in the containers
+    bool releasesLater(Index a, Index b) const;
+    bool dueLater(Index a, Index b) const;
+
+    const uint64_t priorityPeriodInUsec;
+    const uint64_t roundRobinPeriodInUsec;
+    const uint64_t maxAdaptivePeriodInUsec;
+
+    // per sensor state, the hot timings are kept apart from the owners
+    std::vector<Timing> timings;
+    std::vector<std::shared_ptr<NsmObject>> sensors;
+    std::vector<uint64_t> deadlineMisses;
+    size_t numPrioritySensors = 0;
+
+    // min-heaps of indices, by release time and by deadline per lane
+    std::vector<Index> waiting;
+    std::array<std::vector<Index>, 2> released;
+};
+
+} // namespace nsm
@@ -31,15 +31,106 @@
 
 #include <phosphor-logging/lg2.hpp>
 
+#include <string>
+
 namespace mctp_socket
 {
-std::optional<Response> Handler::processRxMsg(uint8_t tag, uint8_t eid,
-                                              [[maybe_unused]] uint8_t type,
-                                              const uint8_t* nsmMsg,
-                                              size_t nsmMsgSize)
+TxMessage::TxMessage(std::span<const uint8_t> prefix,
+                     std::span<const uint8_t> nsmMsg,
+                     std::optional<uint8_t> instanceId) :
+    prefixSize(std::min(prefix.size(), size_t(MCTP_DEMUX_PREFIX))),
+    headSize(prefixSize), rest(nsmMsg)
+{
+    std::copy_n(prefix.begin(), prefixSize, bytes.begin());
+    if (instanceId && nsmMsg.size() >= sizeof(nsm_msg_hdr))
+    {
+        std::copy_n(nsmMsg.begin(), sizeof(nsm_msg_hdr),
+                    bytes.begin() + prefixSize);
+        auto hdr = reinterpret_cast<nsm_msg_hdr*>(bytes.data() + prefixSize);
+        hdr->instance_id = *instanceId;
+        headSize += sizeof(nsm_msg_hdr);
+        rest = nsmMsg.subspan(sizeof(nsm_msg_hdr));
+    }
+}
+
+std::vector<uint8_t> TxMessage::nsmMsg() const
+{
+    std::vector<uint8_t> msg(bytes.begin() + prefixSize,
+                             bytes.begin() + headSize);
+    msg.insert(msg.end(), rest.begin(), rest.end());
+    return msg;
+}
+
+std::optional<uint32_t>
+    Handler::requestContext(eid_t eid, std::optional<uint8_t> instanceId)
+{
+    if (!instanceId)
+    {
+        return std::nullopt;
+    }
+    return static_cast<uint32_t>(eid) << 8 | *instanceId;
+}
+
+/** @brief Format the non-empty buckets of a batch histogram as size:count */
+static std::string formatHistogram(const std::vector<uint64_t>& histogram)
+{
+    std::string result;
+    for (size_t size = 0; size < histogram.size(); ++size)
+    {
+        if (histogram[size])
+        {
+            if (!result.empty())
+            {
+                result += ' ';
+            }
+            result += std::to_string(size) + ':' +
+                      std::to_string(histogram[size]);
+        }
+    }
+    return result;
+}
+
+void Handler::logStats() const
+{
+    const auto& rx = getReceiveStats();
+    lg2::error("logStats: RX WAKEUPS={WAKEUPS}, MESSAGES={MESSAGES}, "
+               "TRUNCATED={TRUNCATED}, MAXBATCH={MAX}, BATCHES={BATCHES}",
+               "WAKEUPS", rx.wakeups, "MESSAGES", rx.messages, "TRUNCATED",
+               rx.truncated, "MAX", rx.maxBatch, "BATCHES",
+               formatHistogram(rx.batchHistogram));
+
+    const auto& buffers = getReceiveBufferStats();
+    lg2::error("logStats: RX BUFFERS ACQUIRED={ACQUIRED}, "
+               "ALLOCATED={ALLOCATED}, INUSE={INUSE}, IDLE={IDLE}",
+               "ACQUIRED", buffers.acquired, "ALLOCATED", buffers.allocated,
+               "INUSE", buffers.inUse, "IDLE", buffers.idle);
+
+    const auto& tx = getTransmitStats();
+    lg2::error("logStats: TX FLUSHES={FLUSHES}, MESSAGES={MESSAGES}, "
+               "SYSCALLS={SYSCALLS}, ERRORS={ERRORS}, MAXBATCH={MAX}, "
+               "BATCHES={BATCHES}",
+               "FLUSHES", tx.flushes, "MESSAGES", tx.messages, "SYSCALLS",
+               tx.syscalls, "ERRORS", tx.errors, "MAX", tx.maxBatch,
+               "BATCHES", formatHistogram(tx.batchHistogram));
+}
+
+void Handler::handleSendFailure(uint32_t context, int rc)
+{
+    eid_t eid = context >> 8;
+    uint8_t instanceId = context & 0xff;
+    lg2::error("Failed to send the NSM request, EID={EID} RC={RC}", "EID", eid,
+               "RC", strerror(-rc));
+    handler.handleSendFailure(eid, instanceId);
+}
+
+std::optional<Response>
+    Handler::processRxMsg(uint8_t tag, uint8_t eid,
+                          [[maybe_unused]] uint8_t type,
+                          const std::shared_ptr<const nsm_msg>& nsmMsg,
+                          size_t nsmMsgSize, Clock::time_point received)
 {
     nsm_header_info hdrFields{};
-    auto hdr = reinterpret_cast<const nsm_msg_hdr*>(nsmMsg);
+    auto hdr = &nsmMsg->hdr;
     if (NSM_SUCCESS != unpack_nsm_header(hdr, &hdrFields))
     {
         lg2::error("Empty NSM request header");
@@ -53,73 +144,176 @@ std::optional<Response> Handler::processRxMsg(uint8_t tag, uint8_t eid,
 
     if (NSM_EVENT == hdrFields.nsm_msg_type && nsmMsgSize >= nsmEventMinimusLen)
     {
-        auto event = reinterpret_cast<const nsm_msg*>(hdr);
         size_t eventLen = nsmMsgSize;
-        uint8_t type = event->hdr.nvidia_msg_type;
-        uint8_t eventId = event->payload[1];
+        uint8_t type = nsmMsg->hdr.nvidia_msg_type;
+        uint8_t eventId = nsmMsg->payload[1];
         if (verbose)
         {
             lg2::info(
                 "received nsm event type={TYPE} eventId={ID} eventLen={LEN} from EID={EID}",
                 "TYPE", type, "ID", eventId, "LEN", eventLen, "EID", eid);
         }
-        return eventManager.handle(eid, type, eventId, event, eventLen);
+        return eventManager.handle(eid, type, eventId, nsmMsg, eventLen);
     }
     else if (NSM_RESPONSE == hdrFields.nsm_msg_type &&
              nsmMsgSize >= nsmRespMinimusLen)
     {
-        auto response = reinterpret_cast<const nsm_msg*>(hdr);
         size_t responseLen = nsmMsgSize;
         handler.handleResponse(tag, eid, hdrFields.instance_id,
-                               hdrFields.nvidia_msg_type, response->payload[0],
-                               response, responseLen);
+                               hdrFields.nvidia_msg_type, nsmMsg->payload[0],
+                               nsmMsg, responseLen, received);
     }
     return std::nullopt;
 }
 
-int DaemonHandler::registerMctpEndpoint(eid_t eid, int type, int protocol,
-                                        const std::vector<uint8_t>& pathName)
+bool Handler::handleDemuxMsg(const RxMessage& rxMsg, const DemuxReply& reply,
+                             Clock::time_point received)
 {
-    auto entry = socketInfoMap.find(pathName);
-    if (entry == socketInfoMap.end())
+    if (rxMsg.length == 0)
     {
-        auto [fd, currentSendBufferSize] = initSocket(eid, type, protocol,
-                                                      pathName);
-        if (fd < 0)
-        {
-            return fd;
-        }
-        else
+        // MCTP daemon has closed the socket this daemon is connected to.
+        // This may or may not be an error scenario, in either case the
+        // recovery mechanism for this daemon is to restart, and hence
+        // exit the event loop, that will cause this daemon to exit with a
+        // failure code.
+        event.exit(0);
+        return false;
+    }
+
+    if (rxMsg.length < MCTP_DEMUX_PREFIX)
+    {
+        lg2::error("Received MCTP message shorter than the demux prefix. "
+                   "Length={LEN}",
+                   "LEN", rxMsg.length);
+        return true;
+    }
+
+    uint8_t* requestMsg = rxMsg.data;
+    size_t nsmMsgLen = rxMsg.length - MCTP_DEMUX_PREFIX;
+
+    if (verbose)
+    {
+        utils::printBuffer(utils::Rx, &requestMsg[3], nsmMsgLen, requestMsg[0],
+                           requestMsg[1]);
+    }
+
+    if (MCTP_MSG_TYPE_VDM != requestMsg[2])
+    {
+        // Skip this message and continue.
+        return true;
+    }
+
+    // process message and send response
+    auto response = processRxMsg(requestMsg[0], requestMsg[1], requestMsg[2],
+                                 rxMsg.share(MCTP_DEMUX_PREFIX), nsmMsgLen,
+                                 received);
+    if (response.has_value())
+    {
+        constexpr uint8_t tagOwnerBitPos = 3;
+        constexpr uint8_t tagOwnerMask = ~(1 << tagOwnerBitPos);
+        // Set tag owner bit to 0 for NSM responses
+        requestMsg[0] = requestMsg[0] & tagOwnerMask;
+
+        if (verbose)
         {
-            manager.registerEndpoint(eid, fd, currentSendBufferSize);
+            utils::printBuffer(utils::Tx, *response, requestMsg[0],
+                               requestMsg[1]);
         }
+
+        reply({requestMsg, MCTP_DEMUX_PREFIX}, *response);
     }
-    else
+    return true;
+}
+
+bool Handler::handleInKernelMsg(const RxMessage& rxMsg,
+                                const InKernelReply& reply,
+                                Clock::time_point received)
+{
+    if (rxMsg.length == 0)
     {
-        manager.registerEndpoint(eid, (*(std::get<0>(entry->second)).get())(),
-                                 std::get<1>(entry->second));
+        // This may or may not be an error scenario, in either case the
+        // recovery mechanism for this daemon is to restart, and hence
+        // exit the event loop, that will cause this daemon to exit with a
+        // failure code.
+        lg2::error("recv system call failed. Terminating.");
+        event.exit(0);
+        return false;
     }
 
-    return 0;
+    if (rxMsg.addrLen < sizeof(struct sockaddr_mctp))
+    {
+        lg2::error("Received MCTP message without source address. "
+                   "AddrLen={LEN}",
+                   "LEN", rxMsg.addrLen);
+        return true;
+    }
+
+    const auto& addr =
+        reinterpret_cast<const struct sockaddr_mctp&>(rxMsg.addr);
+
+    if (verbose)
+    {
+        utils::printBuffer(utils::Rx, rxMsg.data, rxMsg.length, addr.smctp_tag,
+                           addr.smctp_addr.s_addr);
+    }
+
+    if (MCTP_MSG_TYPE_VDM != addr.smctp_type)
+    {
+        // Skip this message and continue.
+        return true;
+    }
+
+    // process message and send response
+    auto response = processRxMsg(addr.smctp_tag, addr.smctp_addr.s_addr,
+                                 addr.smctp_type, rxMsg.share(0),
+                                 rxMsg.length, received);
+    if (response.has_value())
+    {
+        if (verbose)
+        {
+            utils::printBuffer(utils::Tx, *response, addr.smctp_tag,
+                               addr.smctp_addr.s_addr);
+        }
+
+        constexpr uint8_t tagOwnerBitPos = 3;
+        constexpr uint8_t tagOwnerMask = ~(1 << tagOwnerBitPos);
+        auto destAddr = mctpAddress(addr.smctp_addr.s_addr,
+                                    addr.smctp_tag & tagOwnerMask,
+                                    addr.smctp_type);
+
+        reply(destAddr, *response);
+    }
+    return true;
 }
 
-SocketInfo DaemonHandler::initSocket([[maybe_unused]] eid_t eid, int type,
-                                     int protocol,
-                                     const std::vector<uint8_t>& pathName)
+sockaddr_mctp Handler::mctpAddress(eid_t eid, uint8_t tag, uint8_t type)
+{
+    struct sockaddr_mctp addr;
+    memset(&addr, 0, sizeof(addr));
+
+    addr.smctp_family = AF_MCTP;
+    addr.smctp_network = MCTP_NET_ANY;
+    addr.smctp_addr.s_addr = eid;
+    addr.smctp_tag = tag;
+    addr.smctp_type = type;
+
+    return addr;
+}
+
+int Handler::openDemuxSocket(int type, int protocol,
+                             const std::vector<uint8_t>& pathName,
+                             int& sendBufferSize) const
 {
     /* Create socket */
     int rc = 0;
-    int sendBufferSize = 0;
     int sockFd = socket(AF_UNIX, type, protocol);
     if (sockFd == -1)
     {
         rc = -errno;
         lg2::error("Failed to create the socket, RC={RC}", "RC", strerror(-rc));
-        return {rc, sendBufferSize};
+        return rc;
     }
 
-    auto fd = std::make_unique<utils::CustomFD>(sockFd);
-
     /* Get socket current buffer size */
     socklen_t optlen;
     optlen = sizeof(sendBufferSize);
@@ -129,7 +323,8 @@ SocketInfo DaemonHandler::initSocket([[maybe_unused]] eid_t eid, int type,
         rc = -errno;
         lg2::error("Error getting the default socket send buffer size, RC={RC}",
                    "RC", strerror(-rc));
-        return {rc, sendBufferSize};
+        close(sockFd);
+        return rc;
     }
 
     // /* Initiate a connection to the socket */
@@ -144,7 +339,8 @@ SocketInfo DaemonHandler::initSocket([[maybe_unused]] eid_t eid, int type,
         rc = -errno;
         lg2::error("Failed to connect to the socket, RC={RC}", "RC",
                    strerror(-rc));
-        return {rc, sendBufferSize};
+        close(sockFd);
+        return rc;
     }
 
     /* Register for VDM(0x7e) message type */
@@ -156,9 +352,92 @@ SocketInfo DaemonHandler::initSocket([[maybe_unused]] eid_t eid, int type,
         lg2::error(
             "Failed to register VDM message type to demux daemon, RC={RC}",
             "RC", strerror(-rc));
-        return {rc, sendBufferSize};
+        close(sockFd);
+        return rc;
+    }
+
+    return sockFd;
+}
+
+int Handler::openInKernelSocket(int& sendBufferSize)
+{
+    int fd = socket(AF_MCTP, SOCK_DGRAM, 0);
+
+    int rc = 0;
+    if (fd == -1)
+    {
+        rc = -errno;
+        lg2::error("Failed to create the socket, RC={RC}", "RC",
+                   strerror(-rc));
+        return rc;
+    }
+
+    socklen_t optlen;
+    optlen = sizeof(sendBufferSize);
+    rc = getsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sendBufferSize, &optlen);
+    if (rc == -1)
+    {
+        rc = -errno;
+        lg2::error("Error getting the default socket send buffer size, RC={RC}",
+                   "RC", strerror(-rc));
+        close(fd);
+        return rc;
+    }
+
+    auto addr = mctpAddress(MCTP_ADDR_ANY, MCTP_TAG_OWNER);
+
+    rc = bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+    if (rc == -1)
+    {
+        rc = -errno;
+        lg2::error("Error while binding the socket to NSM Msg Type, RC={RC}",
+                   "RC", strerror(-rc));
+        close(fd);
+        return rc;
     }
 
+    return fd;
+}
+
+int DaemonHandler::registerMctpEndpoint(eid_t eid, int type, int protocol,
+                                        const std::vector<uint8_t>& pathName)
+{
+    auto entry = socketInfoMap.find(pathName);
+    if (entry == socketInfoMap.end())
+    {
+        auto [fd, currentSendBufferSize] = initSocket(eid, type, protocol,
+                                                      pathName);
+        if (fd < 0)
+        {
+            return fd;
+        }
+        else
+        {
+            manager.registerEndpoint(eid, fd, currentSendBufferSize);
+        }
+    }
+    else
+    {
+        manager.registerEndpoint(eid, (*(std::get<0>(entry->second)).get())(),
+                                 std::get<1>(entry->second));
+    }
+
+    return 0;
+}
+
+SocketInfo DaemonHandler::initSocket([[maybe_unused]] eid_t eid, int type,
+                                     int protocol,
+                                     const std::vector<uint8_t>& pathName)
+{
+    int sendBufferSize = 0;
+    int sockFd = openDemuxSocket(type, protocol, pathName, sendBufferSize);
+    if (sockFd < 0)
+    {
+        return {sockFd, sendBufferSize};
+    }
+
+    auto fd = std::make_unique<utils::CustomFD>(sockFd);
+
     auto io = std::make_unique<IO>(
         event, sockFd, EPOLLIN,
         std::bind_front(&DaemonHandler::handleReceivedMsg, this));
@@ -169,28 +448,32 @@ SocketInfo DaemonHandler::initSocket([[maybe_unused]] eid_t eid, int type,
     return {sockFd, sendBufferSize};
 }
 
+DaemonHandler::DaemonHandler(sdeventplus::Event& event,
+                             requester::Handler<requester::Request>& handler,
+                             nsm::EventManager& eventManager, Manager& manager,
+                             bool verbose) :
+    Handler(event, handler, eventManager, manager, verbose)
+{
+    transmitBatcher.setFailureHandler(
+        std::bind_front(&DaemonHandler::handleSendFailure, this));
+}
+
 int DaemonHandler::sendMsg(uint8_t tag, eid_t eid, int mctpFd,
-                           const uint8_t* nsmMsg, size_t nsmMsgLen) const
+                           const uint8_t* nsmMsg, size_t nsmMsgLen,
+                           std::optional<uint8_t> instanceId) const
 {
     uint8_t hdr[3] = {tag, eid,
                       MCTP_MSG_TYPE_PCI_VDM}; // TO_TAG, EID, MCTP_MSG_TYPE
-
-    struct iovec iov[2];
-    iov[0].iov_base = hdr;
-    iov[0].iov_len = sizeof(hdr);
-    iov[1].iov_base = (uint8_t*)nsmMsg;
-    iov[1].iov_len = nsmMsgLen;
-    struct msghdr msg = {};
-    msg.msg_iov = iov;
-    msg.msg_iovlen = sizeof(iov) / sizeof(iov[0]);
+    TxMessage tx(hdr, {nsmMsg, nsmMsgLen}, instanceId);
 
     if (verbose)
     {
-        utils::printBuffer(utils::Tx, nsmMsg, nsmMsgLen, tag, eid);
+        utils::printBuffer(utils::Tx, tx.nsmMsg(), tag, eid);
     }
 
-    ssize_t rc = sendmsg(mctpFd, &msg, 0);
-    if (rc == -1)
+    int rc = transmitBatcher.queue(mctpFd, nullptr, tx.head(), tx.body(),
+                                   requestContext(eid, instanceId));
+    if (rc < 0)
     {
         return NSM_SW_ERROR;
     }
@@ -198,101 +481,45 @@ int DaemonHandler::sendMsg(uint8_t tag, eid_t eid, int mctpFd,
     return NSM_SW_SUCCESS;
 }
 
-void DaemonHandler::handleReceivedMsg(IO& io, int fd, uint32_t revents)
+void DaemonHandler::handleReceivedMsg([[maybe_unused]] IO& io, int fd,
+                                      uint32_t revents)
 {
     if (!(revents & EPOLLIN))
     {
         return;
     }
 
-    // Outgoing message.
-    struct iovec iov[2]{};
+    auto reply = [this, fd](std::span<const uint8_t> prefix,
+                            const Response& response) {
+        int rc = transmitBatcher.queue(fd, nullptr, prefix, response);
+        if (rc < 0)
+        {
+            lg2::error("sendto system call failed, RC={RC}", "RC", rc);
+        }
+    };
 
-    // This structure contains the parameter information for the response
-    // message.
-    struct msghdr msg
-    {};
+    auto handled = receiveEngine.drain(fd, [&](const RxMessage& rxMsg) {
+        return handleDemuxMsg(rxMsg, reply);
+    });
 
-    int returnCode = 0;
-    ssize_t peekedLength = recv(fd, nullptr, 0, MSG_PEEK | MSG_TRUNC);
-    if (peekedLength == 0)
+    if (handled < 0)
     {
-        // MCTP daemon has closed the socket this daemon is connected to.
-        // This may or may not be an error scenario, in either case the
-        // recovery mechanism for this daemon is to restart, and hence
-        // exit the event loop, that will cause this daemon to exit with a
-        // failure code.
-        io.get_event().exit(0);
+        lg2::error("recvmmsg system call failed, RC={RC}", "RC", handled);
     }
-    else if (peekedLength <= -1)
+    else if (verbose)
     {
-        returnCode = -errno;
-        lg2::error("recv system call failed, RC={RC}", "RC", returnCode);
+        lg2::info("Handled {COUNT} MCTP messages in one wakeup", "COUNT",
+                  handled);
     }
-    else
-    {
-        std::vector<uint8_t> requestMsg(peekedLength);
-        auto recvDataLength = recv(fd, static_cast<void*>(requestMsg.data()),
-                                   peekedLength, 0);
-        if (recvDataLength == peekedLength)
-        {
-            if (verbose)
-            {
-                utils::printBuffer(utils::Rx, &requestMsg[3],
-                                   requestMsg.size() - 3, requestMsg[0],
-                                   requestMsg[1]);
-            }
+}
 
-            if (MCTP_MSG_TYPE_VDM != requestMsg[2])
-            {
-                // Skip this message and continue.
-            }
-            else
-            {
-                // process message and send response
-                auto response = processRxMsg(requestMsg[0], requestMsg[1],
-                                             requestMsg[2], &requestMsg[3],
-                                             requestMsg.size() - 3);
-                if (response.has_value())
-                {
-                    constexpr uint8_t tagOwnerBitPos = 3;
-                    constexpr uint8_t tagOwnerMask = ~(1 << tagOwnerBitPos);
-                    // Set tag owner bit to 0 for NSM responses
-                    requestMsg[0] = requestMsg[0] & tagOwnerMask;
-                    iov[0].iov_base = &requestMsg[0];
-                    iov[0].iov_len = sizeof(requestMsg[0]) +
-                                     sizeof(requestMsg[1]) +
-                                     sizeof(requestMsg[2]);
-                    iov[1].iov_base = (*response).data();
-                    iov[1].iov_len = (*response).size();
-
-                    if (verbose)
-                    {
-                        utils::printBuffer(utils::Tx, *response, requestMsg[0],
-                                           requestMsg[1]);
-                    }
-
-                    msg.msg_iov = iov;
-                    msg.msg_iovlen = sizeof(iov) / sizeof(iov[0]);
-
-                    int result = sendmsg(fd, &msg, 0);
-                    if (-1 == result)
-                    {
-                        returnCode = -errno;
-                        lg2::error("sendto system call failed, RC={RC}", "RC",
-                                   returnCode);
-                    }
-                }
-            }
-        }
-        else
-        {
-            lg2::error("Failure to read peeked length packet. peekedLength="
-                       "{PEEKEDLENGTH} recvDataLength={RECVDATALENGTH}",
-                       "PEEKEDLENGTH", peekedLength, "RECVDATALENGTH",
-                       recvDataLength);
-        }
-    }
+InKernelHandler::InKernelHandler(
+    sdeventplus::Event& event, requester::Handler<requester::Request>& handler,
+    nsm::EventManager& eventManager, Manager& manager, bool verbose) :
+    Handler(event, handler, eventManager, manager, verbose)
+{
+    transmitBatcher.setFailureHandler(
+        std::bind_front(&InKernelHandler::handleSendFailure, this));
 }
 
 int InKernelHandler::registerMctpEndpoint(
@@ -305,46 +532,11 @@ int InKernelHandler::registerMctpEndpoint(
         return NSM_SUCCESS;
     }
 
-    fd = socket(AF_MCTP, SOCK_DGRAM, 0);
-
-    int rc = 0;
-    if (fd == -1)
-    {
-        rc = -errno;
-        lg2::error("Failed to create the socket, RC={RC}, EID={ED}", "RC",
-                   strerror(-rc), "ED", eid);
-        return rc;
-    }
-
-    socklen_t optlen;
-    optlen = sizeof(sendBufferSize);
-    rc = getsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sendBufferSize, &optlen);
-    if (rc == -1)
+    fd = openInKernelSocket(sendBufferSize);
+    if (fd < 0)
     {
-        rc = -errno;
-        lg2::error(
-            "Error getting the default socket send buffer size, RC={RC}, EID={ED}",
-            "RC", strerror(-rc), "ED", eid);
-        return rc;
-    }
-
-    struct sockaddr_mctp addr;
-    memset(&addr, 0, sizeof(addr));
-
-    addr.smctp_family = AF_MCTP;
-    addr.smctp_network = MCTP_NET_ANY;
-    addr.smctp_addr.s_addr = MCTP_ADDR_ANY;
-    addr.smctp_tag = MCTP_TAG_OWNER;
-    addr.smctp_type = MCTP_MSG_TYPE_PCI_VDM;
-
-    rc = bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
-    if (rc == -1)
-    {
-        rc = -errno;
-        lg2::error(
-            "Error while binding the socket to NSM Msg Type, RC={RC}, EID={ED}",
-            "RC", strerror(-rc), "ED", eid);
-        return rc;
+        lg2::error("Failed to open the MCTP socket, EID={ED}", "ED", eid);
+        return fd;
     }
 
     io = std::make_unique<IO>(
@@ -361,131 +553,53 @@ int InKernelHandler::registerMctpEndpoint(
 
 int InKernelHandler::sendMsg([[maybe_unused]] uint8_t tag, eid_t eid,
                              int mctpFd, const uint8_t* nsmMsg,
-                             size_t nsmMsgLen) const
+                             size_t nsmMsgLen,
+                             std::optional<uint8_t> instanceId) const
 {
-    struct sockaddr_mctp addr;
-    memset(&addr, 0, sizeof(addr));
-
-    addr.smctp_family = AF_MCTP;
-    addr.smctp_network = MCTP_NET_ANY;
-    addr.smctp_addr.s_addr = eid;
-    addr.smctp_tag = MCTP_TAG_OWNER;
-    addr.smctp_type = MCTP_MSG_TYPE_PCI_VDM;
+    auto addr = mctpAddress(eid, MCTP_TAG_OWNER);
+    TxMessage tx({}, {nsmMsg, nsmMsgLen}, instanceId);
 
     if (verbose)
     {
-        utils::printBuffer(utils::Tx, nsmMsg, nsmMsgLen, addr.smctp_tag, eid);
+        utils::printBuffer(utils::Tx, tx.nsmMsg(), addr.smctp_tag, eid);
     }
 
-    ssize_t rc = sendto(mctpFd, nsmMsg, nsmMsgLen, 0,
-                        reinterpret_cast<struct sockaddr*>(&addr),
-                        sizeof(addr));
-    if (rc == -1)
+    int rc = transmitBatcher.queue(mctpFd, &addr, tx.head(), tx.body(),
+                                   requestContext(eid, instanceId));
+    if (rc < 0)
     {
-        int error = -errno;
         lg2::error("Error while sending the message. RC={RC}, EID={ED}", "RC",
-                   strerror(-error), "ED", eid);
+                   strerror(-rc), "ED", eid);
         return NSM_SW_ERROR;
     }
 
     return NSM_SW_SUCCESS;
 }
 
-void InKernelHandler::handleReceivedMsg(IO& io, int fd,
+void InKernelHandler::handleReceivedMsg([[maybe_unused]] IO& io, int fd,
                                         [[maybe_unused]] uint32_t revents)
 {
-    int returnCode{0};
+    auto reply = [this, fd](const sockaddr_mctp& destAddr,
+                            const Response& response) {
+        int rc = transmitBatcher.queue(fd, &destAddr, {}, response);
+        if (rc < 0)
+        {
+            lg2::error("sendmsg system call failed, RC={RC}", "RC", rc);
+        }
+    };
 
-    ssize_t peekedLength = recv(fd, nullptr, 0, MSG_PEEK | MSG_TRUNC);
-    if (peekedLength == 0)
-    {
-        // This may or may not be an error scenario, in either case the
-        // recovery mechanism for this daemon is to restart, and hence
-        // exit the event loop, that will cause this daemon to exit with a
-        // failure code.
-        returnCode = -errno;
-        lg2::error("recv system call failed. Terminating. RC={RC}", "RC",
-                   returnCode);
-        io.get_event().exit(0);
-    }
-    else if (peekedLength <= -1)
+    auto handled = receiveEngine.drain(fd, [&](const RxMessage& rxMsg) {
+        return handleInKernelMsg(rxMsg, reply);
+    });
+
+    if (handled < 0)
     {
-        returnCode = -errno;
-        lg2::error("recv system call failed, RC={RC}", "RC", returnCode);
+        lg2::error("recvmmsg system call failed, RC={RC}", "RC", handled);
     }
-    else
+    else if (verbose)
     {
-        std::vector<uint8_t> requestMsg(peekedLength);
-
-        struct sockaddr_mctp addr;
-        memset(&addr, 0, sizeof(addr));
-
-        socklen_t addrlen = sizeof(addr);
-
-        ssize_t recvDataLength = recvfrom(
-            fd, static_cast<void*>(requestMsg.data()), peekedLength, MSG_TRUNC,
-            reinterpret_cast<struct sockaddr*>(&addr), &addrlen);
-
-        if (recvDataLength == peekedLength)
-        {
-            if (verbose)
-            {
-                utils::printBuffer(utils::Rx, requestMsg, addr.smctp_tag,
-                                   addr.smctp_addr.s_addr);
-            }
-
-            if (MCTP_MSG_TYPE_VDM != addr.smctp_type)
-            {
-                // Skip this message and continue.
-            }
-            else
-            {
-                // process message and send response
-                auto response = processRxMsg(
-                    addr.smctp_tag, addr.smctp_addr.s_addr, addr.smctp_type,
-                    requestMsg.data(), requestMsg.size());
-                if (response.has_value())
-                {
-                    if (verbose)
-                    {
-                        utils::printBuffer(utils::Tx, *response, addr.smctp_tag,
-                                           addr.smctp_addr.s_addr);
-                    }
-
-                    struct sockaddr_mctp destAddr;
-                    memset(&destAddr, 0, sizeof(destAddr));
-
-                    destAddr.smctp_family = AF_MCTP;
-                    destAddr.smctp_network = MCTP_NET_ANY;
-                    destAddr.smctp_addr.s_addr = addr.smctp_addr.s_addr;
-                    destAddr.smctp_type = requestMsg[0];
-
-                    constexpr uint8_t tagOwnerBitPos = 3;
-                    constexpr uint8_t tagOwnerMask = ~(1 << tagOwnerBitPos);
-                    destAddr.smctp_tag = addr.smctp_tag & tagOwnerMask;
-
-                    ssize_t rc =
-                        sendto(fd, response->data(), response->size(), 0,
-                               reinterpret_cast<struct sockaddr*>(&destAddr),
-                               sizeof(destAddr));
-                    if (rc == -1)
-                    {
-                        returnCode = -errno;
-                        lg2::error("sendmsg system call failed, RC={RC}", "RC",
-                                   returnCode);
-                    }
-                }
-            }
-        }
-        else
-        {
-            returnCode = -errno;
-            lg2::error(
-                "Failure to read peeked length packet. peekedLength="
-                "{PEEKEDLENGTH} recvDataLength={RECVDATALENGTH} ErrorNo={ERROR}",
-                "PEEKEDLENGTH", peekedLength, "RECVDATALENGTH", recvDataLength,
-                "ERROR", returnCode);
-        }
+        lg2::info("Handled {COUNT} MCTP messages in one wakeup", "COUNT",
+                  handled);
     }
 }
 } // namespace mctp_socket
@@ -17,15 +17,26 @@
 
 #pragma once
 
+#include "libnsm/base.h"
+#include "libnsm/requester/mctp.h"
+
 #include "eventManager.hpp"
+#include "receive_engine.hpp"
 #include "socket_manager.hpp"
+#include "transmit_batcher.hpp"
 #include "types.hpp"
 
+#include <linux/mctp.h>
+
 #include <sdeventplus/event.hpp>
 #include <sdeventplus/source/io.hpp>
 
+#include <array>
+#include <chrono>
+#include <functional>
 #include <map>
 #include <optional>
+#include <span>
 #include <unordered_map>
 
 namespace requester
@@ -44,6 +55,68 @@ using PathName = std::string;
 using namespace sdeventplus;
 using namespace sdeventplus::source;
 
+/** @brief Addressing of the MCTP sockets
+ *
+ *  InKernel is the AF_MCTP socket addressed with sockaddr_mctp, Demux the
+ *  sockets of the MCTP demux daemon which prefix every message with tag, EID
+ *  and message type.
+ */
+enum class Framing
+{
+    InKernel,
+    Demux
+};
+
+/** @class TxMessage
+ *
+ *  A NSM message split for sending into a head and a body. The head holds
+ *  the demux prefix, if any, and for a request a copy of the NSM header
+ *  carrying its instance ID, the body the rest of the message. The message
+ *  itself is never written to, so a request template shared between
+ *  requests is sent as is. The head is sent from the object, which must
+ *  outlive the send or be copied.
+ */
+class TxMessage
+{
+  public:
+    TxMessage(const TxMessage&) = delete;
+    TxMessage(TxMessage&&) = delete;
+    TxMessage& operator=(const TxMessage&) = delete;
+    TxMessage& operator=(TxMessage&&) = delete;
+    ~TxMessage() = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] prefix - demux prefix, empty for the AF_MCTP socket
+     *  @param[in] nsmMsg - NSM message
+     *  @param[in] instanceId - instance ID to send the message with, none
+     *                          to send the header as is
+     */
+    TxMessage(std::span<const uint8_t> prefix, std::span<const uint8_t> nsmMsg,
+              std::optional<uint8_t> instanceId);
+
+    /** @brief Bytes to send before the body */
+    std::span<const uint8_t> head() const
+    {
+        return {bytes.data(), headSize};
+    }
+
+    /** @brief Rest of the NSM message */
+    std::span<const uint8_t> body() const
+    {
+        return rest;
+    }
+
+    /** @brief The NSM message as it is sent, for tracing */
+    std::vector<uint8_t> nsmMsg() const;
+
+  private:
+    std::array<uint8_t, MCTP_DEMUX_PREFIX + sizeof(nsm_msg_hdr)> bytes{};
+    size_t prefixSize = 0;
+    size_t headSize = 0;
+    std::span<const uint8_t> rest;
+};
+
 /** @class Handler
  *
  *  The Handler class abstracts the communication with multiple MCTP Tx/Rx
@@ -63,6 +136,8 @@ class Handler
     Handler& operator=(Handler&&) = default;
     virtual ~Handler() = default;
 
+    using Clock = std::chrono::steady_clock;
+
     const uint8_t MCTP_MSG_TYPE_VDM = 0x7e;
 
     /** @brief Constructor
@@ -85,8 +160,49 @@ class Handler
     virtual int registerMctpEndpoint(eid_t eid, int type, int protocol,
                                      const std::vector<uint8_t>& pathName) = 0;
 
+    /** @brief Send a NSM message
+     *
+     *  @param[in] tag - MCTP message tag
+     *  @param[in] eid - endpoint ID of the receiver
+     *  @param[in] mctpFd - socket the endpoint is registered on
+     *  @param[in] nsmMsg - NSM message, which is not written to
+     *  @param[in] nsmMsgLen - length of the NSM message
+     *  @param[in] instanceId - instance ID of a request, sent in place of
+     *                          the one in the header of nsmMsg. None for a
+     *                          response, which is sent as is.
+     *
+     *  @return NSM_SW_SUCCESS if the message is sent or queued, NSM_SW_ERROR
+     *          otherwise. A queued request which later fails to be sent is
+     *          reported to the requester handler with its instance ID.
+     */
     virtual int sendMsg(uint8_t tag, eid_t eid, int mctpFd,
-                        const uint8_t* nsmMsg, size_t nsmMsgLen) const = 0;
+                        const uint8_t* nsmMsg, size_t nsmMsgLen,
+                        std::optional<uint8_t> instanceId) const = 0;
+
+    /** @brief Get the counters of the receive path */
+    virtual const ReceiveStats& getReceiveStats() const
+    {
+        return receiveEngine.getStats();
+    }
+
+    /** @brief Get the counters of the receive buffer pool */
+    virtual const BufferPoolStats& getReceiveBufferStats() const
+    {
+        return receiveEngine.getBufferStats();
+    }
+
+    /** @brief Get the counters of the transmit path, which stay at zero for
+     *         the handlers which send without the transmit batcher
+     */
+    const TransmitStats& getTransmitStats() const
+    {
+        return transmitBatcher.getStats();
+    }
+
+    /** @brief Log the counters of the receive and transmit paths, on demand
+     *         through the LogDump D-Bus method
+     */
+    virtual void logStats() const;
 
   private:
     virtual void handleReceivedMsg(IO& io, int fd, uint32_t revents) = 0;
@@ -99,21 +215,128 @@ class Handler
     sdeventplus::Event& event;
     bool verbose;
 
-    std::optional<Response> processRxMsg(uint8_t tag, uint8_t eid, uint8_t type,
-                                         const uint8_t* nsmMsg,
-                                         size_t nsmMsgSize);
+    /** @brief Batched receive path shared by the sockets of the handler */
+    ReceiveEngine receiveEngine{MCTP_RX_BATCH_SIZE,
+                                MCTP_RX_BUFFER_SIZE + MCTP_DEMUX_PREFIX};
+
+    /** @brief Batched transmit path shared by the sockets of the handler,
+     *         sendMsg() is const in the Handler interface and queues to it
+     */
+    mutable TransmitBatcher transmitBatcher{event};
+
+    /** @brief Sends the response to a message received on an AF_MCTP
+     *         socket to the given address
+     */
+    using InKernelReply = std::function<void(const sockaddr_mctp& addr,
+                                             const Response& response)>;
+
+    /** @brief Sends the response to a message received on a demux daemon
+     *         socket, after the given demux prefix
+     */
+    using DemuxReply = std::function<void(std::span<const uint8_t> prefix,
+                                          const Response& response)>;
+
+    /** @brief Handle a NSM message
+     *
+     *  @param[in] tag - MCTP message tag
+     *  @param[in] eid - endpoint ID of the sender
+     *  @param[in] type - MCTP message type
+     *  @param[in] nsmMsg - NSM message
+     *  @param[in] nsmMsgSize - length of the NSM message
+     *  @param[in] received - time the message was received, unset if it is
+     *                        handled as soon as it is received
+     *
+     *  @return response to send back, if any
+     */
+    std::optional<Response>
+        processRxMsg(uint8_t tag, uint8_t eid, uint8_t type,
+                     const std::shared_ptr<const nsm_msg>& nsmMsg,
+                     size_t nsmMsgSize, Clock::time_point received = {});
+
+    /** @brief Handle a message received on an AF_MCTP socket
+     *
+     *  @param[in] rxMsg - received message, addressed with sockaddr_mctp
+     *  @param[in] reply - sends the response, if any
+     *  @param[in] received - time the message was received
+     *
+     *  @return false if the event loop is exiting
+     */
+    bool handleInKernelMsg(const RxMessage& rxMsg, const InKernelReply& reply,
+                           Clock::time_point received = {});
+
+    /** @brief Handle a message received on a demux daemon socket
+     *
+     *  @param[in] rxMsg - received message, starting with the demux prefix
+     *  @param[in] reply - sends the response, if any
+     *  @param[in] received - time the message was received
+     *
+     *  @return false if the event loop is exiting
+     */
+    bool handleDemuxMsg(const RxMessage& rxMsg, const DemuxReply& reply,
+                        Clock::time_point received = {});
+
+    /** @brief Context of a queued message, which identifies the request to
+     *         fail if it cannot be sent
+     *
+     *  @return the EID and the instance ID of a request, none otherwise
+     */
+    static std::optional<uint32_t>
+        requestContext(eid_t eid, std::optional<uint8_t> instanceId);
+
+    /** @brief Fail at once the request of a queued message the transport
+     *         could not send, rather than after its timeout
+     *
+     *  @param[in] context - context of the message, from requestContext()
+     *  @param[in] rc - -errno of the failed send
+     */
+    void handleSendFailure(uint32_t context, int rc);
+
+    /** @brief Address of a NSM endpoint on the AF_MCTP socket
+     *
+     *  @param[in] eid - EID of the endpoint
+     *  @param[in] tag - MCTP tag of the message
+     *  @param[in] type - MCTP message type, a reply keeps the type of the
+     *                    received message
+     */
+    static sockaddr_mctp mctpAddress(eid_t eid, uint8_t tag,
+                                     uint8_t type = MCTP_MSG_TYPE_PCI_VDM);
+
+    /** @brief Open the AF_MCTP socket bound to the NSM message type
+     *
+     *  @param[out] sendBufferSize - default send buffer size of the socket
+     *
+     *  @return socket on success, -errno otherwise
+     */
+    static int openInKernelSocket(int& sendBufferSize);
+
+    /** @brief Connect to a MCTP demux daemon and register for VDM messages
+     *
+     *  @param[in] type - socket type
+     *  @param[in] protocol - socket protocol
+     *  @param[in] pathName - abstract socket name of the daemon
+     *  @param[out] sendBufferSize - default send buffer size of the socket
+     *
+     *  @return socket on success, -errno otherwise
+     */
+    int openDemuxSocket(int type, int protocol,
+                        const std::vector<uint8_t>& pathName,
+                        int& sendBufferSize) const;
 };
 
 class InKernelHandler : public Handler
 {
   public:
-    using Handler::Handler;
+    InKernelHandler(sdeventplus::Event& event,
+                    requester::Handler<requester::Request>& handler,
+                    nsm::EventManager& eventManager, Manager& manager,
+                    bool verbose);
 
     int registerMctpEndpoint(eid_t eid, int type, int protocol,
                              const std::vector<uint8_t>& pathName) override;
 
     int sendMsg(uint8_t tag, eid_t eid, int mctpFd, const uint8_t* nsmMsg,
-                size_t nsmMsgLen) const override;
+                size_t nsmMsgLen,
+                std::optional<uint8_t> instanceId) const override;
 
   private:
     void handleReceivedMsg(IO& io, int fd, uint32_t revents) override;
@@ -127,13 +350,17 @@ class InKernelHandler : public Handler
 class DaemonHandler : public Handler
 {
   public:
-    using Handler::Handler;
+    DaemonHandler(sdeventplus::Event& event,
+                  requester::Handler<requester::Request>& handler,
+                  nsm::EventManager& eventManager, Manager& manager,
+                  bool verbose);
 
     int registerMctpEndpoint(eid_t eid, int type, int protocol,
                              const std::vector<uint8_t>& pathName) override;
 
     int sendMsg(uint8_t tag, eid_t eid, int mctpFd, const uint8_t* nsmMsg,
-                size_t nsmMsgLen) const override;
+                size_t nsmMsgLen,
+                std::optional<uint8_t> instanceId) const override;
 
   private:
     SocketInfo initSocket(eid_t eid, int type, int protocol,
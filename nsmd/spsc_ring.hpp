@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace mctp_socket
+{
+
+/** @class SpscRing
+ *
+ *  Bounded lock-free FIFO between exactly one producer thread and one
+ *  consumer thread. Each side caches the index of the other side and only
+ *  reads the shared index when the cached one says the ring is full or
+ *  empty, so a steady stream costs no cache line transfer per element.
+ *  Popped slots are left moved-from, so an element is only ever destroyed by
+ *  the thread which popped it or by the destructor of the ring.
+ */
+template <typename T>
+class SpscRing
+{
+  public:
+    SpscRing(const SpscRing&) = delete;
+    SpscRing(SpscRing&&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+    SpscRing& operator=(SpscRing&&) = delete;
+    ~SpscRing() = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] capacity - minimum number of elements, rounded up to a
+     *                        power of two
+     */
+    explicit SpscRing(size_t capacity) :
+        mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+        slots(mask + 1)
+    {}
+
+    /** @brief Append an element, producer only
+     *
+     *  @return false if the ring is full, value is left untouched then
+     */
+    bool push(T&& value)
+    {
+        auto tail = producer.tail.load(std::memory_order_relaxed);
+        if (tail - producer.cachedHead > mask)
+        {
+            producer.cachedHead = consumer.head.load(std::memory_order_acquire);
+            if (tail - producer.cachedHead > mask)
+            {
+                return false;
+            }
+        }
+        slots[tail & mask] = std::move(value);
+        producer.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Remove the oldest element, consumer only
+     *
+     *  @return false if the ring is empty
+     */
+    bool pop(T& value)
+    {
+        auto head = consumer.head.load(std::memory_order_relaxed);
+        if (head == consumer.cachedTail)
+        {
+            consumer.cachedTail = producer.tail.load(std::memory_order_acquire);
+            if (head == consumer.cachedTail)
+            {
+                return false;
+            }
+        }
+        value = std::move(slots[head & mask]);
+        consumer.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Number of elements which can be pushed without failing,
+     *         producer only
+     */
+    size_t available()
+    {
+        producer.cachedHead = consumer.head.load(std::memory_order_acquire);
+        return capacity() -
+               (producer.tail.load(std::memory_order_relaxed) -
+                producer.cachedHead);
+    }
+
+    size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+  private:
+    static constexpr size_t cacheLine = 64;
+
+    /** @brief Written by the producer, the head is only a cached copy */
+    struct alignas(cacheLine) Producer
+    {
+        std::atomic<size_t> tail{0};
+        size_t cachedHead = 0;
+    };
+
+    /** @brief Written by the consumer, the tail is only a cached copy */
+    struct alignas(cacheLine) Consumer
+    {
+        std::atomic<size_t> head{0};
+        size_t cachedTail = 0;
+    };
+
+    const size_t mask;
+    std::vector<T> slots;
+    Producer producer;
+    Consumer consumer;
+};
+
+} // namespace mctp_socket
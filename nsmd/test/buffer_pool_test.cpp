@@ -0,0 +1,76 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "buffer_pool.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace mctp_socket;
+
+TEST(BufferPoolTest, ReleasedBufferIsReused)
+{
+    BufferPool pool(64, 4);
+    auto first = pool.acquire();
+    auto raw = first.get();
+    EXPECT_EQ(pool.getStats().inUse, 1u);
+
+    first.reset();
+    EXPECT_EQ(pool.getStats().inUse, 0u);
+    EXPECT_EQ(pool.getStats().idle, 1u);
+
+    auto second = pool.acquire();
+    EXPECT_EQ(second.get(), raw);
+    EXPECT_EQ(pool.getStats().acquired, 2u);
+    EXPECT_EQ(pool.getStats().allocated, 1u);
+}
+
+TEST(BufferPoolTest, SharedBufferReturnsWithLastOwner)
+{
+    BufferPool pool(64, 4);
+    auto buffer = pool.acquire();
+    auto copy = buffer;
+
+    buffer.reset();
+    EXPECT_EQ(pool.getStats().inUse, 1u);
+    copy.reset();
+    EXPECT_EQ(pool.getStats().inUse, 0u);
+}
+
+TEST(BufferPoolTest, IdleBuffersAreBounded)
+{
+    BufferPool pool(64, 1);
+    auto first = pool.acquire();
+    auto second = pool.acquire();
+    first.reset();
+    second.reset();
+
+    EXPECT_EQ(pool.getStats().idle, 1u);
+    EXPECT_EQ(pool.getStats().allocated, 2u);
+}
+
+TEST(BufferPoolTest, BufferOutlivesPool)
+{
+    BufferPool::Buffer buffer;
+    {
+        BufferPool pool(64, 4);
+        buffer = pool.acquire();
+    }
+    buffer[0] = 0xab;
+    EXPECT_EQ(buffer[0], 0xab);
+    buffer.reset();
+}
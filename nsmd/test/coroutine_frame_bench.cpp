@@ -0,0 +1,181 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* Benchmark of a polling cycle over a set of sensors whose requests complete
+ * at once, with and without the coroutine frame pool. Each update allocates
+ * the frames of NsmSensor::update and SensorManager::SendRecvNsmMsg.
+ */
+
+#include "libnsm/base.h"
+
+#include "common/frame_pool.hpp"
+#include "nsmSensor.hpp"
+#include "sensorManager.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace nsm;
+
+static constexpr eid_t eid = 8;
+static constexpr size_t numSensors = 500;
+static constexpr size_t cycles = 200;
+
+class PingSensor : public NsmSensor
+{
+  public:
+    PingSensor() : NsmSensor("Ping", "Bench") {}
+
+    std::optional<std::vector<uint8_t>>
+        genRequestMsg(eid_t, uint8_t instanceId) override
+    {
+        std::vector<uint8_t> request(sizeof(nsm_msg_hdr) +
+                                     sizeof(nsm_common_req));
+        encode_ping_req(instanceId, reinterpret_cast<nsm_msg*>(request.data()));
+        return request;
+    }
+
+    uint8_t handleResponseMsg(const nsm_msg* responseMsg,
+                              size_t responseLen) override
+    {
+        return decode_ping_resp(responseMsg, responseLen, &cc, &reasonCode);
+    }
+
+  private:
+    uint8_t cc = 0;
+    uint16_t reasonCode = 0;
+};
+
+/** @brief Sensor manager answering every request at once */
+class ImmediateSensorManager : public SensorManager
+{
+  public:
+    explicit ImmediateSensorManager(NsmDeviceTable& devices) :
+        SensorManager(devices, 0),
+        response(std::make_shared<Response>(sizeof(nsm_msg_hdr) +
+                                            sizeof(nsm_common_resp)))
+    {
+        encode_ping_resp(0, ERR_NULL,
+                         reinterpret_cast<nsm_msg*>(response->data()));
+    }
+
+    requester::Coroutine
+        SendRecvNsmMsg(eid_t, Request&,
+                       std::shared_ptr<const nsm_msg>& responseMsg,
+                       size_t& responseLen) override
+    {
+        respond(responseMsg, responseLen);
+        // coverity[missing_return]
+        co_return NSM_SW_SUCCESS;
+    }
+
+    requester::Coroutine
+        SendRecvNsmMsg(eid_t, const RequestTemplate&,
+                       std::shared_ptr<const nsm_msg>& responseMsg,
+                       size_t& responseLen) override
+    {
+        respond(responseMsg, responseLen);
+        // coverity[missing_return]
+        co_return NSM_SW_SUCCESS;
+    }
+
+    eid_t getEid(std::shared_ptr<NsmDevice>) override
+    {
+        return eid;
+    }
+
+    std::shared_ptr<NsmDevice> resolveNsmDevice(eid_t) override
+    {
+        return nullptr;
+    }
+
+    void startPolling(uuid_t) override {}
+
+    sdbusplus::asio::object_server& getObjServer() override
+    {
+        std::abort();
+    }
+
+  private:
+    std::shared_ptr<Response> response;
+
+    void respond(std::shared_ptr<const nsm_msg>& responseMsg,
+                 size_t& responseLen)
+    {
+        responseMsg = std::shared_ptr<const nsm_msg>(
+            response, reinterpret_cast<const nsm_msg*>(response->data()));
+        responseLen = response->size();
+    }
+};
+
+static requester::Coroutine
+    pollCycle(SensorManager& manager,
+              std::vector<std::unique_ptr<NsmSensor>>& sensors)
+{
+    for (auto& sensor : sensors)
+    {
+        co_await sensor->update(manager, eid);
+    }
+    // coverity[missing_return]
+    co_return NSM_SW_SUCCESS;
+}
+
+static double nsPerUpdate(SensorManager& manager,
+                          std::vector<std::unique_ptr<NsmSensor>>& sensors)
+{
+    // warm up, fills the pool when it is enabled
+    pollCycle(manager, sensors);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < cycles; i++)
+    {
+        pollCycle(manager, sensors);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           (cycles * sensors.size());
+}
+
+int main()
+{
+    NsmDeviceTable devices;
+    ImmediateSensorManager manager(devices);
+    std::vector<std::unique_ptr<NsmSensor>> sensors;
+    for (size_t i = 0; i < numSensors; i++)
+    {
+        sensors.push_back(std::make_unique<PingSensor>());
+    }
+
+    auto& pool = common::FramePool::local();
+    pool.setCapacity(0);
+    auto heap = nsPerUpdate(manager, sensors);
+
+    pool.setCapacity(COROUTINE_FRAME_POOL_CAPACITY);
+    auto hits = pool.getStats().hits;
+    auto allocations = pool.getStats().allocations;
+    auto pooled = nsPerUpdate(manager, sensors);
+    auto hitRate = static_cast<double>(pool.getStats().hits - hits) /
+                   (pool.getStats().allocations - allocations);
+
+    std::cout << "heap frames:   " << heap << " ns per sensor update\n"
+              << "pooled frames: " << pooled << " ns per sensor update, "
+              << hitRate * 100 << "% hits, peak "
+              << pool.getStats().peakLive << " live frames\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,52 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "eid_registry.hpp"
+#include "nsmDevice.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace nsm;
+
+TEST(EidRegistryTest, DeviceStaysBoundUntilRediscovery)
+{
+    auto& registry = EidRegistry::getInstance();
+    constexpr eid_t eid = 30;
+    EXPECT_EQ(registry.getDevice(eid), nullptr);
+    EXPECT_EQ(registry.get(eid).state, EidState::Unknown);
+
+    auto device = std::make_shared<NsmDevice>("STATIC:1:0");
+    registry.setOnline(eid);
+    registry.bind(eid, device);
+    EXPECT_EQ(registry.getDevice(eid), device);
+    EXPECT_EQ(registry.get(eid).state, EidState::Online);
+
+    // an offline EID keeps its device, which reports itself inactive
+    registry.setOffline(eid);
+    EXPECT_EQ(registry.getDevice(eid), device);
+    EXPECT_EQ(registry.get(eid).state, EidState::Offline);
+
+    // the EID may belong to another device once it is back
+    registry.setOnline(eid);
+    EXPECT_EQ(registry.getDevice(eid), nullptr);
+    EXPECT_EQ(registry.get(eid).state, EidState::Online);
+
+    registry.bind(eid, device);
+    registry.unbind(eid);
+    EXPECT_EQ(registry.getDevice(eid), nullptr);
+    EXPECT_EQ(registry.getDevice(eid + 1), nullptr);
+}
@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "globalPollingStateManager.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace nsm;
+
+requester::Coroutine throttle(GlobalPollingStateManager& manager,
+                              NsmDevice& device, bool& resumed)
+{
+    co_await manager.waitForNonPriority(device);
+    resumed = true;
+    // coverity[missing_return]
+    co_return NSM_SW_SUCCESS;
+}
+
+TEST(GlobalPollingStateManagerTest, WaitersResumeWhenNoDeviceIsPriority)
+{
+    auto event = sdeventplus::Event::get_default();
+    GlobalPollingStateManager manager(event);
+    NsmDevice first("STATIC:1:0");
+    NsmDevice second("STATIC:1:1");
+    NsmDevice throttled("STATIC:1:2");
+    EXPECT_EQ(manager.getState(), POLL_NON_PRIORITY);
+
+    // no device in priority polling, the wait completes right away
+    bool resumed = false;
+    auto co = throttle(manager, throttled, resumed);
+    EXPECT_TRUE(resumed);
+
+    manager.setPollingState(first, POLL_PRIORITY);
+    manager.setPollingState(first, POLL_PRIORITY);
+    manager.setPollingState(second, POLL_PRIORITY);
+    EXPECT_EQ(manager.getState(), POLL_PRIORITY);
+
+    resumed = false;
+    auto waiting = throttle(manager, throttled, resumed);
+    manager.setPollingState(first, POLL_NON_PRIORITY);
+    event.run(std::chrono::milliseconds(0));
+    EXPECT_FALSE(resumed);
+    EXPECT_EQ(manager.getState(), POLL_PRIORITY);
+
+    // waiters are resumed from the event loop once the count drops to zero
+    manager.setPollingState(second, POLL_NON_PRIORITY);
+    EXPECT_EQ(manager.getState(), POLL_NON_PRIORITY);
+    EXPECT_FALSE(resumed);
+    event.run(std::chrono::milliseconds(0));
+    EXPECT_TRUE(resumed);
+
+    EXPECT_EQ(throttled.pollingThrottleStats.throttled, 1u);
+    EXPECT_EQ(first.pollingThrottleStats.throttled, 0u);
+}
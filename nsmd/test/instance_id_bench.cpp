@@ -0,0 +1,90 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* Microbenchmark of an instance ID allocation and release cycle, for the
+ * in-process allocator and the OFD lock instance ID database.
+ */
+
+#include "instance_id.hpp"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+using namespace nsm;
+
+static constexpr uint8_t eid = 8;
+static constexpr size_t iterations = 200000;
+
+/** @brief Time allocation and release with a few instance IDs outstanding,
+ *         as with a request window, so the allocator has to skip used IDs
+ */
+static double nsPerCycle(InstanceIdDb& db)
+{
+    uint8_t window[4];
+    for (auto& id : window)
+    {
+        id = db.next(eid);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++)
+    {
+        auto& id = window[i % std::size(window)];
+        db.free(eid, id);
+        id = db.next(eid);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    for (auto id : window)
+    {
+        db.free(eid, id);
+    }
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           iterations;
+}
+
+int main()
+{
+    std::string path = std::filesystem::temp_directory_path() /
+                       "nsmd-instance-id-bench-XXXXXX";
+    int fd = mkstemp(path.data());
+    if (fd < 0 || ftruncate(fd, 256 * (NSM_INSTANCE_MAX + 1)) != 0)
+    {
+        std::cerr << "Failed to create the instance ID database\n";
+        return EXIT_FAILURE;
+    }
+    close(fd);
+
+    double local;
+    double shared;
+    {
+        InstanceIdDb localDb;
+        local = nsPerCycle(localDb);
+        InstanceIdDb sharedDb(path);
+        shared = nsPerCycle(sharedDb);
+    }
+    std::filesystem::remove(path);
+
+    std::cout << "in-process bitmap: " << local << " ns per free+next\n"
+              << "OFD lock database: " << shared << " ns per free+next\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "instance_id.hpp"
+
+#include <set>
+
+#include <gtest/gtest.h>
+
+using namespace nsm;
+
+TEST(InstanceIdDbTest, AllocatesEveryInstanceIdOnce)
+{
+    InstanceIdDb db;
+    EXPECT_FALSE(db.isShared());
+
+    std::set<uint8_t> ids;
+    for (int i = 0; i <= NSM_INSTANCE_MAX; i++)
+    {
+        ids.insert(db.next(8));
+    }
+    EXPECT_EQ(ids.size(), NSM_INSTANCE_MAX + 1u);
+    EXPECT_EQ(*ids.rbegin(), NSM_INSTANCE_MAX);
+    EXPECT_THROW(db.next(8), std::runtime_error);
+
+    // instance IDs of other EIDs are independent
+    EXPECT_EQ(db.next(9), 0);
+}
+
+TEST(InstanceIdDbTest, AllocatesRoundRobin)
+{
+    InstanceIdDb db;
+    EXPECT_EQ(db.next(8), 0);
+    EXPECT_EQ(db.next(8), 1);
+    db.free(8, 0);
+    EXPECT_EQ(db.next(8), 2);
+
+    for (int i = 3; i <= NSM_INSTANCE_MAX; i++)
+    {
+        EXPECT_EQ(db.next(8), i);
+    }
+    // wraps around to the freed instance ID
+    EXPECT_EQ(db.next(8), 0);
+}
+
+TEST(InstanceIdDbTest, FreeOfUnallocatedIdThrows)
+{
+    InstanceIdDb db;
+    EXPECT_THROW(db.free(8, 3), std::runtime_error);
+    EXPECT_THROW(db.free(8, NSM_INSTANCE_MAX + 1), std::runtime_error);
+
+    auto id = db.next(8);
+    db.free(8, id);
+    EXPECT_THROW(db.free(8, id), std::runtime_error);
+}
@@ -0,0 +1,142 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* Load test of the requester against in-process MockupResponder endpoints
+ * over the loopback transport. Every endpoint has one ping outstanding at
+ * a time, so the throughput is bound by nsmd and not by the endpoints.
+ *
+ * Usage: loopback_bench [endpoints [latency-us [seconds]]]
+ */
+
+#include "libnsm/base.h"
+
+#include "eventManager.hpp"
+#include "instance_id.hpp"
+#include "loopback_socket_handler.hpp"
+#include "mockupResponder.hpp"
+#include "requester/handler.hpp"
+#include "requester/request.hpp"
+#include "socket_manager.hpp"
+
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+
+static constexpr eid_t firstEid = 8;
+
+int main(int argc, char** argv)
+{
+    size_t endpoints = argc > 1 ? std::stoul(argv[1]) : 128;
+    microseconds latency(argc > 2 ? std::stoul(argv[2]) : 100);
+    seconds runTime(argc > 3 ? std::stoul(argv[3]) : 5);
+    if (endpoints == 0 || firstEid + endpoints > 255)
+    {
+        std::cerr << "Between 1 and " << 255 - firstEid << " endpoints\n";
+        return EXIT_FAILURE;
+    }
+
+    boost::asio::io_context io;
+    auto systemBus = std::make_shared<sdbusplus::asio::connection>(io);
+    sdbusplus::asio::object_server objServer(systemBus);
+
+    auto event = sdeventplus::Event::get_default();
+    nsm::InstanceIdDb instanceIdDb;
+    mctp_socket::Manager sockManager;
+    nsm::EventManager eventManager;
+    requester::Handler<requester::Request> reqHandler(event, instanceIdDb,
+                                                      sockManager, false);
+    mctp_socket::LoopbackHandler sockHandler(
+        event, reqHandler, eventManager, sockManager, false, latency);
+    reqHandler.setSocketHandler(&sockHandler);
+
+    std::vector<std::unique_ptr<MockupResponder::MockupResponder>> responders;
+    for (size_t i = 0; i < endpoints; i++)
+    {
+        eid_t eid = firstEid + i;
+        auto& responder = responders.emplace_back(
+            std::make_unique<MockupResponder::MockupResponder>(
+                false, event, objServer, eid, NSM_DEV_ID_GPU, i, false));
+        sockHandler.addResponder(
+            eid, std::bind_front(&MockupResponder::MockupResponder::processRxMsg,
+                                 responder.get()));
+    }
+
+    auto start = steady_clock::now();
+    auto deadline = start + runTime;
+    size_t completed = 0;
+    size_t failed = 0;
+    size_t outstanding = 0;
+    std::function<void(eid_t)> ping = [&](eid_t eid) {
+        std::vector<uint8_t> request(sizeof(nsm_msg_hdr) +
+                                     sizeof(nsm_common_req));
+        encode_ping_req(0, reinterpret_cast<nsm_msg*>(request.data()));
+        auto rc = reqHandler.registerRequest(
+            MCTP_MSG_TAG_REQ, eid, NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY,
+            NSM_PING, std::move(request),
+            [&](eid_t from, std::shared_ptr<const nsm_msg> response, size_t) {
+            outstanding--;
+            if (response)
+            {
+                completed++;
+            }
+            else
+            {
+                failed++;
+            }
+            if (steady_clock::now() < deadline)
+            {
+                ping(from);
+            }
+            else if (outstanding == 0)
+            {
+                event.exit(0);
+            }
+        });
+        if (rc == NSM_SUCCESS)
+        {
+            outstanding++;
+        }
+        else
+        {
+            failed++;
+        }
+    };
+
+    for (size_t i = 0; i < endpoints; i++)
+    {
+        ping(firstEid + i);
+    }
+    if (outstanding != 0)
+    {
+        event.loop();
+    }
+
+    auto elapsed = duration_cast<duration<double>>(steady_clock::now() -
+                                                   start);
+    std::cout << endpoints << " endpoints, " << latency.count()
+              << " us latency: " << completed / elapsed.count()
+              << " requests/s, " << failed << " failed\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "libnsm/base.h"
+
+#include "eventHandler.hpp"
+#include "loopback_socket_handler.hpp"
+#include "test/socketHandlerTest.hpp"
+
+#include <chrono>
+#include <vector>
+
+using namespace mctp_socket;
+using namespace std::chrono_literals;
+
+class CountingEventHandler : public nsm::EventHandler
+{
+  public:
+    explicit CountingEventHandler(size_t& count)
+    {
+        handlers.emplace(NSM_REDISCOVERY_EVENT,
+                         [&count](eid_t, NsmType, NsmEventId,
+                                  const std::shared_ptr<const nsm_msg>&,
+                                  size_t) { count++; });
+    }
+
+    uint8_t nsmType() override
+    {
+        return NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY;
+    }
+};
+
+class LoopbackHandlerTest : public SocketHandlerTest
+{
+  protected:
+    static constexpr eid_t eid = 14;
+
+    LoopbackHandlerTest() :
+        sockHandler(event, handler, eventManager, sockManager, false)
+    {
+        handler.setSocketHandler(&sockHandler);
+        eventManager.registerHandler(
+            NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY,
+            std::make_unique<CountingEventHandler>(numEvents));
+    }
+
+    /** @brief Responder answering pings, recording every message */
+    LoopbackHandler::Responder pingResponder()
+    {
+        return [this](const Request& rxMsg, std::optional<Request>&) {
+            received.push_back(rxMsg);
+            auto hdr = reinterpret_cast<const nsm_msg_hdr*>(
+                &rxMsg[MCTP_DEMUX_PREFIX]);
+            Response response(sizeof(nsm_msg_hdr) + sizeof(nsm_common_resp));
+            encode_ping_resp(hdr->instance_id, ERR_NULL,
+                             reinterpret_cast<nsm_msg*>(response.data()));
+            return std::optional<Response>(response);
+        };
+    }
+
+    int registerPing(bool& completed)
+    {
+        std::vector<uint8_t> request(sizeof(nsm_msg_hdr) +
+                                     sizeof(nsm_common_req));
+        encode_ping_req(0, reinterpret_cast<nsm_msg*>(request.data()));
+        return handler.registerRequest(
+            MCTP_MSG_TAG_REQ, eid, NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY,
+            NSM_PING, std::move(request),
+            [&](eid_t, std::shared_ptr<const nsm_msg> response, size_t) {
+            completed = response != nullptr;
+        });
+    }
+
+    LoopbackHandler sockHandler;
+    std::vector<Request> received;
+    size_t numEvents = 0;
+};
+
+TEST_F(LoopbackHandlerTest, ResponseIsDeliveredFromEventLoop)
+{
+    sockHandler.addResponder(eid, pingResponder());
+
+    bool completed = false;
+    ASSERT_EQ(registerPing(completed), NSM_SUCCESS);
+    EXPECT_TRUE(received.empty());
+    EXPECT_EQ(sockHandler.getNumPending(), 1);
+
+    EXPECT_TRUE(runUntil([&] { return completed; }));
+    ASSERT_EQ(received.size(), 1);
+    EXPECT_EQ(received[0][0], MCTP_MSG_TAG_REQ);
+    EXPECT_EQ(received[0][1], eid);
+    EXPECT_EQ(sockHandler.getNumPending(), 0);
+    EXPECT_EQ(sockHandler.getLoopbackStats().requests, 1);
+    EXPECT_EQ(sockHandler.getLoopbackStats().responses, 1);
+}
+
+TEST_F(LoopbackHandlerTest, LatencyDelaysDelivery)
+{
+    sockHandler.addResponder(eid, pingResponder(), 20ms);
+
+    bool completed = false;
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(registerPing(completed), NSM_SUCCESS);
+    event.run(std::chrono::milliseconds(0));
+    EXPECT_TRUE(received.empty());
+
+    EXPECT_TRUE(runUntil([&] { return completed; }));
+    // the request and the response each take the latency
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 40ms);
+}
+
+TEST_F(LoopbackHandlerTest, UnknownEidIsUnroutable)
+{
+    uint8_t msg[sizeof(nsm_msg_hdr)]{};
+    EXPECT_EQ(sockHandler.sendMsg(MCTP_MSG_TAG_REQ, eid, 0, msg, sizeof(msg),
+                                  std::nullopt),
+              NSM_SW_ERROR);
+    EXPECT_EQ(sockHandler.getLoopbackStats().unroutable, 1);
+    EXPECT_LT(sockHandler.registerMctpEndpoint(eid, 0, 0, {}), 0);
+
+    sockHandler.addResponder(eid, pingResponder());
+    EXPECT_EQ(sockHandler.registerMctpEndpoint(eid, 0, 0, {}), 0);
+}
+
+TEST_F(LoopbackHandlerTest, LongRunningEventIsAcknowledged)
+{
+    sockHandler.addResponder(
+        eid, [this, ping = pingResponder()](
+                 const Request& rxMsg, std::optional<Request>& longRunning) {
+        if (!received.empty())
+        {
+            // acknowledgement of the event
+            received.push_back(rxMsg);
+            return std::optional<Response>();
+        }
+        longRunning.emplace(sizeof(nsm_msg_hdr) + NSM_EVENT_MIN_LEN);
+        encode_nsm_rediscovery_event(
+            0, true, reinterpret_cast<nsm_msg*>(longRunning->data()));
+        return ping(rxMsg, longRunning);
+    });
+
+    bool completed = false;
+    ASSERT_EQ(registerPing(completed), NSM_SUCCESS);
+    EXPECT_TRUE(runUntil([&] { return received.size() == 2; }));
+    EXPECT_TRUE(completed);
+    EXPECT_EQ(numEvents, 1);
+    EXPECT_EQ(sockHandler.getLoopbackStats().events, 1);
+
+    // the acknowledgement is a response, without the tag owner bit
+    EXPECT_EQ(received[1][0], MCTP_MSG_TAG_REQ & ~(1 << 3));
+    auto hdr = reinterpret_cast<const nsm_msg_hdr*>(
+        &received[1][MCTP_DEMUX_PREFIX]);
+    EXPECT_EQ(hdr->request, 0);
+}
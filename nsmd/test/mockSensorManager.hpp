@@ -39,6 +39,8 @@ struct MockSensorManager : public SensorManager
                 (override));
     MOCK_METHOD(eid_t, getEid, (std::shared_ptr<NsmDevice> nsmDevice),
                 (override));
+    MOCK_METHOD(std::shared_ptr<NsmDevice>, resolveNsmDevice, (eid_t eid),
+                (override));
     MOCK_METHOD(void, startPolling, (uuid_t uuid), (override));
     MOCK_METHOD(sdbusplus::asio::object_server&, getObjServer, (), (override));
 };
@@ -41,3 +41,29 @@ TEST(nsmDevice, GoodTest)
     auto getMode = nsmDevice.getEventMode();
     EXPECT_EQ(setMode, getMode);
 }
+
+TEST(nsmDevice, LongRunningLanesAreKeyedByCommand)
+{
+    uuid_t uuid = "00000000-0000-0000-0000-000000000000";
+    nsm::NsmDevice nsmDevice(uuid);
+    auto type = NSM_TYPE_PLATFORM_ENVIRONMENTAL;
+
+    auto& migLane = nsmDevice.getSemaphore(type, NSM_SET_MIG_MODE);
+    auto& eccLane = nsmDevice.getSemaphore(type, NSM_SET_ECC_MODE);
+    EXPECT_NE(&migLane, &eccLane);
+    EXPECT_EQ(&migLane, &nsmDevice.getSemaphore(type, NSM_SET_MIG_MODE));
+
+    // both operations are outstanding at once
+    nsmDevice.registerLongRunningHandler(type, NSM_SET_MIG_MODE, nullptr);
+    nsmDevice.registerLongRunningHandler(type, NSM_SET_ECC_MODE, nullptr);
+    EXPECT_EQ(nsmDevice.getNumActiveLongRunningHandlers(), 2u);
+
+    nsmDevice.clearLongRunningHandler(type, NSM_SET_MIG_MODE);
+    EXPECT_FALSE(nsmDevice.getActiveLongRunningHandler(type, NSM_SET_MIG_MODE)
+                     .has_value());
+    auto handler = nsmDevice.getActiveLongRunningHandler(type,
+                                                         NSM_SET_ECC_MODE);
+    ASSERT_TRUE(handler.has_value());
+    EXPECT_EQ(handler->commandCode, NSM_SET_ECC_MODE);
+    EXPECT_EQ(nsmDevice.getNumActiveLongRunningHandlers(), 1u);
+}
@@ -0,0 +1,143 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "receive_engine.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace mctp_socket;
+
+class ReceiveEngineTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds), 0);
+    }
+
+    void TearDown() override
+    {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    void sendMsg(size_t len, uint8_t fill)
+    {
+        std::vector<uint8_t> msg(len, fill);
+        ASSERT_EQ(send(fds[1], msg.data(), msg.size(), 0),
+                  static_cast<ssize_t>(len));
+    }
+
+    int fds[2];
+};
+
+TEST_F(ReceiveEngineTest, DrainsMultipleMessagesInOneWakeup)
+{
+    ReceiveEngine engine(4, 64);
+    for (uint8_t i = 1; i <= 6; i++)
+    {
+        sendMsg(i, i);
+    }
+
+    std::vector<size_t> lengths;
+    auto rc = engine.drain(fds[0], [&](const RxMessage& msg) {
+        EXPECT_EQ(msg.data[0], msg.length);
+        lengths.push_back(msg.length);
+        return true;
+    });
+
+    EXPECT_EQ(rc, 6);
+    EXPECT_EQ(lengths, (std::vector<size_t>{1, 2, 3, 4, 5, 6}));
+    const auto& stats = engine.getStats();
+    EXPECT_EQ(stats.wakeups, 1u);
+    EXPECT_EQ(stats.messages, 6u);
+    EXPECT_EQ(stats.lastBatch, 6u);
+    EXPECT_EQ(stats.maxBatch, 6u);
+}
+
+TEST_F(ReceiveEngineTest, OversizedMessageIsDropped)
+{
+    ReceiveEngine engine(4, 8);
+    sendMsg(16, 0xaa);
+    sendMsg(4, 0xbb);
+
+    std::vector<size_t> lengths;
+    auto rc = engine.drain(fds[0], [&](const RxMessage& msg) {
+        lengths.push_back(msg.length);
+        return true;
+    });
+
+    EXPECT_EQ(rc, 1);
+    EXPECT_EQ(lengths, (std::vector<size_t>{4}));
+    EXPECT_EQ(engine.getStats().truncated, 1u);
+}
+
+TEST_F(ReceiveEngineTest, CallbackStopsTheDrain)
+{
+    ReceiveEngine engine(4, 64);
+    sendMsg(0, 0);
+    sendMsg(4, 0x01);
+
+    size_t calls = 0;
+    auto rc = engine.drain(fds[0], [&](const RxMessage& msg) {
+        calls++;
+        return msg.length != 0;
+    });
+
+    EXPECT_EQ(rc, 1);
+    EXPECT_EQ(calls, 1u);
+}
+
+TEST_F(ReceiveEngineTest, SharedMessageIsNotOverwritten)
+{
+    ReceiveEngine engine(1, 64);
+    sendMsg(4, 0x11);
+
+    std::shared_ptr<const nsm_msg> kept;
+    engine.drain(fds[0], [&](const RxMessage& msg) {
+        kept = msg.share(0);
+        return true;
+    });
+
+    sendMsg(4, 0x22);
+    engine.drain(fds[0], [](const RxMessage& msg) {
+        EXPECT_EQ(msg.data[0], 0x22);
+        return true;
+    });
+
+    ASSERT_NE(kept, nullptr);
+    EXPECT_EQ(reinterpret_cast<const uint8_t*>(kept.get())[0], 0x11);
+    EXPECT_EQ(engine.getBufferStats().inUse, 2u);
+
+    kept.reset();
+    EXPECT_EQ(engine.getBufferStats().inUse, 1u);
+}
+
+TEST_F(ReceiveEngineTest, EmptySocketHandlesNothing)
+{
+    ReceiveEngine engine(4, 64);
+    auto rc = engine.drain(fds[0], [](const RxMessage&) { return true; });
+    EXPECT_EQ(rc, 0);
+    EXPECT_EQ(engine.getStats().messages, 0u);
+}
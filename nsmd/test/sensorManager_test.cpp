@@ -0,0 +1,239 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "libnsm/base.h"
+#include "libnsm/device-capability-discovery.h"
+#include "libnsm/platform-environmental.h"
+
+#include "test/mockSensorManager.hpp"
+
+#include <endian.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace nsm;
+using namespace ::testing;
+
+constexpr eid_t eid = 12;
+
+/** @brief Event handler recording the events it is handed */
+class RecordingEventHandler : public EventHandler
+{
+  public:
+    struct Event
+    {
+        uint8_t eventId;
+        uint8_t eventClass;
+        uint16_t eventState;
+        std::vector<uint8_t> data;
+    };
+
+    explicit RecordingEventHandler(std::vector<Event>& events) : events(events)
+    {}
+
+    void unsupportedEvent(uint8_t, const nsm_msg* event,
+                          size_t eventLen) override
+    {
+        EXPECT_GE(eventLen, sizeof(nsm_msg_hdr) + NSM_EVENT_MIN_LEN);
+        auto payload = reinterpret_cast<const nsm_event*>(event->payload);
+        events.push_back({payload->event_id, payload->event_class,
+                          le16toh(payload->event_state),
+                          std::vector<uint8_t>(payload->data,
+                                               payload->data +
+                                                   payload->data_size)});
+    }
+
+    uint8_t nsmType() override
+    {
+        return NSM_TYPE_PLATFORM_ENVIRONMENTAL;
+    }
+
+  private:
+    std::vector<Event>& events;
+};
+
+class PollEventsTest : public Test, public SensorManagerTest
+{
+  protected:
+    NsmDeviceTable devices{
+        {std::make_shared<NsmDevice>(0, 0)},
+    };
+    std::shared_ptr<NsmDevice> device = devices[0];
+    EventManager eventManager;
+    std::vector<RecordingEventHandler::Event> events;
+    std::vector<uint32_t> selectors;
+
+    PollEventsTest() : SensorManagerTest(devices)
+    {
+        eventManager.registerHandler(
+            NSM_TYPE_PLATFORM_ENVIRONMENTAL,
+            std::make_unique<RecordingEventHandler>(events));
+    }
+
+    /** @brief Response holding an event log record of a platform
+     *         environmental event
+     */
+    static Response record(uint32_t eventHandle, uint8_t eventId,
+                           const std::vector<uint8_t>& data = {})
+    {
+        Response response(sizeof(nsm_msg_hdr) +
+                          sizeof(nsm_get_event_log_record_resp) - 1 +
+                          data.size());
+        auto msg = reinterpret_cast<nsm_msg*>(response.data());
+        nsm_header_info header{NSM_RESPONSE, 0,
+                               NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY};
+        EXPECT_EQ(pack_nsm_header(&header, &msg->hdr), NSM_SUCCESS);
+
+        auto resp =
+            reinterpret_cast<nsm_get_event_log_record_resp*>(msg->payload);
+        resp->hdr.command = NSM_GET_EVENT_LOG_RECORD;
+        resp->hdr.completion_code = NSM_SUCCESS;
+        resp->hdr.data_size = htole16(
+            NSM_GET_EVENT_LOG_RECORD_RESP_MIN_DATA_SIZE + data.size());
+        resp->nvidia_message_type = NSM_TYPE_PLATFORM_ENVIRONMENTAL;
+        resp->event_id = eventId;
+        resp->event_handle = htole32(eventHandle);
+        resp->timestamp = 0;
+        std::memcpy(resp->payload, data.data(), data.size());
+        return response;
+    }
+
+    /** @brief Response of a device whose event log holds no further record
+     */
+    static Response emptyLog()
+    {
+        Response response(sizeof(nsm_msg_hdr) +
+                          sizeof(nsm_common_non_success_resp));
+        EXPECT_EQ(encode_cc_only_resp(0, NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY,
+                                      NSM_GET_EVENT_LOG_RECORD,
+                                      NSM_ERR_INVALID_DATA, 0,
+                                      reinterpret_cast<nsm_msg*>(
+                                          response.data())),
+                  NSM_SUCCESS);
+        return response;
+    }
+
+    /** @brief Answer the requests with the given responses, in order, and
+     *         record the handle each request selects
+     */
+    void respondWith(std::vector<Response> responses)
+    {
+        auto next = std::make_shared<size_t>(0);
+        ON_CALL(mockManager, SendRecvNsmMsg)
+            .WillByDefault([this, responses = std::move(responses), next](
+                               eid_t, Request& request,
+                               std::shared_ptr<const nsm_msg>& responseMsg,
+                               size_t& responseLen) -> requester::Coroutine {
+            selectors.push_back(selector(request));
+            auto response = std::make_shared<Response>(
+                *next < responses.size() ? responses[(*next)++] : emptyLog());
+            responseMsg = std::shared_ptr<const nsm_msg>(
+                response, reinterpret_cast<const nsm_msg*>(response->data()));
+            responseLen = response->size();
+            // coverity[missing_return]
+            co_return NSM_SW_SUCCESS;
+        });
+    }
+
+    static uint32_t selector(const Request& request)
+    {
+        auto msg = reinterpret_cast<const nsm_msg*>(request.data());
+        auto req =
+            reinterpret_cast<const nsm_get_event_log_record_req*>(msg->payload);
+        return le32toh(req->selector);
+    }
+
+    uint8_t pollEvents()
+    {
+        return mockManager.pollEvents(device, eid, eventManager)
+            .await_resume();
+    }
+};
+
+TEST_F(PollEventsTest, EmptyLog)
+{
+    respondWith({});
+
+    EXPECT_EQ(pollEvents(), NSM_SW_SUCCESS);
+    EXPECT_EQ(selectors, std::vector<uint32_t>{0});
+    EXPECT_TRUE(events.empty());
+    EXPECT_EQ(device->nextEventHandle, 0u);
+}
+
+TEST_F(PollEventsTest, RecordsPastTheCapWaitForTheNextCycle)
+{
+    std::vector<Response> responses;
+    for (uint32_t handle = 0; handle < SensorManager::maxEventsPerCycle + 2;
+         ++handle)
+    {
+        responses.push_back(
+            record(handle, NSM_XID_EVENT, {static_cast<uint8_t>(handle)}));
+    }
+    respondWith(std::move(responses));
+
+    EXPECT_EQ(pollEvents(), NSM_SW_SUCCESS);
+    ASSERT_EQ(events.size(), SensorManager::maxEventsPerCycle);
+    EXPECT_EQ(selectors.size(), SensorManager::maxEventsPerCycle);
+    EXPECT_EQ(device->nextEventHandle, SensorManager::maxEventsPerCycle);
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        EXPECT_EQ(selectors[i], i);
+        EXPECT_EQ(events[i].eventId, NSM_XID_EVENT);
+        EXPECT_EQ(events[i].eventClass, NSM_GENERAL_EVENT_CLASS);
+        EXPECT_EQ(events[i].eventState, 0);
+        EXPECT_EQ(events[i].data, std::vector<uint8_t>{uint8_t(i)});
+    }
+
+    // the next cycle picks up where the last one stopped
+    events.clear();
+    selectors.clear();
+    EXPECT_EQ(pollEvents(), NSM_SW_SUCCESS);
+    EXPECT_EQ(events.size(), 2u);
+    EXPECT_EQ(selectors.front(), SensorManager::maxEventsPerCycle);
+    EXPECT_EQ(device->nextEventHandle, SensorManager::maxEventsPerCycle + 2);
+}
+
+TEST_F(PollEventsTest, OversizeEventIsSkipped)
+{
+    respondWith({record(0, NSM_XID_EVENT, std::vector<uint8_t>(256)),
+                 record(1, NSM_RESET_REQUIRED_EVENT)});
+
+    EXPECT_EQ(pollEvents(), NSM_SW_SUCCESS);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].eventId, NSM_RESET_REQUIRED_EVENT);
+    EXPECT_TRUE(events[0].data.empty());
+    EXPECT_EQ(device->nextEventHandle, 2u);
+}
+
+TEST_F(PollEventsTest, DecodeFailureStopsTheCycle)
+{
+    auto truncated = record(0, NSM_XID_EVENT);
+    truncated.resize(truncated.size() - 1);
+    respondWith({truncated, record(0, NSM_XID_EVENT)});
+
+    EXPECT_EQ(pollEvents(), NSM_SW_SUCCESS);
+    EXPECT_EQ(selectors, std::vector<uint32_t>{0});
+    EXPECT_TRUE(events.empty());
+    EXPECT_EQ(device->nextEventHandle, 0u);
+
+    // the record is fetched again in the next cycle
+    EXPECT_EQ(pollEvents(), NSM_SW_SUCCESS);
+    EXPECT_EQ(selectors, (std::vector<uint32_t>{0, 0, 1}));
+    EXPECT_EQ(events.size(), 1u);
+    EXPECT_EQ(device->nextEventHandle, 1u);
+}
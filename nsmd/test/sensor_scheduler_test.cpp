@@ -0,0 +1,224 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nsmObject.hpp"
+#include "sensor_scheduler.hpp"
+
+#include <map>
+
+#include <gtest/gtest.h>
+
+using namespace nsm;
+using Lane = SensorScheduler::Lane;
+
+constexpr uint64_t priorityPeriod = 100'000;
+constexpr uint64_t roundRobinPeriod = 1'000'000;
+
+TEST(SensorSchedulerTest, SensorsArePolledAtTheirPeriod)
+{
+    SensorScheduler scheduler{priorityPeriod, roundRobinPeriod};
+    auto power = std::make_shared<NsmObject>("Power", "NSM_Power");
+    auto clock = std::make_shared<NsmObject>("Clock", "NSM_Clock");
+    auto ecc = std::make_shared<NsmObject>("ECC", "NSM_ECC");
+    clock->setPollingPeriod(500'000);
+    ecc->setPollingPeriod(3'000'000);
+    std::vector<std::shared_ptr<NsmObject>> prioritySensors{power};
+    std::deque<std::shared_ptr<NsmObject>> roundRobinSensors{ecc, clock};
+
+    std::map<const NsmObject*, size_t> polls;
+    for (uint64_t now = 0; now < 6'000'000; now += priorityPeriod)
+    {
+        scheduler.sync(prioritySensors, roundRobinSensors, now);
+        scheduler.release(now);
+        for (auto lane : {Lane::Priority, Lane::RoundRobin})
+        {
+            while (auto index = scheduler.next(lane))
+            {
+                ++polls[scheduler.getSensor(*index).get()];
+                scheduler.complete(*index, now + 1'000);
+            }
+        }
+    }
+
+    EXPECT_EQ(polls[power.get()], 60);
+    EXPECT_EQ(polls[clock.get()], 12);
+    EXPECT_EQ(polls[ecc.get()], 2);
+    EXPECT_EQ(scheduler.getDeadlineMisses(power.get()), 0);
+    EXPECT_EQ(scheduler.getDeadlineMisses(ecc.get()), 0);
+}
+
+TEST(SensorSchedulerTest, EarliestDeadlineIsPolledFirst)
+{
+    SensorScheduler scheduler{priorityPeriod, roundRobinPeriod};
+    auto slow = std::make_shared<NsmObject>("Slow", "NSM_Slow");
+    auto fast = std::make_shared<NsmObject>("Fast", "NSM_Fast");
+    fast->setPollingPeriod(200'000);
+    std::deque<std::shared_ptr<NsmObject>> roundRobinSensors{slow, fast};
+
+    scheduler.sync({}, roundRobinSensors, 0);
+    scheduler.release(0);
+    EXPECT_FALSE(scheduler.hasReleased(Lane::Priority));
+    auto index = scheduler.next(Lane::RoundRobin);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(scheduler.getSensor(*index), fast);
+    scheduler.complete(*index, 10'000);
+
+    // the slow sensor misses its deadline, it is counted once polled
+    index = scheduler.next(Lane::RoundRobin);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(scheduler.getSensor(*index), slow);
+    scheduler.complete(*index, 1'500'000);
+    EXPECT_EQ(scheduler.getDeadlineMisses(slow.get()), 1);
+    EXPECT_EQ(scheduler.getDeadlineMisses(fast.get()), 0);
+    EXPECT_FALSE(scheduler.next(Lane::RoundRobin));
+
+    // a late sensor starts over rather than catching up on missed periods
+    scheduler.release(1'500'000);
+    index = scheduler.next(Lane::RoundRobin);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(scheduler.getSensor(*index), fast);
+    scheduler.complete(*index, 1'500'000);
+    EXPECT_EQ(scheduler.getDeadlineMisses(fast.get()), 1);
+    index = scheduler.next(Lane::RoundRobin);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(scheduler.getSensor(*index), slow);
+    scheduler.complete(*index, 1'600'000);
+    EXPECT_FALSE(scheduler.next(Lane::RoundRobin));
+
+    scheduler.release(1'700'000);
+    index = scheduler.next(Lane::RoundRobin);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(scheduler.getSensor(*index), fast);
+    scheduler.complete(*index, 1'700'000);
+    EXPECT_FALSE(scheduler.next(Lane::RoundRobin));
+    EXPECT_EQ(scheduler.getDeadlineMisses(fast.get()), 1);
+}
+
+TEST(SensorSchedulerTest, ScheduleFollowsTheContainers)
+{
+    SensorScheduler scheduler{priorityPeriod, roundRobinPeriod};
+    auto first = std::make_shared<NsmObject>("First", "NSM_First");
+    auto inventory = std::make_shared<NsmObject>("Inventory", "NSM_Static");
+    std::vector<std::shared_ptr<NsmObject>> prioritySensors;
+    std::deque<std::shared_ptr<NsmObject>> roundRobinSensors{inventory,
+                                                             first};
+
+    scheduler.sync(prioritySensors, roundRobinSensors, 0);
+    scheduler.release(0);
+    while (auto index = scheduler.next(Lane::RoundRobin))
+    {
+        const bool retire = scheduler.getSensor(*index) == inventory;
+        if (retire)
+        {
+            std::erase(roundRobinSensors, inventory);
+        }
+        scheduler.getSensor(*index)->isRefreshed = true;
+        scheduler.complete(*index, 2'000'000, retire);
+        // a retired sensor is dropped at once, without a rebuild
+        EXPECT_EQ(scheduler.size(), roundRobinSensors.size());
+    }
+    EXPECT_EQ(scheduler.getDeadlineMisses(first.get()), 1);
+    EXPECT_TRUE(scheduler.isRefreshed(Lane::RoundRobin));
+
+    // an added sensor is released right away and a sensor moved to the priority lane keeps its deadline misses
+    auto added = std::make_shared<NsmObject>("Added", "NSM_Added");
+    roundRobinSensors = {added};
+    prioritySensors = {first};
+    scheduler.sync(prioritySensors, roundRobinSensors, 2'000'000);
+    EXPECT_EQ(scheduler.size(), 2);
+    EXPECT_FALSE(scheduler.isRefreshed(Lane::RoundRobin));
+    EXPECT_EQ(scheduler.getDeadlineMisses(first.get()), 1);
+    EXPECT_EQ(scheduler.getDeadlineMisses(inventory.get()), 0);
+
+    scheduler.release(2'000'000);
+    auto index = scheduler.next(Lane::Priority);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(scheduler.getSensor(*index), first);
+    index = scheduler.next(Lane::RoundRobin);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(scheduler.getSensor(*index), added);
+}
+
+TEST(SensorSchedulerTest, StableAdaptiveSensorIsPolledLessOften)
+{
+    SensorScheduler scheduler{priorityPeriod, roundRobinPeriod, 8'000'000};
+    auto eccMode = std::make_shared<NsmObject>("EccMode", "NSM_ECC");
+    auto temperature = std::make_shared<NsmObject>("Temp", "NSM_Temp");
+    eccMode->setAdaptivePolling(true);
+    std::deque<std::shared_ptr<NsmObject>> roundRobinSensors{eccMode,
+                                                             temperature};
+
+    std::map<const NsmObject*, std::vector<uint64_t>> polls;
+    auto poll = [&](uint64_t begin, uint64_t end) {
+        for (uint64_t now = begin; now < end; now += priorityPeriod)
+        {
+            scheduler.sync({}, roundRobinSensors, now);
+            scheduler.release(now);
+            while (auto index = scheduler.next(Lane::RoundRobin))
+            {
+                polls[scheduler.getSensor(*index).get()].push_back(now);
+                scheduler.complete(*index, now);
+            }
+        }
+    };
+    poll(0, 26'000'000);
+
+    // the period doubles from the first poll which did not change the value
+    EXPECT_EQ(polls[eccMode.get()],
+              (std::vector<uint64_t>{0, 1'000'000, 3'000'000, 7'000'000,
+                                     15'000'000, 23'000'000}));
+    EXPECT_EQ(scheduler.getCurrentPeriod(eccMode.get()), 8'000'000);
+    EXPECT_EQ(polls[temperature.get()].size(), 26);
+    EXPECT_EQ(scheduler.getCurrentPeriod(temperature.get()), roundRobinPeriod);
+    EXPECT_EQ(scheduler.getDeadlineMisses(eccMode.get()), 0);
+
+    // a set snaps the sensor back, it is polled right away and at the base
+    // period until its value is stable again
+    polls.clear();
+    scheduler.expedite(eccMode.get(), 26'000'000);
+    EXPECT_EQ(scheduler.getCurrentPeriod(eccMode.get()), roundRobinPeriod);
+    poll(26'000'000, 29'600'000);
+    EXPECT_EQ(polls[eccMode.get()],
+              (std::vector<uint64_t>{26'000'000, 27'000'000, 29'000'000}));
+    EXPECT_EQ(scheduler.getCurrentPeriod(eccMode.get()), 4'000'000);
+
+    // a value change seen by the next poll snaps it back as well
+    eccMode->markChanged();
+    poll(29'600'000, 34'100'000);
+    EXPECT_EQ(polls[eccMode.get()],
+              (std::vector<uint64_t>{26'000'000, 27'000'000, 29'000'000,
+                                     33'000'000, 34'000'000}));
+    EXPECT_EQ(scheduler.getCurrentPeriod(eccMode.get()), 2'000'000);
+    EXPECT_EQ(scheduler.getDeadlineMisses(eccMode.get()), 0);
+}
+
+TEST(SensorSchedulerTest, AdaptivePeriod)
+{
+    NsmObject sensor("ClockLimit", "NSM_Clock");
+    // not adaptive
+    EXPECT_EQ(SensorScheduler::adaptPeriod(sensor, 4, 1, 8), 1);
+
+    sensor.setAdaptivePolling(true);
+    // the initial poll counts as a change
+    EXPECT_EQ(SensorScheduler::adaptPeriod(sensor, 1, 1, 8), 1);
+    EXPECT_EQ(SensorScheduler::adaptPeriod(sensor, 1, 1, 8), 2);
+    EXPECT_EQ(SensorScheduler::adaptPeriod(sensor, 6, 1, 8), 8);
+    // disabled
+    EXPECT_EQ(SensorScheduler::adaptPeriod(sensor, 4, 1, 0), 1);
+    sensor.markChanged();
+    EXPECT_EQ(SensorScheduler::adaptPeriod(sensor, 8, 1, 8), 1);
+}
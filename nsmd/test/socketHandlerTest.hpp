@@ -0,0 +1,61 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "eventManager.hpp"
+#include "instance_id.hpp"
+#include "requester/handler.hpp"
+#include "requester/request.hpp"
+#include "socket_manager.hpp"
+
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+/** @brief Fixture of the mctp_socket::Handler tests, holding the event loop
+ *         and the requester handler the socket handler under test serves
+ */
+class SocketHandlerTest : public testing::Test
+{
+  protected:
+    SocketHandlerTest() :
+        event(sdeventplus::Event::get_default()),
+        handler(event, instanceIdDb, sockManager, false)
+    {}
+
+    /** @brief Run the event loop until the predicate holds, for at most a
+     *         second
+     */
+    template <typename Predicate>
+    bool runUntil(Predicate&& done)
+    {
+        for (int i = 0; i < 100 && !done(); i++)
+        {
+            event.run(std::chrono::milliseconds(10));
+        }
+        return done();
+    }
+
+    sdeventplus::Event event;
+    nsm::InstanceIdDb instanceIdDb;
+    mctp_socket::Manager sockManager;
+    nsm::EventManager eventManager;
+    requester::Handler<requester::Request> handler;
+};
@@ -0,0 +1,99 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "spsc_ring.hpp"
+
+#include <memory>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace mctp_socket;
+
+TEST(SpscRingTest, KeepsOrderUntilFull)
+{
+    SpscRing<int> ring(3);
+    EXPECT_EQ(ring.capacity(), 4);
+    EXPECT_EQ(ring.available(), 4);
+
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(ring.push(int(i)));
+    }
+    EXPECT_FALSE(ring.push(4));
+    EXPECT_EQ(ring.available(), 0);
+
+    int value;
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(ring.pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(ring.pop(value));
+    EXPECT_EQ(ring.available(), 4);
+}
+
+TEST(SpscRingTest, PopLeavesSlotMovedFrom)
+{
+    SpscRing<std::shared_ptr<int>> ring(2);
+    auto value = std::make_shared<int>(7);
+    std::weak_ptr<int> weak = value;
+
+    EXPECT_TRUE(ring.push(std::move(value)));
+    std::shared_ptr<int> popped;
+    ASSERT_TRUE(ring.pop(popped));
+    popped.reset();
+
+    // the ring holds no other reference
+    EXPECT_TRUE(weak.expired());
+}
+
+TEST(SpscRingTest, TransfersBetweenThreads)
+{
+    constexpr size_t count = 100000;
+    SpscRing<size_t> ring(64);
+
+    std::thread producer([&ring] {
+        for (size_t i = 0; i < count;)
+        {
+            if (ring.push(size_t(i)))
+            {
+                i++;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    size_t expected = 0;
+    size_t value;
+    while (expected < count)
+    {
+        if (ring.pop(value))
+        {
+            ASSERT_EQ(value, expected);
+            expected++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+}
@@ -0,0 +1,174 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "libnsm/base.h"
+
+#include "test/socketHandlerTest.hpp"
+#include "threaded_socket_handler.hpp"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <vector>
+
+using namespace mctp_socket;
+
+class ThreadedHandlerTest : public SocketHandlerTest
+{
+  protected:
+    static constexpr eid_t eid = 12;
+
+    void SetUp() override
+    {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds), 0);
+        sockHandler = std::make_unique<ThreadedHandler>(
+            event, handler, eventManager, sockManager, false, Framing::Demux,
+            8);
+        ASSERT_EQ(sockHandler->attachSocket(fds[0]), 0);
+        sockManager.registerEndpoint(eid, fds[0], 4096);
+        handler.setSocketHandler(sockHandler.get());
+    }
+
+    void TearDown() override
+    {
+        sockHandler.reset();
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    /** @brief Receive a message on the device side of the socket pair */
+    ssize_t receive(std::vector<uint8_t>& msg)
+    {
+        pollfd pfd{fds[1], POLLIN, 0};
+        if (poll(&pfd, 1, 1000) != 1)
+        {
+            return -1;
+        }
+        msg.resize(MCTP_RX_BUFFER_SIZE);
+        auto len = recv(fds[1], msg.data(), msg.size(), 0);
+        msg.resize(std::max<ssize_t>(len, 0));
+        return len;
+    }
+
+    std::unique_ptr<ThreadedHandler> sockHandler;
+    int fds[2];
+};
+
+TEST_F(ThreadedHandlerTest, ResponseCompletesRequest)
+{
+    std::vector<uint8_t> request(sizeof(nsm_msg_hdr) + sizeof(nsm_common_req));
+    encode_ping_req(0, reinterpret_cast<nsm_msg*>(request.data()));
+
+    bool completed = false;
+    ASSERT_EQ(handler.registerRequest(
+                  MCTP_MSG_TAG_REQ, eid, NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY,
+                  NSM_PING, std::move(request),
+                  [&](eid_t, std::shared_ptr<const nsm_msg> response, size_t) {
+        completed = response != nullptr;
+    }),
+              NSM_SUCCESS);
+    sockHandler->flush();
+
+    std::vector<uint8_t> msg;
+    ASSERT_GT(receive(msg), MCTP_DEMUX_PREFIX);
+    EXPECT_EQ(msg[1], eid);
+    auto instanceId =
+        reinterpret_cast<const nsm_msg_hdr*>(&msg[MCTP_DEMUX_PREFIX])
+            ->instance_id;
+
+    std::vector<uint8_t> response(MCTP_DEMUX_PREFIX + sizeof(nsm_msg_hdr) +
+                                  sizeof(nsm_common_resp));
+    response[0] = msg[0];
+    response[1] = eid;
+    response[2] = MCTP_MSG_TYPE_PCI_VDM;
+    encode_ping_resp(instanceId, ERR_NULL,
+                     reinterpret_cast<nsm_msg*>(&response[MCTP_DEMUX_PREFIX]));
+    ASSERT_EQ(send(fds[1], response.data(), response.size(), 0),
+              static_cast<ssize_t>(response.size()));
+
+    EXPECT_TRUE(runUntil([&] { return completed; }));
+    EXPECT_EQ(sockHandler->getIoThreadStats().sends, 1);
+    EXPECT_EQ(sockHandler->getReceiveStats().messages, 1);
+}
+
+TEST_F(ThreadedHandlerTest, FailedSendFailsRequest)
+{
+    // an endpoint on a socket whose peer is gone, so the I/O thread fails
+    // to send to it
+    constexpr eid_t deadEid = eid + 1;
+    int dead[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, dead), 0);
+    close(dead[1]);
+    sockManager.registerEndpoint(deadEid, dead[0], 4096);
+
+    std::vector<uint8_t> request(sizeof(nsm_msg_hdr) + sizeof(nsm_common_req));
+    encode_ping_req(0, reinterpret_cast<nsm_msg*>(request.data()));
+
+    bool completed = false;
+    bool responded = false;
+    ASSERT_EQ(handler.registerRequest(
+                  MCTP_MSG_TAG_REQ, deadEid,
+                  NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY, NSM_PING,
+                  std::move(request),
+                  [&](eid_t, std::shared_ptr<const nsm_msg> response, size_t) {
+        completed = true;
+        responded = response != nullptr;
+    }),
+              NSM_SUCCESS);
+    sockHandler->flush();
+
+    EXPECT_TRUE(runUntil([&] { return completed; }));
+    EXPECT_FALSE(responded);
+    EXPECT_EQ(sockHandler->getIoThreadStats().sendErrors, 1);
+    EXPECT_EQ(handler.getNumOutstandingRequests(deadEid), 0u);
+
+    sockHandler.reset();
+    close(dead[0]);
+}
+
+TEST_F(ThreadedHandlerTest, ReceivesWhileEventLoopFallsBehind)
+{
+    // More messages than the rx ring holds, the I/O thread waits for the
+    // event loop to catch up instead of dropping them
+    constexpr size_t count = 40;
+    std::vector<uint8_t> msg(MCTP_DEMUX_PREFIX + sizeof(nsm_msg_hdr), 0);
+    for (size_t i = 0; i < count; i++)
+    {
+        ASSERT_EQ(send(fds[1], msg.data(), msg.size(), 0),
+                  static_cast<ssize_t>(msg.size()));
+    }
+
+    EXPECT_TRUE(runUntil(
+        [&] { return sockHandler->getReceiveStats().messages == count; }));
+    EXPECT_GT(sockHandler->getIoThreadStats().stalls, 0);
+    EXPECT_EQ(sockHandler->getReceiveStats().truncated, 0);
+}
+
+TEST_F(ThreadedHandlerTest, StopsWithQueuedMessages)
+{
+    std::vector<uint8_t> msg(MCTP_DEMUX_PREFIX + sizeof(nsm_msg_hdr), 0);
+    for (size_t i = 0; i < 20; i++)
+    {
+        ASSERT_EQ(send(fds[1], msg.data(), msg.size(), 0),
+                  static_cast<ssize_t>(msg.size()));
+    }
+    // Destroying the handler joins the thread and frees the buffers still
+    // in the rings on the event loop
+    sockHandler.reset();
+}
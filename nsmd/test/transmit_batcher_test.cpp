@@ -0,0 +1,172 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "transmit_batcher.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <sdeventplus/event.hpp>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace mctp_socket;
+
+class TransmitBatcherTest : public testing::Test
+{
+  protected:
+    TransmitBatcherTest() : event(sdeventplus::Event::get_default()) {}
+
+    void SetUp() override
+    {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds), 0);
+    }
+
+    void TearDown() override
+    {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    void queue(TransmitBatcher& batcher, size_t len, uint8_t fill)
+    {
+        uint8_t prefix[] = {fill};
+        std::vector<uint8_t> payload(len - 1, fill);
+        ASSERT_EQ(batcher.queue(fds[0], nullptr, prefix, payload), 0);
+    }
+
+    /** @brief Receive on the peer, -1 if there is nothing to receive */
+    ssize_t receive(std::vector<uint8_t>& msg)
+    {
+        msg.resize(1024);
+        auto len = recv(fds[1], msg.data(), msg.size(), 0);
+        msg.resize(std::max<ssize_t>(len, 0));
+        return len;
+    }
+
+    sdeventplus::Event event;
+    int fds[2];
+};
+
+TEST_F(TransmitBatcherTest, SendsQueuedMessagesInOneCall)
+{
+    TransmitBatcher batcher(event, 8, 64);
+    for (uint8_t i = 1; i <= 5; i++)
+    {
+        queue(batcher, i + 1, i);
+    }
+
+    std::vector<uint8_t> msg;
+    EXPECT_EQ(receive(msg), -1);
+    EXPECT_EQ(batcher.size(), 5);
+
+    batcher.flush();
+    EXPECT_EQ(batcher.size(), 0);
+    for (uint8_t i = 1; i <= 5; i++)
+    {
+        ASSERT_EQ(receive(msg), i + 1);
+        EXPECT_EQ(msg, std::vector<uint8_t>(i + 1, i));
+    }
+
+    const auto& stats = batcher.getStats();
+    EXPECT_EQ(stats.flushes, 1);
+    EXPECT_EQ(stats.syscalls, 1);
+    EXPECT_EQ(stats.messages, 5);
+    EXPECT_EQ(stats.maxBatch, 5);
+    EXPECT_EQ(stats.batchHistogram[5], 1);
+}
+
+TEST_F(TransmitBatcherTest, SplitsBatchesAndKeepsOrder)
+{
+    TransmitBatcher batcher(event, 2, 64);
+    for (uint8_t i = 1; i <= 5; i++)
+    {
+        queue(batcher, 4, i);
+    }
+    // larger than a buffer, sent at once after the queued messages
+    queue(batcher, 100, 6);
+
+    std::vector<uint8_t> msg;
+    for (uint8_t i = 1; i <= 6; i++)
+    {
+        ASSERT_GT(receive(msg), 0);
+        EXPECT_EQ(msg[0], i);
+    }
+
+    const auto& stats = batcher.getStats();
+    EXPECT_EQ(stats.syscalls, 4);
+    EXPECT_EQ(stats.messages, 6);
+    EXPECT_EQ(stats.batchHistogram[2], 2);
+    EXPECT_EQ(stats.batchHistogram[1], 2);
+}
+
+TEST_F(TransmitBatcherTest, BatchSizeOneSendsAtOnce)
+{
+    TransmitBatcher batcher(event, 1, 64);
+    queue(batcher, 4, 1);
+
+    std::vector<uint8_t> msg;
+    EXPECT_EQ(receive(msg), 4);
+    EXPECT_EQ(batcher.size(), 0);
+}
+
+TEST_F(TransmitBatcherTest, CountsFailedSends)
+{
+    TransmitBatcher batcher(event, 8, 64);
+    uint8_t prefix[] = {1};
+    ASSERT_EQ(batcher.queue(-1, nullptr, prefix, {}), 0);
+    queue(batcher, 4, 2);
+
+    batcher.flush();
+
+    std::vector<uint8_t> msg;
+    EXPECT_EQ(receive(msg), 4);
+    EXPECT_EQ(batcher.getStats().errors, 1);
+    EXPECT_EQ(batcher.getStats().messages, 1);
+}
+
+TEST_F(TransmitBatcherTest, ReportsFailedQueuedMessages)
+{
+    TransmitBatcher batcher(event, 8, 64);
+    std::vector<std::pair<uint32_t, int>> failures;
+    batcher.setFailureHandler([&](uint32_t context, int rc) {
+        failures.emplace_back(context, rc);
+        // the handler may queue messages again
+        queue(batcher, 4, 3);
+    });
+
+    uint8_t prefix[] = {1};
+    ASSERT_EQ(batcher.queue(-1, nullptr, prefix, {}, 0x0912), 0);
+    ASSERT_EQ(batcher.queue(-1, nullptr, prefix, {}), 0);
+    queue(batcher, 4, 2);
+
+    batcher.flush();
+
+    // only the failed message queued with a context is reported
+    ASSERT_EQ(failures.size(), 1);
+    EXPECT_EQ(failures[0], std::make_pair(uint32_t(0x0912), -EBADF));
+    EXPECT_EQ(batcher.getStats().errors, 2);
+
+    std::vector<uint8_t> msg;
+    EXPECT_EQ(receive(msg), 4);
+    EXPECT_EQ(batcher.size(), 1);
+    batcher.flush();
+    EXPECT_EQ(receive(msg), 4);
+    EXPECT_EQ(msg[0], 3);
+}
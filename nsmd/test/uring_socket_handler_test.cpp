@@ -0,0 +1,211 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "libnsm/base.h"
+
+#include "test/socketHandlerTest.hpp"
+#include "uring_socket_handler.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+using namespace mctp_socket;
+
+class IoUringHandlerTest : public SocketHandlerTest
+{
+  protected:
+    static constexpr eid_t eid = 12;
+
+    void SetUp() override
+    {
+        try
+        {
+            sockHandler = std::make_unique<IoUringHandler>(
+                event, handler, eventManager, sockManager, false,
+                Framing::Demux, 8);
+        }
+        catch (const std::system_error& e)
+        {
+            // io_uring is disabled in some kernels and containers
+            GTEST_SKIP() << "io_uring is not available: " << e.what();
+        }
+
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds), 0);
+        ASSERT_EQ(sockHandler->attachSocket(fds[0]), 0);
+        sockManager.registerEndpoint(eid, fds[0], 4096);
+        handler.setSocketHandler(sockHandler.get());
+    }
+
+    void TearDown() override
+    {
+        for (auto fd : fds)
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+    }
+
+    /** @brief Receive a message on the device side of the socket pair */
+    ssize_t receive(std::vector<uint8_t>& msg)
+    {
+        msg.resize(MCTP_RX_BUFFER_SIZE);
+        auto len = recv(fds[1], msg.data(), msg.size(), 0);
+        msg.resize(std::max<ssize_t>(len, 0));
+        return len;
+    }
+
+    std::unique_ptr<IoUringHandler> sockHandler;
+    int fds[2] = {-1, -1};
+};
+
+TEST_F(IoUringHandlerTest, SendsAreSubmittedTogether)
+{
+    // one shared request sent with three instance IDs, as from a template
+    std::vector<uint8_t> request(sizeof(nsm_msg_hdr) + sizeof(nsm_common_req));
+    encode_ping_req(0, reinterpret_cast<nsm_msg*>(request.data()));
+    const auto encoded = request;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(sockHandler->sendMsg(MCTP_MSG_TAG_REQ, eid, fds[0],
+                                      request.data(), request.size(), i),
+                  NSM_SW_SUCCESS);
+    }
+
+    std::vector<uint8_t> msg;
+    EXPECT_EQ(receive(msg), -1);
+
+    EXPECT_EQ(sockHandler->flush(), 3);
+    EXPECT_EQ(sockHandler->getIoUringStats().sends, 3);
+    EXPECT_EQ(sockHandler->getIoUringStats().sendFallbacks, 0);
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(receive(msg),
+                  static_cast<ssize_t>(MCTP_DEMUX_PREFIX + request.size()));
+        EXPECT_EQ(msg[0], MCTP_MSG_TAG_REQ);
+        EXPECT_EQ(msg[1], eid);
+        EXPECT_EQ(msg[2], MCTP_MSG_TYPE_PCI_VDM);
+        auto hdr = reinterpret_cast<const nsm_msg_hdr*>(&msg[MCTP_DEMUX_PREFIX]);
+        EXPECT_EQ(hdr->instance_id, i);
+        EXPECT_EQ(hdr->request, 1);
+        EXPECT_TRUE(std::equal(msg.begin() + MCTP_DEMUX_PREFIX +
+                                   sizeof(nsm_msg_hdr),
+                               msg.end(),
+                               encoded.begin() + sizeof(nsm_msg_hdr)));
+    }
+    EXPECT_EQ(request, encoded);
+}
+
+TEST_F(IoUringHandlerTest, ResponseCompletesRequest)
+{
+    std::vector<uint8_t> request(sizeof(nsm_msg_hdr) + sizeof(nsm_common_req));
+    encode_ping_req(0, reinterpret_cast<nsm_msg*>(request.data()));
+
+    bool completed = false;
+    ASSERT_EQ(handler.registerRequest(
+                  MCTP_MSG_TAG_REQ, eid, NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY,
+                  NSM_PING, std::move(request),
+                  [&](eid_t, std::shared_ptr<const nsm_msg> response, size_t) {
+        completed = response != nullptr;
+    }),
+              NSM_SUCCESS);
+    sockHandler->flush();
+
+    std::vector<uint8_t> msg;
+    ASSERT_GT(receive(msg), MCTP_DEMUX_PREFIX);
+    auto instanceId =
+        reinterpret_cast<const nsm_msg_hdr*>(&msg[MCTP_DEMUX_PREFIX])
+            ->instance_id;
+
+    std::vector<uint8_t> response(MCTP_DEMUX_PREFIX + sizeof(nsm_msg_hdr) +
+                                  sizeof(nsm_common_resp));
+    response[0] = msg[0];
+    response[1] = eid;
+    response[2] = MCTP_MSG_TYPE_PCI_VDM;
+    encode_ping_resp(instanceId, ERR_NULL,
+                     reinterpret_cast<nsm_msg*>(&response[MCTP_DEMUX_PREFIX]));
+    ASSERT_EQ(send(fds[1], response.data(), response.size(), 0),
+              static_cast<ssize_t>(response.size()));
+
+    EXPECT_TRUE(runUntil([&] { return completed; }));
+    EXPECT_EQ(sockHandler->getReceiveStats().messages, 1);
+}
+
+TEST_F(IoUringHandlerTest, FailedSendFailsRequest)
+{
+    // the device side is gone, the queued send completes with an error
+    close(fds[1]);
+    fds[1] = -1;
+
+    std::vector<uint8_t> request(sizeof(nsm_msg_hdr) + sizeof(nsm_common_req));
+    encode_ping_req(0, reinterpret_cast<nsm_msg*>(request.data()));
+
+    bool completed = false;
+    bool responded = false;
+    ASSERT_EQ(handler.registerRequest(
+                  MCTP_MSG_TAG_REQ, eid, NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY,
+                  NSM_PING, std::move(request),
+                  [&](eid_t, std::shared_ptr<const nsm_msg> response, size_t) {
+        completed = true;
+        responded = response != nullptr;
+    }),
+              NSM_SUCCESS);
+    sockHandler->flush();
+
+    EXPECT_TRUE(runUntil([&] { return completed; }));
+    EXPECT_FALSE(responded);
+    EXPECT_EQ(sockHandler->getIoUringStats().sendErrors, 1);
+    EXPECT_EQ(handler.getNumOutstandingRequests(eid), 0u);
+}
+
+TEST_F(IoUringHandlerTest, OversizedMessageIsDropped)
+{
+    std::vector<uint8_t> large(MCTP_RX_BUFFER_SIZE + 2 * MCTP_DEMUX_PREFIX,
+                               0);
+    ASSERT_EQ(send(fds[1], large.data(), large.size(), 0),
+              static_cast<ssize_t>(large.size()));
+
+    // Not a VDM message, dropped after it is received
+    std::vector<uint8_t> small(MCTP_DEMUX_PREFIX + sizeof(nsm_msg_hdr), 0);
+    ASSERT_EQ(send(fds[1], small.data(), small.size(), 0),
+              static_cast<ssize_t>(small.size()));
+
+    EXPECT_TRUE(runUntil(
+        [&] { return sockHandler->getReceiveStats().messages == 1; }));
+    EXPECT_EQ(sockHandler->getReceiveStats().truncated, 1);
+}
+
+TEST_F(IoUringHandlerTest, KeepsReceivingWhenBuffersRunOut)
+{
+    // More messages than the ring has provided buffers
+    std::vector<uint8_t> msg(MCTP_DEMUX_PREFIX + sizeof(nsm_msg_hdr), 0);
+    for (size_t i = 0; i < 20; i++)
+    {
+        ASSERT_EQ(send(fds[1], msg.data(), msg.size(), 0),
+                  static_cast<ssize_t>(msg.size()));
+    }
+
+    EXPECT_TRUE(runUntil(
+        [&] { return sockHandler->getReceiveStats().messages == 20; }));
+}
@@ -0,0 +1,571 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "threaded_socket_handler.hpp"
+
+#include "libnsm/base.h"
+
+#include "common/globals.hpp"
+#include "common/utils.hpp"
+#include "requester/handler.hpp"
+
+#include <poll.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <system_error>
+
+namespace mctp_socket
+{
+
+ThreadedHandler::ThreadedHandler(
+    sdeventplus::Event& event, requester::Handler<requester::Request>& handler,
+    nsm::EventManager& eventManager, Manager& manager, bool verbose,
+    Framing framing, size_t ringSize) :
+    Handler(event, handler, eventManager, manager, verbose),
+    framing(framing),
+    pool(MCTP_RX_BUFFER_SIZE + MCTP_DEMUX_PREFIX,
+         MCTP_RX_BUFFER_POOL_SIZE + ringSize),
+    bufferTarget(2 * MCTP_RX_BATCH_SIZE), txRing(ringSize), rxRing(ringSize),
+    freeRing(2 * MCTP_RX_BATCH_SIZE), failureRing(ringSize),
+    iovs(MCTP_RX_BATCH_SIZE),
+    addrs(MCTP_RX_BATCH_SIZE), headers(MCTP_RX_BATCH_SIZE)
+{
+    txEventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    rxEventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+
+    epoll_event watch{};
+    watch.events = EPOLLIN;
+    watch.data.fd = txEventFd;
+    if (txEventFd < 0 || rxEventFd < 0 || epollFd < 0 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, txEventFd, &watch) < 0)
+    {
+        int error = errno;
+        for (auto fd : {txEventFd, rxEventFd, epollFd})
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+        throw std::system_error(error, std::generic_category(),
+                                "MCTP I/O thread setup");
+    }
+
+    stats.batchHistogram.resize(MCTP_RX_BATCH_SIZE + 1);
+    refillFreeBuffers();
+
+    rxIo = std::make_unique<IO>(
+        event, rxEventFd, EPOLLIN,
+        std::bind_front(&ThreadedHandler::handleReceivedMsg, this));
+    rxIo->set_priority(SD_EVENT_SOURCE_MAX_PRIORITY);
+
+    wakeSource = std::make_unique<sdeventplus::source::Defer>(
+        event, [this](sdeventplus::source::EventBase& source) {
+        source.set_enabled(sdeventplus::source::Enabled::Off);
+        flush();
+    });
+    wakeSource->set_enabled(sdeventplus::source::Enabled::Off);
+
+    ioThread = std::thread(&ThreadedHandler::run, this);
+    pthread_setname_np(ioThread.native_handle(), "nsmd-io");
+}
+
+ThreadedHandler::~ThreadedHandler()
+{
+    stopping = true;
+    flush();
+    ioThread.join();
+
+    wakeSource.reset();
+    rxIo.reset();
+    close(epollFd);
+    close(rxEventFd);
+    close(txEventFd);
+}
+
+int ThreadedHandler::registerMctpEndpoint(eid_t eid, int type, int protocol,
+                                          const std::vector<uint8_t>& pathName)
+{
+    if (framing == Framing::InKernel)
+    {
+        if (inKernelFd < 0)
+        {
+            int fd = openInKernelSocket(inKernelSendBufferSize);
+            if (fd < 0)
+            {
+                lg2::error("Failed to open the MCTP socket, EID={ED}", "ED",
+                           eid);
+                return fd;
+            }
+            ownedFds.push_back(std::make_unique<utils::CustomFD>(fd));
+            attachSocket(fd);
+            inKernelFd = fd;
+        }
+        manager.registerEndpoint(eid, inKernelFd, inKernelSendBufferSize);
+        return NSM_SUCCESS;
+    }
+
+    auto entry = demuxSockets.find(pathName);
+    if (entry == demuxSockets.end())
+    {
+        int sendBufferSize = 0;
+        int fd = openDemuxSocket(type, protocol, pathName, sendBufferSize);
+        if (fd < 0)
+        {
+            return fd;
+        }
+        ownedFds.push_back(std::make_unique<utils::CustomFD>(fd));
+        attachSocket(fd);
+        entry = demuxSockets.emplace(pathName, std::pair(fd, sendBufferSize))
+                    .first;
+    }
+    manager.registerEndpoint(eid, entry->second.first, entry->second.second);
+
+    return NSM_SUCCESS;
+}
+
+int ThreadedHandler::attachSocket(int fd)
+{
+    // A descriptor without buffer asks the I/O thread to watch the socket.
+    TxDescriptor watch;
+    watch.fd = fd;
+    while (!txRing.push(std::move(watch)))
+    {
+        flush();
+        std::this_thread::yield();
+    }
+    flush();
+    return 0;
+}
+
+void ThreadedHandler::flush() const
+{
+    eventfd_write(txEventFd, 1);
+}
+
+int ThreadedHandler::sendMsg(uint8_t tag, eid_t eid, int mctpFd,
+                             const uint8_t* nsmMsg, size_t nsmMsgLen,
+                             std::optional<uint8_t> instanceId) const
+{
+    if (framing == Framing::InKernel)
+    {
+        auto addr = mctpAddress(eid, MCTP_TAG_OWNER);
+        TxMessage tx({}, {nsmMsg, nsmMsgLen}, instanceId);
+
+        if (verbose)
+        {
+            utils::printBuffer(utils::Tx, tx.nsmMsg(), addr.smctp_tag, eid);
+        }
+        return queueSend(mctpFd, &addr, tx.head(), tx.body(),
+                         requestContext(eid, instanceId));
+    }
+
+    uint8_t hdr[MCTP_DEMUX_PREFIX] = {
+        tag, eid, MCTP_MSG_TYPE_PCI_VDM}; // TO_TAG, EID, MCTP_MSG_TYPE
+    TxMessage tx(hdr, {nsmMsg, nsmMsgLen}, instanceId);
+
+    if (verbose)
+    {
+        utils::printBuffer(utils::Tx, tx.nsmMsg(), tag, eid);
+    }
+    return queueSend(mctpFd, nullptr, tx.head(), tx.body(),
+                     requestContext(eid, instanceId));
+}
+
+int ThreadedHandler::queueSend(int fd, const sockaddr_mctp* addr,
+                               std::span<const uint8_t> prefix,
+                               std::span<const uint8_t> payload,
+                               std::optional<uint32_t> context) const
+{
+    size_t length = prefix.size() + payload.size();
+
+    TxDescriptor tx;
+    tx.fd = fd;
+    tx.context = context;
+    if (addr)
+    {
+        tx.hasAddr = true;
+        tx.addr = *addr;
+    }
+    // The I/O thread keeps a sent pooled buffer to receive into, bound the
+    // number it may hold when sends outpace the responses.
+    tx.pooled = length <= pool.getBufferSize() &&
+                lentBuffers < 2 * bufferTarget;
+    tx.buffer = tx.pooled
+                    ? pool.acquire()
+                    : std::make_shared_for_overwrite<uint8_t[]>(length);
+    tx.length = length;
+    std::copy(prefix.begin(), prefix.end(), tx.buffer.get());
+    std::copy(payload.begin(), payload.end(), tx.buffer.get() + prefix.size());
+
+    bool pooled = tx.pooled;
+    if (txRing.push(std::move(tx)))
+    {
+        if (pooled)
+        {
+            lentBuffers++;
+        }
+        wakeSource->set_enabled(sdeventplus::source::Enabled::OneShot);
+        return NSM_SW_SUCCESS;
+    }
+
+    // The I/O thread is behind, send from the event loop rather than wait
+    threadStats.sendFallbacks++;
+    struct iovec iov
+    {
+        tx.buffer.get(), tx.length
+    };
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (addr)
+    {
+        msg.msg_name = &tx.addr;
+        msg.msg_namelen = sizeof(tx.addr);
+    }
+    if (sendmsg(fd, &msg, 0) == -1)
+    {
+        int error = -errno;
+        lg2::error("Error while sending the message. RC={RC}", "RC",
+                   strerror(-error));
+        return NSM_SW_ERROR;
+    }
+    return NSM_SW_SUCCESS;
+}
+
+void ThreadedHandler::refillFreeBuffers()
+{
+    while (lentBuffers < bufferTarget)
+    {
+        auto buffer = pool.acquire();
+        if (!freeRing.push(std::move(buffer)))
+        {
+            break;
+        }
+        lentBuffers++;
+    }
+}
+
+void ThreadedHandler::handleReceivedMsg([[maybe_unused]] IO& io,
+                                        [[maybe_unused]] int fd,
+                                        [[maybe_unused]] uint32_t revents)
+{
+    eventfd_t value;
+    eventfd_read(rxEventFd, &value);
+
+    SendFailure failure;
+    while (failureRing.pop(failure))
+    {
+        handleSendFailure(failure.context, failure.rc);
+    }
+
+    size_t handled = 0;
+    RxDescriptor rx;
+    while (rxRing.pop(rx))
+    {
+        lentBuffers--;
+        ++handled;
+
+        sockaddr_storage addr{};
+        memcpy(&addr, &rx.addr, std::min<size_t>(rx.addrLen, sizeof(rx.addr)));
+        RxMessage rxMsg{rx.buffer.get(), rx.length, addr, rx.addrLen,
+                        rx.buffer};
+
+        bool running;
+        if (framing == Framing::InKernel)
+        {
+            running = handleInKernelMsg(
+                rxMsg,
+                [this, fd = rx.fd](const sockaddr_mctp& destAddr,
+                                   const Response& response) {
+                queueSend(fd, &destAddr, {}, response);
+            },
+                rx.received);
+        }
+        else
+        {
+            running = handleDemuxMsg(
+                rxMsg,
+                [this, fd = rx.fd](std::span<const uint8_t> prefix,
+                                   const Response& response) {
+                queueSend(fd, nullptr, prefix, response);
+            },
+                rx.received);
+        }
+        if (!running)
+        {
+            return;
+        }
+    }
+
+    refillFreeBuffers();
+    if (stalled.exchange(false))
+    {
+        flush();
+    }
+
+    record(handled);
+    if (verbose)
+    {
+        lg2::info("Handled {COUNT} MCTP messages in one wakeup", "COUNT",
+                  handled);
+    }
+}
+
+void ThreadedHandler::logStats() const
+{
+    Handler::logStats();
+    lg2::error("logStats: IO THREAD SENDS={SENDS}, ERRORS={ERRORS}, "
+               "FALLBACKS={FALLBACKS}, STALLS={STALLS}",
+               "SENDS", threadStats.sends.load(), "ERRORS",
+               threadStats.sendErrors.load(), "FALLBACKS",
+               threadStats.sendFallbacks, "STALLS", threadStats.stalls.load());
+}
+
+void ThreadedHandler::record(size_t handled)
+{
+    stats.wakeups++;
+    stats.messages += handled;
+    stats.truncated = threadStats.truncated;
+    stats.lastBatch = handled;
+    stats.maxBatch = std::max(stats.maxBatch, handled);
+    stats.batchHistogram[std::min(handled,
+                                  stats.batchHistogram.size() - 1)]++;
+}
+
+void ThreadedHandler::run()
+{
+    std::array<epoll_event, 16> events;
+
+    while (!stopping)
+    {
+        int count = epoll_wait(epollFd, events.data(), events.size(), -1);
+        if (count < 0)
+        {
+            if (errno != EINTR)
+            {
+                lg2::error("epoll_wait failed in the MCTP I/O thread, RC={RC}",
+                           "RC", strerror(errno));
+            }
+            continue;
+        }
+
+        bool drained = true;
+        for (int i = 0; i < count; ++i)
+        {
+            int fd = events[i].data.fd;
+            if (fd == txEventFd)
+            {
+                eventfd_t value;
+                eventfd_read(txEventFd, &value);
+                if (!handleTx())
+                {
+                    return;
+                }
+            }
+            else if (drained)
+            {
+                drained = receive(fd);
+            }
+        }
+
+        if (!drained)
+        {
+            // Wait for the event loop to drain the rx ring or to return
+            // buffers. The flag is checked by the event loop after it drained
+            // the ring, a ring drained in between is seen here.
+            threadStats.stalls++;
+            stalled = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (rxRing.available() == 0 || takeFreeBuffers() == 0)
+            {
+                pollfd wake{txEventFd, POLLIN, 0};
+                poll(&wake, 1, -1);
+            }
+            stalled = false;
+        }
+    }
+}
+
+bool ThreadedHandler::handleTx()
+{
+    TxDescriptor tx;
+    while (txRing.pop(tx))
+    {
+        if (!tx.buffer)
+        {
+            epoll_event watch{};
+            watch.events = EPOLLIN;
+            watch.data.fd = tx.fd;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, tx.fd, &watch) < 0)
+            {
+                lg2::error("Failed to watch the MCTP socket, RC={RC}", "RC",
+                           strerror(errno));
+            }
+            continue;
+        }
+
+        struct iovec iov
+        {
+            tx.buffer.get(), tx.length
+        };
+        struct msghdr msg = {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        if (tx.hasAddr)
+        {
+            msg.msg_name = &tx.addr;
+            msg.msg_namelen = sizeof(tx.addr);
+        }
+        if (sendmsg(tx.fd, &msg, 0) == -1)
+        {
+            int error = -errno;
+            threadStats.sendErrors++;
+            // The event loop fails the request at once, it would otherwise
+            // only learn of the failure when the request times out.
+            if (tx.context && failureRing.push({*tx.context, error}))
+            {
+                eventfd_write(rxEventFd, 1);
+            }
+            else
+            {
+                lg2::error("Error while sending the message. RC={RC}", "RC",
+                           strerror(-error));
+            }
+        }
+        else
+        {
+            threadStats.sends++;
+        }
+
+        if (tx.pooled)
+        {
+            spareBuffers.push_back(std::move(tx.buffer));
+        }
+        // Buffers outside the pool are plain heap arrays, freeing them here
+        // is fine.
+        tx.buffer.reset();
+    }
+    return !stopping;
+}
+
+size_t ThreadedHandler::takeFreeBuffers()
+{
+    BufferPool::Buffer buffer;
+    while (spareBuffers.size() < headers.size() && freeRing.pop(buffer))
+    {
+        spareBuffers.push_back(std::move(buffer));
+    }
+    return spareBuffers.size();
+}
+
+bool ThreadedHandler::receive(int fd)
+{
+    const size_t bufferSize = pool.getBufferSize();
+
+    for (size_t round = 0; round < maxRoundsPerWakeup; ++round)
+    {
+        takeFreeBuffers();
+        size_t batch = std::min(
+            {headers.size(), spareBuffers.size(), rxRing.available()});
+        if (batch == 0)
+        {
+            return false;
+        }
+
+        // Receive into the buffers at the back of the spares
+        size_t first = spareBuffers.size() - batch;
+        for (size_t i = 0; i < batch; ++i)
+        {
+            iovs[i].iov_base = spareBuffers[first + i].get();
+            iovs[i].iov_len = bufferSize;
+            headers[i].msg_hdr = {};
+            headers[i].msg_hdr.msg_name = &addrs[i];
+            headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+            headers[i].msg_hdr.msg_iov = &iovs[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+            headers[i].msg_len = 0;
+        }
+
+        int count = recvmmsg(fd, headers.data(), batch,
+                             MSG_DONTWAIT | MSG_TRUNC, nullptr);
+        if (count < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                lg2::error("recvmmsg system call failed, RC={RC}", "RC",
+                           -errno);
+            }
+            return true;
+        }
+        auto received = Clock::now();
+
+        bool closed = false;
+        for (int i = 0; i < count; ++i)
+        {
+            auto& hdr = headers[i];
+            if (hdr.msg_len > bufferSize || (hdr.msg_hdr.msg_flags & MSG_TRUNC))
+            {
+                // the buffer stays with the spares
+                threadStats.truncated++;
+                continue;
+            }
+
+            RxDescriptor rx;
+            rx.fd = fd;
+            rx.buffer = std::move(spareBuffers[first + i]);
+            rx.length = hdr.msg_len;
+            rx.addrLen = hdr.msg_hdr.msg_namelen;
+            memcpy(&rx.addr, &addrs[i],
+                   std::min<size_t>(rx.addrLen, sizeof(rx.addr)));
+            rx.received = received;
+            rxRing.push(std::move(rx));
+
+            // An empty datagram is how a closed socket reads, the event loop
+            // exits on it, stop watching the socket rather than spin.
+            closed = closed || hdr.msg_len == 0;
+        }
+        std::erase_if(spareBuffers, [](const auto& b) { return !b; });
+
+        eventfd_write(rxEventFd, 1);
+
+        if (closed)
+        {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            return true;
+        }
+        if (static_cast<size_t>(count) < batch)
+        {
+            // socket is empty
+            return true;
+        }
+    }
+
+    return true;
+}
+
+} // namespace mctp_socket
@@ -0,0 +1,278 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.h"
+
+#include "buffer_pool.hpp"
+#include "socket_handler.hpp"
+#include "spsc_ring.hpp"
+
+#include <sdeventplus/source/event.hpp>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace mctp_socket
+{
+
+/** @struct IoThreadStats
+ *
+ *  Counters of the I/O thread. sendFallbacks counts the messages sent from
+ *  the event loop because the transmit ring was full, stalls the times the
+ *  I/O thread stopped receiving because the event loop had not caught up.
+ */
+struct IoThreadStats
+{
+    std::atomic<uint64_t> sends = 0;
+    std::atomic<uint64_t> sendErrors = 0;
+    std::atomic<uint64_t> truncated = 0;
+    std::atomic<uint64_t> stalls = 0;
+    uint64_t sendFallbacks = 0;
+};
+
+/** @class ThreadedHandler
+ *
+ *  MCTP socket handler whose sockets are owned by a dedicated I/O thread, so
+ *  that D-Bus traffic and sensor updates on the event loop neither delay the
+ *  reception of responses nor inflate their measured latency.
+ *
+ *  The thread and the event loop exchange descriptors over SpscRings and
+ *  wake each other with an eventfd:
+ *  - tx: messages to send and sockets to watch, event loop to I/O thread
+ *  - rx: received messages with their receive time, I/O thread to event loop
+ *  - free: empty receive buffers, event loop to I/O thread
+ *  - failure: requests whose send failed, I/O thread to event loop
+ *
+ *  Buffers come from a BufferPool which is only used by the event loop. The
+ *  I/O thread receives into the buffers handed to it by the free ring and by
+ *  sent messages, and moves them back with the rx ring, so it never acquires
+ *  nor releases a pooled buffer itself.
+ */
+class ThreadedHandler : public Handler
+{
+  public:
+    ThreadedHandler() = delete;
+    ThreadedHandler(const ThreadedHandler&) = delete;
+    ThreadedHandler(ThreadedHandler&&) = delete;
+    ThreadedHandler& operator=(const ThreadedHandler&) = delete;
+    ThreadedHandler& operator=(ThreadedHandler&&) = delete;
+
+    /** @brief Stop and join the I/O thread */
+    ~ThreadedHandler() override;
+
+    /** @brief Constructor, starts the I/O thread
+     *
+     *  @param[in] event - NSM daemon's main event loop
+     *  @param[in] handler - NSM request handler
+     *  @param[in] eventManager - NSM event Manager
+     *  @param[in/out] manager - MCTP socket manager
+     *  @param[in] verbose - Verbose tracing flag
+     *  @param[in] framing - addressing of the MCTP sockets
+     *  @param[in] ringSize - number of descriptors in each ring
+     *
+     *  @throws std::system_error if the eventfds cannot be created
+     */
+    ThreadedHandler(sdeventplus::Event& event,
+                    requester::Handler<requester::Request>& handler,
+                    nsm::EventManager& eventManager, Manager& manager,
+                    bool verbose, Framing framing,
+                    size_t ringSize = MCTP_IO_THREAD_RING_SIZE);
+
+    int registerMctpEndpoint(eid_t eid, int type, int protocol,
+                             const std::vector<uint8_t>& pathName) override;
+
+    int sendMsg(uint8_t tag, eid_t eid, int mctpFd, const uint8_t* nsmMsg,
+                size_t nsmMsgLen,
+                std::optional<uint8_t> instanceId) const override;
+
+    /** @brief Send and receive on a socket which is already set up, using
+     *         the framing of the handler. The caller keeps ownership of fd.
+     *
+     *  @return 0 on success, -errno otherwise
+     */
+    int attachSocket(int fd);
+
+    /** @brief Wake the I/O thread to send the queued messages */
+    void flush() const;
+
+    const ReceiveStats& getReceiveStats() const override
+    {
+        return stats;
+    }
+
+    const BufferPoolStats& getReceiveBufferStats() const override
+    {
+        return pool.getStats();
+    }
+
+    void logStats() const override;
+
+    /** @brief Get the counters of the I/O thread */
+    const IoThreadStats& getIoThreadStats() const
+    {
+        return threadStats;
+    }
+
+  private:
+    /** @struct TxDescriptor
+     *
+     *  A message to send, or with an empty buffer a socket for the I/O thread
+     *  to watch. pooled tells whether the buffer may be reused to receive,
+     *  context identifies the request to fail if the send fails.
+     */
+    struct TxDescriptor
+    {
+        int fd = -1;
+        bool hasAddr = false;
+        bool pooled = false;
+        sockaddr_mctp addr{};
+        BufferPool::Buffer buffer;
+        size_t length = 0;
+        std::optional<uint32_t> context;
+    };
+
+    /** @struct SendFailure
+     *
+     *  A request whose send failed on the I/O thread, with the -errno of the
+     *  failed sendmsg.
+     */
+    struct SendFailure
+    {
+        uint32_t context = 0;
+        int rc = 0;
+    };
+
+    /** @struct RxDescriptor
+     *
+     *  A received message. An empty buffer reports that the socket was
+     *  closed or failed.
+     */
+    struct RxDescriptor
+    {
+        int fd = -1;
+        BufferPool::Buffer buffer;
+        size_t length = 0;
+        sockaddr_mctp addr{};
+        socklen_t addrLen = 0;
+        Clock::time_point received;
+    };
+
+    /** @brief Upper bound of recvmmsg calls per socket and wakeup of the
+     *         I/O thread, so that a flooding socket cannot starve the others
+     */
+    static constexpr size_t maxRoundsPerWakeup = 4;
+
+    void handleReceivedMsg(IO& io, int fd, uint32_t revents) override;
+
+    /** @brief Queue a message for the I/O thread, or send it from the event
+     *         loop if the transmit ring is full
+     *
+     *  @param[in] context - request to fail if the I/O thread cannot send
+     *                       the message, from requestContext()
+     */
+    int queueSend(int fd, const sockaddr_mctp* addr,
+                  std::span<const uint8_t> prefix,
+                  std::span<const uint8_t> payload,
+                  std::optional<uint32_t> context = std::nullopt) const;
+
+    /** @brief Hand empty buffers to the I/O thread until it holds
+     *         bufferTarget of them
+     */
+    void refillFreeBuffers();
+
+    /** @brief Account a wakeup which handled the given number of messages */
+    void record(size_t handled);
+
+    /** @brief Body of the I/O thread */
+    void run();
+
+    /** @brief Send or watch what the event loop queued, I/O thread only
+     *
+     *  @return false if the thread must exit
+     */
+    bool handleTx();
+
+    /** @brief Receive the datagrams pending on a socket, I/O thread only
+     *
+     *  @return false if the rx ring or the buffers ran out
+     */
+    bool receive(int fd);
+
+    /** @brief Move buffers from the free ring to the spares, I/O thread only
+     *
+     *  @return number of spare buffers
+     */
+    size_t takeFreeBuffers();
+
+    Framing framing;
+
+    /** @brief Sockets opened by registerMctpEndpoint */
+    std::vector<std::unique_ptr<utils::CustomFD>> ownedFds;
+    int inKernelFd = -1;
+    int inKernelSendBufferSize = 0;
+    std::map<std::vector<uint8_t>, std::pair<int, int>> demuxSockets;
+
+    mutable BufferPool pool;
+
+    /** @brief Number of pooled buffers held by the I/O thread or queued to
+     *         it, and the number it should hold to receive a full batch
+     */
+    mutable size_t lentBuffers = 0;
+    size_t bufferTarget;
+
+    mutable SpscRing<TxDescriptor> txRing;
+    SpscRing<RxDescriptor> rxRing;
+    mutable SpscRing<BufferPool::Buffer> freeRing;
+    SpscRing<SendFailure> failureRing;
+
+    /** @brief Wakes the I/O thread, and the event loop */
+    int txEventFd = -1;
+    int rxEventFd = -1;
+
+    /** @brief Set by the I/O thread when it stopped receiving until the
+     *         event loop drains the rx ring
+     */
+    std::atomic<bool> stalled = false;
+    std::atomic<bool> stopping = false;
+
+    std::unique_ptr<IO> rxIo;
+
+    /** @brief Wakes the I/O thread at the end of the loop iteration */
+    std::unique_ptr<sdeventplus::source::Defer> wakeSource;
+
+    ReceiveStats stats;
+    mutable IoThreadStats threadStats;
+
+    /** @brief State of the I/O thread, untouched by the event loop while
+     *         the thread runs
+     */
+    std::vector<BufferPool::Buffer> spareBuffers;
+    std::vector<iovec> iovs;
+    std::vector<sockaddr_storage> addrs;
+    std::vector<mmsghdr> headers;
+    int epollFd = -1;
+
+    std::thread ioThread;
+};
+
+} // namespace mctp_socket
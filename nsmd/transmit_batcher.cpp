@@ -0,0 +1,207 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "transmit_batcher.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace mctp_socket
+{
+
+TransmitBatcher::TransmitBatcher(sdeventplus::Event& event, size_t batchSize,
+                                 size_t bufferSize) :
+    event(event), batchSize(std::max<size_t>(batchSize, 1)),
+    pool(bufferSize, this->batchSize * maxBatchesPerFlush),
+    headers(this->batchSize)
+{
+    pending.reserve(this->batchSize * maxBatchesPerFlush);
+    stats.batchHistogram.resize(this->batchSize + 1);
+}
+
+int TransmitBatcher::queue(int fd, const sockaddr_mctp* addr,
+                           std::span<const uint8_t> prefix,
+                           std::span<const uint8_t> payload,
+                           std::optional<uint32_t> context)
+{
+    size_t length = prefix.size() + payload.size();
+    if (batchSize == 1 || length > pool.getBufferSize())
+    {
+        // keep the order of the socket
+        flush();
+        return sendNow(fd, addr, prefix, payload);
+    }
+
+    if (pending.size() == pending.capacity())
+    {
+        flush();
+    }
+
+    auto buffer = pool.acquire();
+    std::copy(prefix.begin(), prefix.end(), buffer.get());
+    std::copy(payload.begin(), payload.end(), buffer.get() + prefix.size());
+
+    Pending& message = pending.emplace_back();
+    message.fd = fd;
+    message.hasAddr = addr != nullptr;
+    if (addr)
+    {
+        message.addr = *addr;
+    }
+    message.iov.iov_base = buffer.get();
+    message.iov.iov_len = length;
+    message.buffer = std::move(buffer);
+    message.context = context;
+
+    if (!flushSource)
+    {
+        flushSource = std::make_unique<sdeventplus::source::Defer>(
+            event, [this](sdeventplus::source::EventBase& source) {
+            source.set_enabled(sdeventplus::source::Enabled::Off);
+            flush();
+        });
+    }
+    flushSource->set_enabled(sdeventplus::source::Enabled::OneShot);
+
+    return 0;
+}
+
+void TransmitBatcher::flush()
+{
+    if (pending.empty())
+    {
+        return;
+    }
+
+    stats.flushes++;
+    // Almost always a single socket, the demux socket or the AF_MCTP one
+    while (!pending.empty())
+    {
+        flushSocket(pending.front().fd);
+    }
+
+    // The failure handler may queue messages, so report the failures once
+    // the batch is done
+    if (failures.empty())
+    {
+        return;
+    }
+    auto failed = std::exchange(failures, {});
+    if (failureHandler)
+    {
+        for (const auto& [context, rc] : failed)
+        {
+            failureHandler(context, rc);
+        }
+    }
+}
+
+void TransmitBatcher::flushSocket(int fd)
+{
+    auto other = [fd](const Pending& message) { return message.fd != fd; };
+    auto first = std::none_of(pending.begin(), pending.end(), other)
+                     ? pending.begin()
+                     : std::stable_partition(pending.begin(), pending.end(),
+                                             other);
+
+    for (auto batch = first; batch != pending.end();)
+    {
+        size_t count = std::min<size_t>(batchSize, pending.end() - batch);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto& message = batch[i];
+            auto& hdr = headers[i].msg_hdr;
+            hdr = {};
+            hdr.msg_iov = &message.iov;
+            hdr.msg_iovlen = 1;
+            if (message.hasAddr)
+            {
+                hdr.msg_name = &message.addr;
+                hdr.msg_namelen = sizeof(message.addr);
+            }
+        }
+
+        int sent = sendmmsg(fd, headers.data(), count, 0);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            // drop the message sendmmsg failed on and go on with the rest
+            int rc = -errno;
+            stats.errors++;
+            lg2::error("sendmmsg system call failed, RC={RC}", "RC",
+                       strerror(errno));
+            if (batch->context)
+            {
+                failures.emplace_back(*batch->context, rc);
+            }
+            sent = 1;
+        }
+        else
+        {
+            record(sent);
+        }
+        batch += sent;
+    }
+
+    pending.erase(first, pending.end());
+}
+
+int TransmitBatcher::sendNow(int fd, const sockaddr_mctp* addr,
+                             std::span<const uint8_t> prefix,
+                             std::span<const uint8_t> payload)
+{
+    struct iovec iov[2];
+    iov[0].iov_base = const_cast<uint8_t*>(prefix.data());
+    iov[0].iov_len = prefix.size();
+    iov[1].iov_base = const_cast<uint8_t*>(payload.data());
+    iov[1].iov_len = payload.size();
+    struct msghdr msg = {};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = sizeof(iov) / sizeof(iov[0]);
+    if (addr)
+    {
+        msg.msg_name = const_cast<sockaddr_mctp*>(addr);
+        msg.msg_namelen = sizeof(*addr);
+    }
+
+    if (sendmsg(fd, &msg, 0) == -1)
+    {
+        int rc = -errno;
+        stats.errors++;
+        return rc;
+    }
+    record(1);
+    return 0;
+}
+
+void TransmitBatcher::record(size_t sent)
+{
+    stats.syscalls++;
+    stats.messages += sent;
+    stats.lastBatch = sent;
+    stats.maxBatch = std::max(stats.maxBatch, sent);
+    stats.batchHistogram[std::min(sent, stats.batchHistogram.size() - 1)]++;
+}
+
+} // namespace mctp_socket
@@ -0,0 +1,179 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.h"
+
+#include "libnsm/requester/mctp.h"
+
+#include "buffer_pool.hpp"
+
+#include <linux/mctp.h>
+#include <sys/socket.h>
+
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/event.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace mctp_socket
+{
+
+/** @struct TransmitStats
+ *
+ *  Counters of the TransmitBatcher. batchHistogram[n] is the number of
+ *  sendmmsg calls which sent n messages, the last bucket also counts larger
+ *  batches. Messages sent on their own, because they do not fit a buffer or
+ *  batching is disabled, count as batches of one.
+ */
+struct TransmitStats
+{
+    uint64_t flushes = 0;
+    uint64_t messages = 0;
+    uint64_t syscalls = 0;
+    uint64_t errors = 0;
+    size_t lastBatch = 0;
+    size_t maxBatch = 0;
+    std::vector<uint64_t> batchHistogram;
+};
+
+/** @class TransmitBatcher
+ *
+ *  Gathers the messages sent during one iteration of the event loop and
+ *  sends them with one sendmmsg per socket once the iteration is done, so a
+ *  polling tick which fires for many endpoints at once does not cost one
+ *  syscall per request. Messages are copied into pooled buffers when queued
+ *  and keep their order on each socket.
+ *
+ *  A message which fails to be sent once queued is reported to the failure
+ *  handler with the context it was queued with, after the flush.
+ */
+class TransmitBatcher
+{
+  public:
+    /** @brief Handler of a queued message which could not be sent
+     *
+     *  @param[in] context - context the message was queued with
+     *  @param[in] rc - -errno of the failed send
+     */
+    using FailureHandler = std::function<void(uint32_t context, int rc)>;
+
+    TransmitBatcher(const TransmitBatcher&) = delete;
+    TransmitBatcher(TransmitBatcher&&) = delete;
+    TransmitBatcher& operator=(const TransmitBatcher&) = delete;
+    TransmitBatcher& operator=(TransmitBatcher&&) = delete;
+    ~TransmitBatcher() = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] event - event loop which flushes the batch at the end of
+     *                     its iteration
+     *  @param[in] batchSize - number of messages sent per sendmmsg, 1 sends
+     *                         every message when it is queued
+     *  @param[in] bufferSize - size of the buffer each message is copied
+     *                          into, larger messages are sent at once
+     */
+    explicit TransmitBatcher(sdeventplus::Event& event,
+                             size_t batchSize = MCTP_TX_BATCH_SIZE,
+                             size_t bufferSize = MCTP_RX_BUFFER_SIZE +
+                                                 MCTP_DEMUX_PREFIX);
+
+    /** @brief Queue the message made of prefix followed by payload
+     *
+     *  @param[in] fd - socket to send on
+     *  @param[in] addr - destination on an unconnected socket, or nullptr
+     *  @param[in] prefix - bytes sent before the payload, may be empty
+     *  @param[in] payload - message
+     *  @param[in] context - context reported to the failure handler if the
+     *                       queued message cannot be sent, none if unset
+     *
+     *  @return 0 if the message is queued or sent, -errno if sending it
+     *          at once failed
+     */
+    int queue(int fd, const sockaddr_mctp* addr,
+              std::span<const uint8_t> prefix,
+              std::span<const uint8_t> payload,
+              std::optional<uint32_t> context = std::nullopt);
+
+    /** @brief Send every queued message */
+    void flush();
+
+    /** @brief Set the handler of the queued messages which fail */
+    void setFailureHandler(FailureHandler handler)
+    {
+        failureHandler = std::move(handler);
+    }
+
+    /** @brief Number of queued messages */
+    size_t size() const
+    {
+        return pending.size();
+    }
+
+    /** @brief Get the transmit counters */
+    const TransmitStats& getStats() const
+    {
+        return stats;
+    }
+
+  private:
+    /** @brief Upper bound of queued messages, the batch is flushed early
+     *         when it is reached
+     */
+    static constexpr size_t maxBatchesPerFlush = 8;
+
+    struct Pending
+    {
+        int fd;
+        bool hasAddr;
+        sockaddr_mctp addr;
+        BufferPool::Buffer buffer;
+        iovec iov;
+        std::optional<uint32_t> context;
+    };
+
+    /** @brief Send one message with sendmsg */
+    int sendNow(int fd, const sockaddr_mctp* addr,
+                std::span<const uint8_t> prefix,
+                std::span<const uint8_t> payload);
+
+    /** @brief Send the queued messages of one socket, in order */
+    void flushSocket(int fd);
+
+    /** @brief Account a syscall which sent the given number of messages */
+    void record(size_t sent);
+
+    sdeventplus::Event& event;
+    size_t batchSize;
+    BufferPool pool;
+    std::vector<Pending> pending;
+    std::vector<mmsghdr> headers;
+    std::unique_ptr<sdeventplus::source::Defer> flushSource;
+    TransmitStats stats;
+    FailureHandler failureHandler;
+    /** @brief Context and -errno of the messages failed during a flush */
+    std::vector<std::pair<uint32_t, int>> failures;
+};
+
+} // namespace mctp_socket
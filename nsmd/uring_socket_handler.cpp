@@ -0,0 +1,509 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "uring_socket_handler.hpp"
+
+#include "libnsm/base.h"
+
+#include "common/globals.hpp"
+#include "common/utils.hpp"
+#include "requester/handler.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <system_error>
+
+namespace mctp_socket
+{
+
+IoUringHandler::IoUringHandler(sdeventplus::Event& event,
+                               requester::Handler<requester::Request>& handler,
+                               nsm::EventManager& eventManager,
+                               Manager& manager, bool verbose,
+                               Framing framing, unsigned entries) :
+    Handler(event, handler, eventManager, manager, verbose),
+    framing(framing), ringEntries(std::bit_ceil(std::max(entries, 2u))),
+    rxBufferSize(sizeof(io_uring_recvmsg_out) + sizeof(sockaddr_storage) +
+                 MCTP_RX_BUFFER_SIZE + MCTP_DEMUX_PREFIX),
+    rxPool(rxBufferSize, MCTP_RX_BUFFER_POOL_SIZE), rxBuffers(ringEntries),
+    sendPool(MCTP_RX_BUFFER_SIZE + MCTP_DEMUX_PREFIX, ringEntries),
+    sendSlots(ringEntries)
+{
+    int rc = io_uring_queue_init(ringEntries, &ring, 0);
+    if (rc < 0)
+    {
+        throw std::system_error(-rc, std::generic_category(),
+                                "io_uring_queue_init");
+    }
+
+    bufRing = io_uring_setup_buf_ring(&ring, ringEntries, bufferGroup, 0, &rc);
+    if (!bufRing)
+    {
+        io_uring_queue_exit(&ring);
+        throw std::system_error(-rc, std::generic_category(),
+                                "io_uring_setup_buf_ring");
+    }
+
+    auto mask = io_uring_buf_ring_mask(ringEntries);
+    for (unsigned bid = 0; bid < ringEntries; ++bid)
+    {
+        rxBuffers[bid] = rxPool.acquire();
+        io_uring_buf_ring_add(bufRing, rxBuffers[bid].get(), rxBufferSize, bid,
+                              mask, bid);
+    }
+    io_uring_buf_ring_advance(bufRing, ringEntries);
+
+    freeSendSlots.reserve(ringEntries);
+    for (uint32_t slot = ringEntries; slot > 0; --slot)
+    {
+        freeSendSlots.push_back(slot - 1);
+    }
+
+    stats.batchHistogram.resize(completionBatch + 1);
+
+    ringIo = std::make_unique<IO>(
+        event, ring.ring_fd, EPOLLIN,
+        std::bind_front(&IoUringHandler::handleReceivedMsg, this));
+    ringIo->set_priority(SD_EVENT_SOURCE_MAX_PRIORITY);
+
+    flushSource = std::make_unique<sdeventplus::source::Defer>(
+        event, [this](sdeventplus::source::EventBase& source) {
+        source.set_enabled(sdeventplus::source::Enabled::Off);
+        flush();
+    });
+    flushSource->set_enabled(sdeventplus::source::Enabled::Off);
+}
+
+IoUringHandler::~IoUringHandler()
+{
+    flushSource.reset();
+    ringIo.reset();
+    io_uring_free_buf_ring(&ring, bufRing, ringEntries, bufferGroup);
+    io_uring_queue_exit(&ring);
+    for (const auto& socket : sockets)
+    {
+        if (socket->owned)
+        {
+            close(socket->fd);
+        }
+    }
+}
+
+int IoUringHandler::registerMctpEndpoint(eid_t eid, int type, int protocol,
+                                         const std::vector<uint8_t>& pathName)
+{
+    if (framing == Framing::InKernel)
+    {
+        if (inKernelFd < 0)
+        {
+            int fd = openInKernelSocket(inKernelSendBufferSize);
+            if (fd < 0)
+            {
+                lg2::error("Failed to open the MCTP socket, EID={ED}", "ED",
+                           eid);
+                return fd;
+            }
+            int rc = addSocket(fd, true);
+            if (rc < 0)
+            {
+                return rc;
+            }
+            inKernelFd = fd;
+        }
+        manager.registerEndpoint(eid, inKernelFd, inKernelSendBufferSize);
+        return NSM_SUCCESS;
+    }
+
+    auto entry = demuxSockets.find(pathName);
+    if (entry == demuxSockets.end())
+    {
+        int sendBufferSize = 0;
+        int fd = openDemuxSocket(type, protocol, pathName, sendBufferSize);
+        if (fd < 0)
+        {
+            return fd;
+        }
+        int rc = addSocket(fd, true);
+        if (rc < 0)
+        {
+            return rc;
+        }
+        entry = demuxSockets.emplace(pathName, std::pair(fd, sendBufferSize))
+                    .first;
+    }
+    manager.registerEndpoint(eid, entry->second.first, entry->second.second);
+
+    return NSM_SUCCESS;
+}
+
+int IoUringHandler::attachSocket(int fd)
+{
+    return addSocket(fd, false);
+}
+
+int IoUringHandler::addSocket(int fd, bool owned)
+{
+    auto socket = std::make_unique<Socket>();
+    socket->index = sockets.size();
+    socket->fd = fd;
+    socket->owned = owned;
+    socket->msg.msg_namelen = sizeof(sockaddr_storage);
+    arm(*socket);
+    sockets.push_back(std::move(socket));
+
+    int rc = flush();
+    return rc < 0 ? rc : 0;
+}
+
+void IoUringHandler::arm(Socket& socket)
+{
+    auto sqe = getSqe();
+    if (!sqe)
+    {
+        // Retried after the next batch of completions.
+        return;
+    }
+
+    io_uring_prep_recvmsg_multishot(sqe, socket.fd, &socket.msg, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = bufferGroup;
+    io_uring_sqe_set_data64(sqe, userData(Op::Receive, socket.index));
+    socket.armed = true;
+    uringStats.rearms++;
+}
+
+io_uring_sqe* IoUringHandler::getSqe() const
+{
+    auto sqe = io_uring_get_sqe(&ring);
+    if (!sqe && flush() >= 0)
+    {
+        sqe = io_uring_get_sqe(&ring);
+    }
+    return sqe;
+}
+
+int IoUringHandler::flush() const
+{
+    int rc = io_uring_submit(&ring);
+    if (rc < 0)
+    {
+        lg2::error("io_uring_submit failed, RC={RC}", "RC", strerror(-rc));
+    }
+    else if (rc > 0)
+    {
+        uringStats.submits++;
+    }
+    return rc;
+}
+
+int IoUringHandler::sendMsg(uint8_t tag, eid_t eid, int mctpFd,
+                            const uint8_t* nsmMsg, size_t nsmMsgLen,
+                            std::optional<uint8_t> instanceId) const
+{
+    if (framing == Framing::InKernel)
+    {
+        auto addr = mctpAddress(eid, MCTP_TAG_OWNER);
+        TxMessage tx({}, {nsmMsg, nsmMsgLen}, instanceId);
+
+        if (verbose)
+        {
+            utils::printBuffer(utils::Tx, tx.nsmMsg(), addr.smctp_tag, eid);
+        }
+        return queueSend(mctpFd, &addr, tx.head(), tx.body(),
+                         requestContext(eid, instanceId));
+    }
+
+    uint8_t hdr[MCTP_DEMUX_PREFIX] = {
+        tag, eid, MCTP_MSG_TYPE_PCI_VDM}; // TO_TAG, EID, MCTP_MSG_TYPE
+    TxMessage tx(hdr, {nsmMsg, nsmMsgLen}, instanceId);
+
+    if (verbose)
+    {
+        utils::printBuffer(utils::Tx, tx.nsmMsg(), tag, eid);
+    }
+    return queueSend(mctpFd, nullptr, tx.head(), tx.body(),
+                     requestContext(eid, instanceId));
+}
+
+int IoUringHandler::queueSend(int fd, const sockaddr_mctp* addr,
+                              std::span<const uint8_t> prefix,
+                              std::span<const uint8_t> payload,
+                              std::optional<uint32_t> context) const
+{
+    size_t length = prefix.size() + payload.size();
+    if (freeSendSlots.empty() || length > sendPool.getBufferSize())
+    {
+        return sendNow(fd, addr, prefix, payload);
+    }
+
+    auto sqe = getSqe();
+    if (!sqe)
+    {
+        return sendNow(fd, addr, prefix, payload);
+    }
+
+    auto index = freeSendSlots.back();
+    freeSendSlots.pop_back();
+
+    auto& slot = sendSlots[index];
+    slot.buffer = sendPool.acquire();
+    std::copy(prefix.begin(), prefix.end(), slot.buffer.get());
+    std::copy(payload.begin(), payload.end(),
+              slot.buffer.get() + prefix.size());
+    slot.iov.iov_base = slot.buffer.get();
+    slot.iov.iov_len = length;
+    slot.context = context;
+    slot.msg = {};
+    slot.msg.msg_iov = &slot.iov;
+    slot.msg.msg_iovlen = 1;
+    if (addr)
+    {
+        slot.addr = *addr;
+        slot.msg.msg_name = &slot.addr;
+        slot.msg.msg_namelen = sizeof(slot.addr);
+    }
+
+    io_uring_prep_sendmsg(sqe, fd, &slot.msg, 0);
+    io_uring_sqe_set_data64(sqe, userData(Op::Send, index));
+    uringStats.sends++;
+
+    flushSource->set_enabled(sdeventplus::source::Enabled::OneShot);
+
+    return NSM_SW_SUCCESS;
+}
+
+int IoUringHandler::sendNow(int fd, const sockaddr_mctp* addr,
+                            std::span<const uint8_t> prefix,
+                            std::span<const uint8_t> payload) const
+{
+    struct iovec iov[2];
+    iov[0].iov_base = const_cast<uint8_t*>(prefix.data());
+    iov[0].iov_len = prefix.size();
+    iov[1].iov_base = const_cast<uint8_t*>(payload.data());
+    iov[1].iov_len = payload.size();
+    struct msghdr msg = {};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = sizeof(iov) / sizeof(iov[0]);
+    if (addr)
+    {
+        msg.msg_name = const_cast<sockaddr_mctp*>(addr);
+        msg.msg_namelen = sizeof(*addr);
+    }
+
+    uringStats.sendFallbacks++;
+    ssize_t rc = sendmsg(fd, &msg, 0);
+    if (rc == -1)
+    {
+        int error = -errno;
+        uringStats.sendErrors++;
+        lg2::error("Error while sending the message. RC={RC}", "RC",
+                   strerror(-error));
+        return NSM_SW_ERROR;
+    }
+
+    return NSM_SW_SUCCESS;
+}
+
+void IoUringHandler::handleReceivedMsg([[maybe_unused]] IO& io,
+                                       [[maybe_unused]] int fd,
+                                       [[maybe_unused]] uint32_t revents)
+{
+    std::array<io_uring_cqe*, completionBatch> cqes;
+    std::array<Completion, completionBatch> completions;
+    size_t handled = 0;
+    bool stop = false;
+
+    for (size_t round = 0; round < maxRoundsPerWakeup && !stop; ++round)
+    {
+        unsigned count = io_uring_peek_batch_cqe(&ring, cqes.data(),
+                                                 cqes.size());
+        if (count == 0)
+        {
+            break;
+        }
+
+        for (unsigned i = 0; i < count; ++i)
+        {
+            completions[i] = {cqes[i]->user_data, cqes[i]->res,
+                              cqes[i]->flags};
+        }
+        io_uring_cq_advance(&ring, count);
+
+        for (unsigned i = 0; i < count && !stop; ++i)
+        {
+            stop = !handleCompletion(completions[i], handled);
+        }
+    }
+
+    if (stop)
+    {
+        return;
+    }
+
+    for (auto& socket : sockets)
+    {
+        if (!socket->armed)
+        {
+            arm(*socket);
+        }
+    }
+    flush();
+
+    record(handled);
+    if (verbose)
+    {
+        lg2::info("Handled {COUNT} MCTP messages in one wakeup", "COUNT",
+                  handled);
+    }
+}
+
+bool IoUringHandler::handleCompletion(const Completion& completion,
+                                      size_t& handled)
+{
+    auto op = static_cast<Op>(completion.userData >> 32);
+    auto index = static_cast<uint32_t>(completion.userData);
+
+    if (op == Op::Send)
+    {
+        auto context = sendSlots[index].context;
+        sendSlots[index].buffer.reset();
+        freeSendSlots.push_back(index);
+        if (completion.res < 0)
+        {
+            uringStats.sendErrors++;
+            if (context)
+            {
+                // sendMsg() reported success, fail the request now rather
+                // than after its timeout
+                handleSendFailure(*context, completion.res);
+            }
+            else
+            {
+                lg2::error("Error while sending the message. RC={RC}", "RC",
+                           strerror(-completion.res));
+            }
+        }
+        return true;
+    }
+
+    if (op != Op::Receive || index >= sockets.size())
+    {
+        return true;
+    }
+
+    auto& socket = *sockets[index];
+    if (!(completion.flags & IORING_CQE_F_MORE))
+    {
+        // The kernel ended the multishot receive, it is posted again once
+        // the batch is handled.
+        socket.armed = false;
+    }
+
+    if (completion.res < 0)
+    {
+        // ENOBUFS only means every provided buffer was in use.
+        if (completion.res != -ENOBUFS)
+        {
+            lg2::error("recvmsg failed, RC={RC}", "RC",
+                       strerror(-completion.res));
+        }
+        return true;
+    }
+
+    if (!(completion.flags & IORING_CQE_F_BUFFER))
+    {
+        return true;
+    }
+
+    auto buffer = takeBuffer(completion.flags >> IORING_CQE_BUFFER_SHIFT);
+    auto out = io_uring_recvmsg_validate(buffer.get(), completion.res,
+                                         &socket.msg);
+    if (!out)
+    {
+        return true;
+    }
+    if (out->flags & MSG_TRUNC)
+    {
+        stats.truncated++;
+        lg2::error(
+            "Dropping MCTP message larger than the receive buffer. BufferSize={SIZE}",
+            "SIZE", MCTP_RX_BUFFER_SIZE);
+        return true;
+    }
+
+    sockaddr_storage addr{};
+    socklen_t addrLen = std::min<socklen_t>(out->namelen, sizeof(addr));
+    memcpy(&addr, io_uring_recvmsg_name(out), addrLen);
+
+    RxMessage rxMsg{
+        static_cast<uint8_t*>(io_uring_recvmsg_payload(out, &socket.msg)),
+        io_uring_recvmsg_payload_length(out, completion.res, &socket.msg),
+        addr, addrLen, buffer};
+
+    ++handled;
+    if (framing == Framing::InKernel)
+    {
+        return handleInKernelMsg(
+            rxMsg, [this, fd = socket.fd](const sockaddr_mctp& destAddr,
+                                          const Response& response) {
+            queueSend(fd, &destAddr, {}, response);
+        });
+    }
+    return handleDemuxMsg(rxMsg, [this, fd = socket.fd](
+                                     std::span<const uint8_t> prefix,
+                                     const Response& response) {
+        queueSend(fd, nullptr, prefix, response);
+    });
+}
+
+BufferPool::Buffer IoUringHandler::takeBuffer(uint16_t bid)
+{
+    auto buffer = std::move(rxBuffers[bid]);
+    rxBuffers[bid] = rxPool.acquire();
+    io_uring_buf_ring_add(bufRing, rxBuffers[bid].get(), rxBufferSize, bid,
+                          io_uring_buf_ring_mask(ringEntries), 0);
+    io_uring_buf_ring_advance(bufRing, 1);
+    return buffer;
+}
+
+void IoUringHandler::logStats() const
+{
+    Handler::logStats();
+    lg2::error("logStats: IO_URING SUBMITS={SUBMITS}, SENDS={SENDS}, "
+               "FALLBACKS={FALLBACKS}, ERRORS={ERRORS}, REARMS={REARMS}",
+               "SUBMITS", uringStats.submits, "SENDS", uringStats.sends,
+               "FALLBACKS", uringStats.sendFallbacks, "ERRORS",
+               uringStats.sendErrors, "REARMS", uringStats.rearms);
+}
+
+void IoUringHandler::record(size_t handled)
+{
+    stats.wakeups++;
+    stats.messages += handled;
+    stats.lastBatch = handled;
+    stats.maxBatch = std::max(stats.maxBatch, handled);
+    stats.batchHistogram[std::min(handled,
+                                  stats.batchHistogram.size() - 1)]++;
+}
+
+} // namespace mctp_socket
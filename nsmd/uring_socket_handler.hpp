@@ -0,0 +1,280 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "config.h"
+
+#include "buffer_pool.hpp"
+#include "socket_handler.hpp"
+
+#include <liburing.h>
+#include <linux/mctp.h>
+
+#include <sdeventplus/source/event.hpp>
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace mctp_socket
+{
+
+/** @struct IoUringStats
+ *
+ *  Counters of the io_uring transport. sendFallbacks counts the messages sent
+ *  with a plain sendmsg because no submission slot was free.
+ */
+struct IoUringStats
+{
+    uint64_t submits = 0;
+    uint64_t sends = 0;
+    uint64_t sendFallbacks = 0;
+    uint64_t sendErrors = 0;
+    uint64_t rearms = 0;
+};
+
+/** @class IoUringHandler
+ *
+ *  MCTP socket handler built on io_uring. Outgoing messages are queued as
+ *  sendmsg submissions and handed to the kernel together at the end of the
+ *  event loop iteration, or as soon as the submission queue is full. Each
+ *  socket keeps a multishot recvmsg posted on a ring of provided buffers
+ *  backed by a BufferPool, and the completions are handled in batches when
+ *  the ring becomes readable, so a busy endpoint costs neither a syscall per
+ *  message nor a copy of the received data.
+ */
+class IoUringHandler : public Handler
+{
+  public:
+    IoUringHandler() = delete;
+    IoUringHandler(const IoUringHandler&) = delete;
+    IoUringHandler(IoUringHandler&&) = delete;
+    IoUringHandler& operator=(const IoUringHandler&) = delete;
+    IoUringHandler& operator=(IoUringHandler&&) = delete;
+    ~IoUringHandler() override;
+
+    /** @brief Constructor
+     *
+     *  @param[in] event - NSM daemon's main event loop
+     *  @param[in] handler - NSM request handler
+     *  @param[in] eventManager - NSM event Manager
+     *  @param[in/out] manager - MCTP socket manager
+     *  @param[in] verbose - Verbose tracing flag
+     *  @param[in] framing - addressing of the MCTP sockets
+     *  @param[in] entries - size of the submission queue and of the ring of
+     *                       receive buffers
+     *
+     *  @throws std::system_error if the io_uring cannot be set up
+     */
+    IoUringHandler(sdeventplus::Event& event,
+                   requester::Handler<requester::Request>& handler,
+                   nsm::EventManager& eventManager, Manager& manager,
+                   bool verbose, Framing framing,
+                   unsigned entries = MCTP_IO_URING_ENTRIES);
+
+    int registerMctpEndpoint(eid_t eid, int type, int protocol,
+                             const std::vector<uint8_t>& pathName) override;
+
+    int sendMsg(uint8_t tag, eid_t eid, int mctpFd, const uint8_t* nsmMsg,
+                size_t nsmMsgLen,
+                std::optional<uint8_t> instanceId) const override;
+
+    /** @brief Send and receive on a socket which is already set up, using
+     *         the framing of the handler. The caller keeps ownership of fd.
+     *
+     *  @return 0 on success, -errno otherwise
+     */
+    int attachSocket(int fd);
+
+    /** @brief Hand the queued submissions to the kernel
+     *
+     *  @return number of submitted entries, -errno on failure
+     */
+    int flush() const;
+
+    const ReceiveStats& getReceiveStats() const override
+    {
+        return stats;
+    }
+
+    const BufferPoolStats& getReceiveBufferStats() const override
+    {
+        return rxPool.getStats();
+    }
+
+    void logStats() const override;
+
+    /** @brief Get the counters of the submission path */
+    const IoUringStats& getIoUringStats() const
+    {
+        return uringStats;
+    }
+
+  private:
+    enum class Op : uint8_t
+    {
+        Send = 1,
+        Receive = 2
+    };
+
+    /** @struct Socket
+     *
+     *  A socket with its multishot recvmsg. The kernel reads msg when the
+     *  receive is armed, so the object must not move.
+     */
+    struct Socket
+    {
+        uint32_t index;
+        int fd;
+        bool owned;
+        bool armed = false;
+        msghdr msg{};
+    };
+
+    /** @struct SendSlot
+     *
+     *  A queued sendmsg. The message is copied into a pooled buffer so the
+     *  caller's buffer may go away before the send completes. context
+     *  identifies the request to fail if the send completes with an error.
+     */
+    struct SendSlot
+    {
+        BufferPool::Buffer buffer;
+        sockaddr_mctp addr{};
+        iovec iov{};
+        msghdr msg{};
+        std::optional<uint32_t> context;
+    };
+
+    /** @struct Completion
+     *
+     *  Copy of a CQE, taken before the completion queue is advanced so that
+     *  handling it may queue new submissions.
+     */
+    struct Completion
+    {
+        uint64_t userData;
+        int32_t res;
+        uint32_t flags;
+    };
+
+    /** @brief Buffer group of the provided receive buffers */
+    static constexpr uint16_t bufferGroup = 0;
+
+    /** @brief Upper bound of completion batches handled per wakeup, so that
+     *         a flooding socket cannot starve the rest of the event loop
+     */
+    static constexpr size_t maxRoundsPerWakeup = 4;
+
+    static constexpr size_t completionBatch = 32;
+
+    static uint64_t userData(Op op, uint32_t index)
+    {
+        return (static_cast<uint64_t>(op) << 32) | index;
+    }
+
+    void handleReceivedMsg(IO& io, int fd, uint32_t revents) override;
+
+    /** @brief Add a socket and post its receive */
+    int addSocket(int fd, bool owned);
+
+    /** @brief Post the multishot recvmsg of a socket */
+    void arm(Socket& socket);
+
+    /** @brief Get a free SQE, submitting the queued ones if the submission
+     *         queue is full
+     */
+    io_uring_sqe* getSqe() const;
+
+    /** @brief Queue a sendmsg of prefix followed by payload
+     *
+     *  @param[in] fd - socket to send on
+     *  @param[in] addr - destination for the AF_MCTP socket, nullptr on a
+     *                    connected socket
+     *  @param[in] prefix - demux prefix, empty for the AF_MCTP socket
+     *  @param[in] payload - NSM message
+     *  @param[in] context - request to fail if the queued send completes
+     *                       with an error, from requestContext()
+     *
+     *  @return NSM_SW_SUCCESS, or NSM_SW_ERROR if the message could not be
+     *          queued nor sent
+     */
+    int queueSend(int fd, const sockaddr_mctp* addr,
+                  std::span<const uint8_t> prefix,
+                  std::span<const uint8_t> payload,
+                  std::optional<uint32_t> context = std::nullopt) const;
+
+    /** @brief Send synchronously, used when no send slot is free */
+    int sendNow(int fd, const sockaddr_mctp* addr,
+                std::span<const uint8_t> prefix,
+                std::span<const uint8_t> payload) const;
+
+    /** @brief Handle one completion
+     *
+     *  @return false if the event loop is exiting and handling must stop
+     */
+    bool handleCompletion(const Completion& completion, size_t& handled);
+
+    /** @brief Take the provided buffer the kernel filled and put a fresh one
+     *         from the pool in its place in the ring
+     */
+    BufferPool::Buffer takeBuffer(uint16_t bid);
+
+    /** @brief Account a wakeup which handled the given number of messages */
+    void record(size_t handled);
+
+    Framing framing;
+
+    /** @brief The ring is only touched from the event loop, sendMsg() is
+     *         const in the Handler interface and queues submissions too
+     */
+    mutable io_uring ring{};
+
+    unsigned ringEntries;
+    size_t rxBufferSize;
+    BufferPool rxPool;
+    io_uring_buf_ring* bufRing = nullptr;
+    std::vector<BufferPool::Buffer> rxBuffers;
+
+    std::vector<std::unique_ptr<Socket>> sockets;
+
+    /** @brief AF_MCTP socket with the InKernel framing */
+    int inKernelFd = -1;
+    int inKernelSendBufferSize = 0;
+
+    /** @brief Demux daemon sockets by abstract socket name, with their send
+     *         buffer size
+     */
+    std::map<std::vector<uint8_t>, std::pair<int, int>> demuxSockets;
+
+    mutable BufferPool sendPool;
+    mutable std::vector<SendSlot> sendSlots;
+    mutable std::vector<uint32_t> freeSendSlots;
+
+    std::unique_ptr<IO> ringIo;
+
+    /** @brief Submits the queued sends at the end of the loop iteration */
+    std::unique_ptr<sdeventplus::source::Defer> flushSource;
+
+    ReceiveStats stats;
+    mutable IoUringStats uringStats;
+};
+
+} // namespace mctp_socket
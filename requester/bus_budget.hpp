@@ -0,0 +1,220 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace requester
+{
+
+/** @struct BusBudgetStats
+ *
+ *  Counters of a BusBudget. deferred counts the times an EID had to wait
+ *  for its turn on the bus.
+ */
+struct BusBudgetStats
+{
+    uint64_t requests = 0;
+    uint64_t bytes = 0;
+    uint64_t deferred = 0;
+};
+
+/** @class BusBudget
+ *
+ *  Request rate and bandwidth budget of a bus shared by several EIDs, as a
+ *  pair of token buckets. The buckets refill continuously and hold the budget
+ *  of burstWindow, so a request larger than that is sent once the bucket is
+ *  full and puts it in debt. A zero rate does not limit.
+ */
+class BusBudget
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::milliseconds burstWindow{100};
+
+    /** @brief Constructor
+     *
+     *  @param[in] requestsPerSecond - request rate of the bus, 0 unlimited
+     *  @param[in] bytesPerSecond - request bytes per second, 0 unlimited
+     *  @param[in] now - time the buckets start full
+     */
+    BusBudget(uint32_t requestsPerSecond, uint32_t bytesPerSecond,
+              Clock::time_point now = Clock::now()) :
+        requests(requestsPerSecond), bytes(bytesPerSecond), last(now)
+    {}
+
+    bool isLimited() const
+    {
+        return requests.rate || bytes.rate;
+    }
+
+    /** @brief Take the budget of a request if both buckets afford it
+     *
+     *  @param[in] size - size of the request message in bytes
+     *  @param[in] now - current time
+     *
+     *  @return true if the request may be sent now
+     */
+    bool tryAcquire(size_t size, Clock::time_point now)
+    {
+        refill(now);
+        if (!requests.affords(1) || !bytes.affords(size))
+        {
+            return false;
+        }
+        requests.take(1);
+        bytes.take(size);
+        stats.requests++;
+        stats.bytes += size;
+        return true;
+    }
+
+    /** @brief Give back the budget taken by tryAcquire() for a request which
+     *         was not sent after all
+     *
+     *  @param[in] size - size of the request message in bytes
+     */
+    void refund(size_t size)
+    {
+        requests.give(1);
+        bytes.give(size);
+        stats.requests--;
+        stats.bytes -= size;
+    }
+
+    /** @brief Get the time until tryAcquire() affords a request
+     *
+     *  @param[in] size - size of the request message in bytes
+     *  @param[in] now - current time
+     */
+    Clock::duration getDelay(size_t size, Clock::time_point now)
+    {
+        refill(now);
+        return std::max(requests.delay(1), bytes.delay(size));
+    }
+
+    /** @brief Account an EID which has to wait for the budget */
+    void onDeferred()
+    {
+        stats.deferred++;
+    }
+
+    const BusBudgetStats& getStats() const
+    {
+        return stats;
+    }
+
+  private:
+    /** @brief Token bucket counting micro-units, so that a rate of units
+     *         per second refills rate tokens per microsecond
+     */
+    struct Bucket
+    {
+        explicit Bucket(uint32_t rate) :
+            rate(rate), capacity(std::max<int64_t>(
+                            static_cast<int64_t>(rate) * burstWindow.count() *
+                                1000,
+                            unit)),
+            tokens(capacity)
+        {}
+
+        static constexpr int64_t unit = 1'000'000;
+
+        bool affords(size_t count) const
+        {
+            return !rate ||
+                   tokens >= std::min(static_cast<int64_t>(count) * unit,
+                                      capacity);
+        }
+
+        void take(size_t count)
+        {
+            if (rate)
+            {
+                tokens -= static_cast<int64_t>(count) * unit;
+            }
+        }
+
+        void give(size_t count)
+        {
+            if (rate)
+            {
+                tokens = std::min(tokens + static_cast<int64_t>(count) * unit,
+                                  capacity);
+            }
+        }
+
+        void refill(int64_t elapsedInUsec)
+        {
+            if (!rate)
+            {
+                return;
+            }
+            // compare before multiplying, a long idle time would overflow
+            auto missing = capacity - tokens;
+            if (elapsedInUsec >= (missing + rate - 1) / rate)
+            {
+                tokens = capacity;
+                return;
+            }
+            tokens += elapsedInUsec * rate;
+        }
+
+        Clock::duration delay(size_t count) const
+        {
+            auto needed = std::min(static_cast<int64_t>(count) * unit,
+                                   capacity) -
+                          tokens;
+            if (!rate || needed <= 0)
+            {
+                return Clock::duration::zero();
+            }
+            return std::chrono::microseconds((needed + rate - 1) / rate);
+        }
+
+        int64_t rate;
+        int64_t capacity;
+        int64_t tokens;
+    };
+
+    void refill(Clock::time_point now)
+    {
+        if (now <= last)
+        {
+            return;
+        }
+        auto elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(now - last)
+                .count();
+        requests.refill(elapsed);
+        bytes.refill(elapsed);
+        // keep the fraction of a microsecond for the next refill
+        last += std::chrono::microseconds(elapsed);
+    }
+
+    Bucket requests;
+    Bucket bytes;
+    Clock::time_point last;
+    BusBudgetStats stats;
+};
+
+} // namespace requester
@@ -0,0 +1,179 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace requester
+{
+
+/** @class CircuitBreaker
+ *
+ *  Availability of an endpoint derived from the outcome of its requests.
+ *  After a number of consecutive instance ID expiries the breaker opens and
+ *  requests to the endpoint fail immediately. While open, the endpoint is
+ *  probed with an exponential backoff and the breaker closes on the first
+ *  response, to a probe or to a request still in flight.
+ */
+class CircuitBreaker
+{
+  public:
+    enum class State : uint8_t
+    {
+        Closed,   //!< requests are sent
+        Open,     //!< requests fail, waiting for the next probe
+        HalfOpen, //!< requests fail, a probe is in flight
+    };
+
+    /** @brief Constructor
+     *
+     *  @param[in] threshold - consecutive expiries opening the breaker, 0
+     * never opens it
+     *  @param[in] minProbeInterval - delay of the first probe
+     *  @param[in] maxProbeInterval - upper bound of the probe delay
+     */
+    CircuitBreaker(uint8_t threshold,
+                   std::chrono::milliseconds minProbeInterval,
+                   std::chrono::milliseconds maxProbeInterval) :
+        threshold(threshold),
+        minProbeInterval(minProbeInterval),
+        maxProbeInterval(std::max(minProbeInterval, maxProbeInterval)),
+        probeInterval(minProbeInterval)
+    {}
+
+    /** @brief Account a request which expired without response
+     *
+     *  @return true if the breaker opened
+     */
+    bool onTimeout()
+    {
+        if (consecutiveTimeouts < UINT8_MAX)
+        {
+            consecutiveTimeouts++;
+        }
+        if (state != State::Closed || !threshold ||
+            consecutiveTimeouts < threshold)
+        {
+            return false;
+        }
+        state = State::Open;
+        probeInterval = minProbeInterval;
+        openCount++;
+        return true;
+    }
+
+    /** @brief Account a response of the endpoint
+     *
+     *  @return true if the breaker closed
+     */
+    bool onResponse()
+    {
+        consecutiveTimeouts = 0;
+        if (state == State::Closed)
+        {
+            return false;
+        }
+        state = State::Closed;
+        closeCount++;
+        return true;
+    }
+
+    /** @brief Mark a probe as sent, the next probe waits twice as long */
+    void onProbe()
+    {
+        state = State::HalfOpen;
+        probeCount++;
+        probeInterval = std::min(probeInterval * 2, maxProbeInterval);
+    }
+
+    /** @brief Mark a probe as failed, the breaker waits for the next one */
+    void onProbeFailure()
+    {
+        if (state == State::HalfOpen)
+        {
+            state = State::Open;
+        }
+    }
+
+    /** @brief Check whether requests to the endpoint are sent */
+    bool isClosed() const
+    {
+        return state == State::Closed;
+    }
+
+    State getState() const
+    {
+        return state;
+    }
+
+    /** @brief Get the delay before the next probe */
+    std::chrono::milliseconds getProbeInterval() const
+    {
+        return probeInterval;
+    }
+
+    uint8_t getConsecutiveTimeouts() const
+    {
+        return consecutiveTimeouts;
+    }
+
+    uint64_t getOpenCount() const
+    {
+        return openCount;
+    }
+
+    uint64_t getCloseCount() const
+    {
+        return closeCount;
+    }
+
+    uint64_t getProbeCount() const
+    {
+        return probeCount;
+    }
+
+    static constexpr std::string_view toString(State state)
+    {
+        switch (state)
+        {
+            case State::Closed:
+                return "Closed";
+            case State::Open:
+                return "Open";
+            case State::HalfOpen:
+                return "HalfOpen";
+        }
+        return "Unknown";
+    }
+
+  private:
+    uint8_t threshold;
+    std::chrono::milliseconds minProbeInterval;
+    std::chrono::milliseconds maxProbeInterval;
+    std::chrono::milliseconds probeInterval;
+
+    State state = State::Closed;
+    uint8_t consecutiveTimeouts = 0;
+    uint64_t openCount = 0;
+    uint64_t closeCount = 0;
+    uint64_t probeCount = 0;
+};
+
+} // namespace requester
@@ -20,33 +20,48 @@
 #include "config.h"
 
 #include "libnsm/base.h"
+#include "libnsm/device-capability-discovery.h"
 #include "libnsm/requester/mctp.h"
 
+#include "bus_budget.hpp"
+#include "circuit_breaker.hpp"
 #include "common/types.hpp"
 #include "dBusAsyncUtils.hpp"
 #include "nsmd/instance_id.hpp"
 #include "nsmd/socket_manager.hpp"
 #include "request.hpp"
+#include "request_pool.hpp"
+#include "request_queue.hpp"
 #include "request_timeout_tracker.hpp"
+#include "rtt_estimator.hpp"
+#include "run_queue.hpp"
+#include "timer_wheel.hpp"
 
 #include <function2/function2.hpp>
 #include <phosphor-logging/lg2.hpp>
-#include <sdbusplus/timer.hpp>
 #include <sdeventplus/event.hpp>
-#include <sdeventplus/source/event.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <chrono>
+#include <cstring>
+#include <deque>
+#include <functional>
 #include <memory>
-#include <queue>
-#include <tuple>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace requester
 {
 
+/** @brief Handler of a NSM response. The response is reference counted, a
+ *  handler may keep it beyond the call without copying it.
+ */
 using ResponseHandler = fu2::unique_function<void(
-    eid_t eid, const nsm_msg* response, size_t respMsgLen)>;
+    eid_t eid, std::shared_ptr<const nsm_msg> response, size_t respMsgLen)>;
 
 /** @class Handler
  *
@@ -57,22 +72,156 @@ using ResponseHandler = fu2::unique_function<void(
  *  received within the instance ID expiration interval or any other failure the
  *  response handler is invoked with the empty response.
  *
+ *  Up to maxOutstandingRequests requests are kept in flight per EID. Requests
+ *  beyond that window wait in the per-EID queue, and responses are matched to
+ *  their request through the (EID, instance ID) pair. Queued requests are
+ *  sent in strict priority of their RequestClass, so user initiated requests
+ *  do not wait behind a backlog of telemetry.
+ *
+ *  The retry timeout of a request is derived from the round trip times
+ *  measured for its EID and command, between a configured floor and the
+ *  configured response timeout, and the instance ID expiry interval covers
+ *  the resulting retries.
+ *
+ *  Each EID has a CircuitBreaker. Once it opens after consecutive instance ID
+ *  expiries, queued and new requests to the EID fail immediately with
+ *  NSM_SW_ERROR_UNAVAILABLE and the EID is probed with a ping until it
+ *  responds.
+ *
+ *  A request identical to one pending or in flight to the same EID, apart
+ *  from the instance ID, is not sent again. Its response handler is attached
+ *  to the pending request and receives the same response. A request only
+ *  attaches to a queued request of the same or a higher class, so it never
+ *  waits behind lower class requests. User initiated requests, which may have
+ *  side effects, are always sent.
+ *
+ *  Coroutines awaiting a response are resumed from the RunQueue of the
+ *  handler rather than from the I/O callback which delivered the response.
+ *
+ *  Every registered request, including one attached to an identical pending
+ *  request, takes a slot from the RequestPool of its EID. The slot holds the
+ *  request, its response handler and its instance ID expiry timer, and is
+ *  recycled once the request completes, so the steady state request path
+ *  does not allocate.
+ *
  * @tparam RequestInterface - Request class type
  */
 template <class RequestInterface>
 class Handler
 {
   private:
-    /** @brief Container for storing the details of the NSM request
-     *         message, handler for the corresponding NSM response, the
-     *         timer object for the Instance ID expiration and valid flag
+    /** @struct Slot
+     *
+     *  Pooled entry of a request: the NSM request message, the handler for
+     *  the corresponding NSM response and the timer of the instance ID
+     *  expiration. A slot attached to an identical pending request only
+     *  holds its response handler.
+     */
+    struct Slot
+    {
+        Slot(Handler& handler, eid_t eid) :
+            eid(eid),
+            expiryTimer(handler.timerWheel, [&handler, this] {
+            handler.instanceIdExpiryCallBack(*this);
+        })
+        {}
+
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+
+        eid_t eid;
+        std::optional<RequestInterface> request;
+        ResponseHandler responseHandler;
+        TimerWheel::Timer expiryTimer;
+        RequestClass requestClass = RequestClass::RoundRobin;
+        std::chrono::steady_clock::time_point enqueued;
+        bool coalescable = false; //!< identical requests may attach to it
+        bool pooled = true;       //!< false for a heap slot of the pool
+        Slot* next = nullptr;     //!< free list, queue or follower link
+        Slot* followers = nullptr; //!< requests attached to this one
+        size_t hash = 0;           //!< hash of a coalescable request
+        Slot* nextPending = nullptr; //!< link in its pending index bucket
+    };
+
+    using RequestQueue = ClassedRequestQueue<Slot>;
+
+    /** @brief Number of buckets of the pending request index of an EID, a
+     *         power of two
      */
-    using RequestValue =
-        std::tuple<std::unique_ptr<RequestInterface>, ResponseHandler,
-                   std::unique_ptr<sdbusplus::Timer>, bool>;
-    using RequestQueue = std::queue<RequestValue>;
+    static constexpr size_t pendingBuckets = 32;
+
+    /** @struct Bus
+     *
+     *  Budget of a bus shared by several EIDs. The EIDs whose requests wait
+     *  for the budget are served in turns, one request each, once the timer
+     *  tells the budget has refilled.
+     */
+    struct Bus
+    {
+        Bus(Handler& handler, uint32_t requestsPerSecond,
+            uint32_t bytesPerSecond) :
+            budget(requestsPerSecond, bytesPerSecond),
+            timer(handler.timerWheel, [&handler, this] {
+            handler.serveBus(*this);
+        })
+        {}
+
+        Bus(const Bus&) = delete;
+        Bus& operator=(const Bus&) = delete;
+
+        BusBudget budget;
+        std::deque<eid_t> waiting;
+        TimerWheel::Timer timer;
+    };
+
+    /** @brief Requests of an EID: the slot pool, the requests waiting for a
+     *         free slot in the window, the requests in flight, indexed by
+     *         instance ID, and the circuit breaker with the timer of its next
+     *         probe
+     */
+    struct Endpoint
+    {
+        Endpoint(Handler& handler, eid_t eid) :
+            eid(eid),
+            breaker(CIRCUIT_BREAKER_THRESHOLD,
+                    std::chrono::milliseconds(
+                        CIRCUIT_BREAKER_PROBE_INTERVAL_MIN),
+                    std::chrono::milliseconds(
+                        CIRCUIT_BREAKER_PROBE_INTERVAL_MAX)),
+            probeTimer(handler.timerWheel, [&handler, this] {
+            handler.sendProbe(*this);
+        })
+        {}
+
+        Endpoint(const Endpoint&) = delete;
+        Endpoint& operator=(const Endpoint&) = delete;
+
+        eid_t eid;
+        RequestPool<Slot> pool{REQUEST_SLOTS_PER_EID};
+        RequestQueue queue;
+        std::array<Slot*, NSM_INSTANCE_MAX + 1> outstanding{};
+        size_t numOutstanding = 0;
+        Bus* bus = nullptr;         //!< nullptr if the bus is not limited
+        bool waitingForBus = false; //!< the EID waits in Bus::waiting
+        CircuitBreaker breaker;
+        TimerWheel::Timer probeTimer;
+        /** @brief Coalescable requests queued or in flight, chained by hash
+         */
+        std::array<Slot*, pendingBuckets> pending{};
+    };
 
   public:
+    /** @brief Callback invoked when the circuit breaker of an EID is created
+     *         or changes
+     */
+    using CircuitStateHandler =
+        std::function<void(eid_t eid, const CircuitBreaker& breaker)>;
+
+    /** @brief Upper bound of the per-EID request window, one request per NSM
+     *         instance ID
+     */
+    static constexpr uint8_t maxRequestWindow = NSM_INSTANCE_MAX + 1;
+
     Handler() = delete;
     Handler(const Handler&) = delete;
     Handler(Handler&&) = delete;
@@ -86,10 +235,16 @@ class Handler
      *  @param[in] instanceIdDb - reference to instance id allocator
      *  @param[in] sockManager - MCTP socket manager
      *  @param[in] verbose - verbose tracing flag
-     *  @param[in] instanceIdExpiryInterval - instance ID expiration interval
+     *  @param[in] instanceIdExpiryInterval - upper bound of the instance ID
+     * expiration interval
      *  @param[in] numRetries - number of request retries which is in addition
      * to the first attempt
-     *  @param[in] responseTimeOut - time to wait between each retry
+     *  @param[in] responseTimeOut - upper bound and initial value of the time
+     * to wait between each retry
+     *  @param[in] maxOutstandingRequests - number of requests allowed in
+     * flight per EID, clamped to [1, maxRequestWindow]
+     *  @param[in] minResponseTimeOut - lower bound of the time to wait
+     * between each retry
      */
     explicit Handler(
         sdeventplus::Event& event, nsm::InstanceIdDb& instanceIdDb,
@@ -98,102 +253,24 @@ class Handler
             std::chrono::seconds(INSTANCE_ID_EXPIRATION_INTERVAL),
         uint8_t numRetries = static_cast<uint8_t>(NUMBER_OF_REQUEST_RETRIES),
         std::chrono::milliseconds responseTimeOut =
-            std::chrono::milliseconds(RESPONSE_TIME_OUT)) :
+            std::chrono::milliseconds(RESPONSE_TIME_OUT),
+        uint8_t maxOutstandingRequests =
+            static_cast<uint8_t>(MAX_OUTSTANDING_REQUESTS_PER_EID),
+        std::chrono::milliseconds minResponseTimeOut =
+            std::chrono::milliseconds(RESPONSE_TIME_OUT_MIN)) :
         event(event),
-        instanceIdDb(instanceIdDb), sockManager(sockManager), verbose(verbose),
+        timerWheel(event), runQueue(event, RUN_QUEUE_BATCH_SIZE),
+        instanceIdDb(instanceIdDb), sockManager(sockManager),
+        verbose(verbose),
         instanceIdExpiryInterval(instanceIdExpiryInterval),
         numRetries(numRetries), responseTimeOut(responseTimeOut),
+        maxOutstandingRequests(std::clamp<uint8_t>(maxOutstandingRequests, 1,
+                                                   maxRequestWindow)),
+        timeoutPolicy(minResponseTimeOut, responseTimeOut,
+                      instanceIdExpiryInterval),
         socketHandler(nullptr)
     {}
 
-    int registerRequestImpl(
-        uint8_t tag, eid_t eid, uint8_t type, uint8_t command,
-        std::vector<uint8_t>&& requestMsg, ResponseHandler&& responseHandler,
-        std::unordered_map<eid_t, RequestQueue>& handlers,
-        std::unordered_map<eid_t, std::unique_ptr<sdbusplus::Timer>>&
-            timerToFree,
-        std::chrono::milliseconds responseTimeOut,
-        std::chrono::seconds instanceIdExpiryInterval)
-    {
-        auto instanceIdExpiryCallBack = [eid, type, command, &handlers,
-                                         &timerToFree, instanceIdExpiryInterval,
-                                         this](void) {
-            if (handlers.contains(eid) && !handlers[eid].empty())
-            {
-                auto& [request, responseHandler, timerInstance,
-                       valid] = handlers[eid].front();
-
-                // Note1: timeOutTracker object can be updated through
-                // TimeoutEvent or a succesfull responseMsg, for  handling
-                // please refer handleResponse as well.
-
-                // Note2: timeoutTracker code should be above request->stop() or
-                // any operation that can change requestMsg as part of cleanup
-                nsm::DeviceRequestTimeOutTracker& timeoutTracker =
-                    nsm::TimeOutTracker::getInstance().getDeviceTimeOutTracker(
-                        eid);
-                std::string msg = request->requestMsgToString();
-                timeoutTracker.handleTimeout(msg);
-
-                request->stop();
-                auto rc = timerInstance->stop();
-                if (rc)
-                {
-                    lg2::error(
-                        "Failed to stop the instance ID expiry timer. RC={RC}",
-                        "RC", rc);
-                }
-
-                // Defer to remove expired timer and run queued request
-                // the timerInstance callback cannot free timerInstance itself
-                timerToFree[eid] = std::move(timerInstance);
-                this->removeRequestContainer[eid] =
-                    std::make_unique<sdeventplus::source::Defer>(
-                        event,
-                        std::bind(&Handler::removeRequestEntry, this, eid,
-                                  std::ref(handlers), std::ref(timerToFree),
-                                  instanceIdExpiryInterval));
-
-                // Call responseHandler after erase it from the handlers to
-                // avoid starting the same request again in
-                // runRegisteredRequest()
-                auto unique_handler = std::move(responseHandler);
-
-                instanceIdDb.free(eid, request->getInstanceId());
-                handlers[eid].pop();
-
-                // Call response handler with an empty response to indicate
-                // no response
-                unique_handler(eid, nullptr, 0);
-            }
-            else
-            {
-                // This condition is not possible, if a response is received
-                // before the instance ID expiry, then the response handler
-                // is executed and the entry will be removed.
-                assert(false);
-            }
-        };
-
-        if (requestMsg.size() >
-            static_cast<size_t>(sockManager.getSendBufferSize(eid)))
-        {
-            sockManager.setSendBufferSize(sockManager.getSocket(eid),
-                                          requestMsg.size());
-        }
-
-        auto request = std::make_unique<RequestInterface>(
-            sockManager.getSocket(eid), eid, tag, event, socketHandler,
-            std::move(requestMsg), numRetries, responseTimeOut, verbose);
-        auto timer = std::make_unique<sdbusplus::Timer>(
-            event.get(), instanceIdExpiryCallBack);
-
-        handlers[eid].emplace(std::make_tuple(std::move(request),
-                                              std::move(responseHandler),
-                                              std::move(timer), true));
-        return runRegisteredRequest(eid, handlers, instanceIdExpiryInterval);
-    }
-
     /** @brief Register a NSM request message
      *
      *  @param[in] tag - MCTP message tag of the request
@@ -202,74 +279,113 @@ class Handler
      *  @param[in] command - NSM command
      *  @param[in] requestMsg - NSM request message
      *  @param[in] responseHandler - Response handler for this request
+     *  @param[in] requestClass - class of the request, defaults to the
+     * current request class
      *
-     *  @return return NSM_SUCCESS on success and NSM_ERROR otherwise
+     *  @return return NSM_SUCCESS on success, NSM_SW_ERROR_UNAVAILABLE if
+     *          the circuit breaker of the EID is open and NSM_ERROR otherwise
      */
     int registerRequest(uint8_t tag, eid_t eid, uint8_t type, uint8_t command,
                         std::vector<uint8_t>&& requestMsg,
-                        ResponseHandler&& responseHandler)
+                        ResponseHandler&& responseHandler,
+                        RequestClass requestClass = currentRequestClass())
     {
-        return registerRequestImpl(
-            tag, eid, type, command, std::move(requestMsg),
-            std::move(responseHandler), handlers, timerToFree, responseTimeOut,
-            instanceIdExpiryInterval);
+        return registerMessage(tag, eid, type, command, std::move(requestMsg),
+                               std::move(responseHandler), requestClass);
     }
 
-    int runRegisteredRequest(eid_t eid,
-                             std::unordered_map<eid_t, RequestQueue>& handlers,
-                             std::chrono::seconds instanceIdExpiryInterval)
+    /** @brief Register a NSM request sent from a shared request template
+     *
+     *  The template is sent without being copied nor written to, the
+     *  transport sends it with the instance ID of the request. The other
+     *  parameters and the return value are the same as for the request
+     *  message overload.
+     */
+    int registerRequest(uint8_t tag, eid_t eid, uint8_t type, uint8_t command,
+                        RequestTemplate requestTemplate,
+                        ResponseHandler&& responseHandler,
+                        RequestClass requestClass = currentRequestClass())
     {
-        if (handlers[eid].empty())
+        if (!requestTemplate)
         {
-            return NSM_SUCCESS;
+            return NSM_SW_ERROR_NULL;
         }
+        return registerMessage(tag, eid, type, command,
+                               std::move(requestTemplate),
+                               std::move(responseHandler), requestClass);
+    }
 
-        auto& [request, responseHandler, timerInstance,
-               valid] = handlers[eid].front();
-
-        if (timerInstance->isRunning())
+    /** @brief Send queued requests of the EID while the window and the
+     *         budget of its bus allow it
+     *
+     *  @param[in] eid - endpoint ID of the remote MCTP endpoint
+     */
+    void runRegisteredRequest(eid_t eid)
+    {
+        if (!endpoints[eid])
         {
-            // A NSM request for the EID is running
-            return NSM_SUCCESS;
+            return;
         }
+        auto& endpoint = *endpoints[eid];
 
-        try
+        while (!endpoint.queue.empty() &&
+               endpoint.numOutstanding < maxOutstandingRequests &&
+               admit(endpoint,
+                     endpoint.queue.front().request->getMessage().size()))
         {
-            // get instance_id from pool
-            auto instanceId = instanceIdDb.next(eid);
-            request->setInstanceId(instanceId);
-        }
-        catch (const std::exception& e)
-        {
-            lg2::error("Error while get MCTP instanceId for EID={EID}, {ERROR}",
-                       "EID", eid, "ERROR", e);
-            return NSM_ERROR;
+            if (!sendNext(endpoint))
+            {
+                return;
+            }
         }
+    }
 
-        auto rc = request->start();
-        if (rc)
+    /** @brief Assign an EID to a bus. The EIDs of a bus share its request
+     *         rate and bandwidth budget and take turns once it is exhausted.
+     *
+     *  @param[in] eid - endpoint ID of the remote MCTP endpoint
+     *  @param[in] busId - identifier of the bus
+     *  @param[in] requestsPerSecond - request rate of the bus, 0 unlimited
+     *  @param[in] bytesPerSecond - request bytes per second of the bus, 0
+     * unlimited
+     *
+     *  The budget is set by the first EID assigned to the bus. An EID of a
+     *  bus without any limit is not accounted at all.
+     */
+    void setEndpointBus(eid_t eid, const std::string& busId,
+                        uint32_t requestsPerSecond, uint32_t bytesPerSecond)
+    {
+        auto& endpoint = getEndpoint(eid);
+        if (endpoint.waitingForBus)
         {
-            instanceIdDb.free(eid, request->getInstanceId());
-            lg2::error("Failure to send the NSM request message");
-            return rc;
+            std::erase(endpoint.bus->waiting, eid);
+            endpoint.waitingForBus = false;
         }
+        endpoint.bus = nullptr;
 
-        try
-        {
-            timerInstance->start(duration_cast<std::chrono::microseconds>(
-                instanceIdExpiryInterval));
-        }
-        catch (const std::runtime_error& e)
+        if (requestsPerSecond || bytesPerSecond)
         {
-            instanceIdDb.free(eid, request->getInstanceId());
-            lg2::error("Failed to start the instance ID expiry timer.", "ERROR",
-                       e);
-            return NSM_ERROR;
+            auto& bus = buses[busId];
+            if (!bus)
+            {
+                bus = std::make_unique<Bus>(*this, requestsPerSecond,
+                                            bytesPerSecond);
+            }
+            endpoint.bus = bus.get();
         }
-
-        return NSM_SUCCESS;
+        runRegisteredRequest(eid);
     }
 
+    /** @brief Get the budget counters of a bus
+     *
+     *  @return nullptr if no EID was assigned to a limited bus of that
+     *          identifier
+     */
+    const BusBudgetStats* getBusBudgetStats(const std::string& busId) const
+    {
+        auto it = buses.find(busId);
+        return it == buses.end() ? nullptr : &it->second->budget.getStats();
+    }
     /** @brief Handle NSM response message
      *
      *  @param[in] tag - MCTP message tag of the response
@@ -279,16 +395,17 @@ class Handler
      *  @param[in] command - NSM command
      *  @param[in] response - NSM response message
      *  @param[in] respMsgLen - length of the response message
+     *  @param[in] received - time the response was received, now if unset
      */
     void handleResponse(uint8_t tag, eid_t eid, uint8_t instanceId,
                         [[maybe_unused]] uint8_t type,
                         [[maybe_unused]] uint8_t command,
-                        const nsm_msg* response, size_t respMsgLen)
+                        const std::shared_ptr<const nsm_msg>& response,
+                        size_t respMsgLen,
+                        TimerWheel::Clock::time_point received = {})
     {
-        // Check if response is for Regular request
-        auto requestFound = handleResponseImpl(eid, instanceId, type, command,
-                                               response, respMsgLen, handlers,
-                                               instanceIdExpiryInterval);
+        auto requestFound = handleResponseImpl(eid, instanceId, response,
+                                               respMsgLen, received);
 
         if (!requestFound)
         {
@@ -299,62 +416,256 @@ class Handler
     }
 
     bool handleResponseImpl(eid_t eid, uint8_t instanceId,
-                            [[maybe_unused]] uint8_t type,
-                            [[maybe_unused]] uint8_t command,
-                            const nsm_msg* response, size_t respMsgLen,
-                            std::unordered_map<eid_t, RequestQueue>& handlers,
-                            std::chrono::seconds instanceIdExpiryInterval)
+                            const std::shared_ptr<const nsm_msg>& response,
+                            size_t respMsgLen,
+                            TimerWheel::Clock::time_point received = {})
     {
         bool requestFound{false};
 
-        if (handlers.contains(eid) && !handlers[eid].empty())
+        auto entry = endpoints[eid].get();
+        auto slot = entry && instanceId <= NSM_INSTANCE_MAX
+                        ? entry->outstanding[instanceId]
+                        : nullptr;
+        if (slot)
         {
-            auto& [request, responseHandler, timerInstance,
-                   valid] = handlers[eid].front();
-            if (request->getInstanceId() == instanceId)
+            auto& endpoint = *entry;
+            auto& request = slot->request;
+
+            // The flight recorder is updated either here or in
+            // instanceIdExpiryCallBack
+            if (received == TimerWheel::Clock::time_point{})
+            {
+                received = TimerWheel::Clock::now();
+            }
+            auto latency = std::chrono::duration_cast<RttEstimator::Duration>(
+                received - request->getSendTime());
+            nsm::TimeOutTracker::getInstance()
+                .getDeviceTimeOutTracker(eid)
+                .handleNoTimeout(request->getMessageType(),
+                                 request->getCommand(), instanceId, latency);
+
+            // Only a request sent once gives an unambiguous round trip time
+            if (!request->isRetransmitted())
             {
-                // Note1: timeOutTracker can be updated through TimeoutEvent or
-                // a succesfull responseMsg, for better handling please refer
-                // instanceIdExpiryCallBack as well
-
-                // Note2: timeoutTracker code should be above request->stop() or
-                // any operation that can change requestMsg as part of cleanup
-                nsm::DeviceRequestTimeOutTracker& timeoutTracker =
-                    nsm::TimeOutTracker::getInstance().getDeviceTimeOutTracker(
-                        eid);
-                std::string msg = request->requestMsgToString();
-                timeoutTracker.handleNoTimeout(msg);
-
-                request->stop();
-                auto rc = timerInstance->stop();
-                if (rc)
-                {
-                    lg2::error(
-                        "Failed to stop the instance ID expiry timer. RC={RC}",
-                        "RC", rc);
-                }
-                // Call responseHandler after erase it from the handlers to
-                // avoid starting it again in runRegisteredRequest()
-                auto unique_handler = std::move(responseHandler);
-                instanceIdDb.free(eid, request->getInstanceId());
-                handlers[eid].pop();
-                unique_handler(eid, response, respMsgLen);
-                requestFound = true;
+                timeoutPolicy.addSample(eid, request->getMessageType(),
+                                        request->getCommand(), latency);
             }
+
+            request->stop();
+            slot->expiryTimer.stop();
+            // Call responseHandler after erase it from the outstanding
+            // requests, the handler may register the next request to the EID
+            instanceIdDb.free(eid, instanceId);
+            endpoint.outstanding[instanceId] = nullptr;
+            endpoint.numOutstanding--;
+            onEndpointResponse(endpoint);
+            complete(endpoint, *slot, response, respMsgLen);
+            requestFound = true;
         }
 
-        runRegisteredRequest(eid, handlers, instanceIdExpiryInterval);
+        runRegisteredRequest(eid);
 
         return requestFound;
     }
 
+    /** @brief Fail a request in flight whose message could not be sent,
+     *         without waiting for its retries and instance ID expiry
+     *
+     *  @param[in] eid - endpoint ID of the remote MCTP endpoint
+     *  @param[in] instanceId - instance ID of the request
+     */
+    void handleSendFailure(eid_t eid, uint8_t instanceId)
+    {
+        auto entry = endpoints[eid].get();
+        auto slot = entry && instanceId <= NSM_INSTANCE_MAX
+                        ? entry->outstanding[instanceId]
+                        : nullptr;
+        if (!slot)
+        {
+            return;
+        }
+
+        auto& endpoint = *entry;
+        slot->request->stop();
+        slot->expiryTimer.stop();
+        instanceIdDb.free(eid, instanceId);
+        endpoint.outstanding[instanceId] = nullptr;
+        endpoint.numOutstanding--;
+        complete(endpoint, *slot, nullptr, 0);
+
+        runRegisteredRequest(eid);
+    }
+
     void setSocketHandler(const mctp_socket::Handler* handler)
     {
         socketHandler = handler;
     }
 
+    /** @brief Get the number of requests in flight to the EID
+     *
+     *  @param[in] eid - endpoint ID of the remote MCTP endpoint
+     *
+     *  @return number of outstanding requests
+     */
+    size_t getNumOutstandingRequests(eid_t eid) const
+    {
+        return endpoints[eid] ? endpoints[eid]->numOutstanding : 0;
+    }
+
+    /** @brief Get the number of requests queued behind the window of the EID
+     *
+     *  @param[in] eid - endpoint ID of the remote MCTP endpoint
+     *
+     *  @return number of queued requests
+     */
+    size_t getNumQueuedRequests(eid_t eid) const
+    {
+        return endpoints[eid] ? endpoints[eid]->queue.size() : 0;
+    }
+
+    /** @brief Get the statistics of the request slot pool of the EID
+     *
+     *  @param[in] eid - endpoint ID of the remote MCTP endpoint
+     *
+     *  @return pool statistics, nullptr if no request was sent to the EID
+     */
+    const RequestPoolStats* getRequestPoolStats(eid_t eid) const
+    {
+        return endpoints[eid] ? &endpoints[eid]->pool.getStats() : nullptr;
+    }
+
+    /** @brief Get the queueing statistics of a request class
+     *
+     *  @param[in] requestClass - class of the requests
+     *
+     *  @return statistics accumulated over every EID
+     */
+    const RequestClassStats& getRequestClassStats(RequestClass requestClass) const
+    {
+        return classStats[static_cast<size_t>(requestClass)];
+    }
+
+    /** @brief Log the queueing statistics of every request class, on demand
+     *         through the LogDump D-Bus method
+     */
+    void logRequestClassStats() const
+    {
+        static constexpr std::array<const char*, numRequestClasses> names{
+            "User", "Priority", "RoundRobin", "Background"};
+        for (size_t i = 0; i < numRequestClasses; i++)
+        {
+            const auto& stats = classStats[i];
+            lg2::error(
+                "logRequestClassStats: CLASS={CLASS}, REQUESTS={REQUESTS}, "
+                "QUEUED={QUEUED}, AVGDELAY={AVG}us, MAXDELAY={MAX}us",
+                "CLASS", names[i], "REQUESTS", stats.requests, "QUEUED",
+                stats.queued, "AVG", stats.averageDelay().count(), "MAX",
+                stats.maxDelay.count());
+        }
+    }
+
+    /** @brief Get the current retry timeout of a command
+     *
+     *  @param[in] eid - endpoint ID of the remote MCTP endpoint
+     *  @param[in] type - NVIDIA message type
+     *  @param[in] command - NSM command
+     *
+     *  @return time to wait before the first retry
+     */
+    std::chrono::milliseconds getResponseTimeOut(eid_t eid, uint8_t type,
+                                                 uint8_t command) const
+    {
+        return timeoutPolicy.timeout(eid, type, command);
+    }
+
+    /** @brief Get the round trip time estimate of the EID
+     *
+     *  @param[in] eid - endpoint ID of the remote MCTP endpoint
+     *
+     *  @return estimator, nullptr if no request was completed yet
+     */
+    const RttEstimator* getRttEstimator(eid_t eid) const
+    {
+        return timeoutPolicy.getEstimator(eid);
+    }
+
+    /** @brief Get the number of requests which were attached to an identical
+     *         pending request instead of being sent
+     */
+    uint64_t getNumCoalescedRequests() const
+    {
+        return numCoalescedRequests;
+    }
+
+    /** @brief Check whether requests to the EID are sent, i.e. its circuit
+     *         breaker is closed
+     */
+    bool isEndpointAvailable(eid_t eid) const
+    {
+        return !endpoints[eid] || endpoints[eid]->breaker.isClosed();
+    }
+
+    /** @brief Get the circuit breaker of the EID
+     *
+     *  @return circuit breaker, nullptr if no request was sent to the EID
+     */
+    const CircuitBreaker* getCircuitBreaker(eid_t eid) const
+    {
+        return endpoints[eid] ? &endpoints[eid]->breaker : nullptr;
+    }
+
+    /** @brief Close the circuit breaker of the EID, e.g. when the endpoint
+     *         was discovered again
+     */
+    void resetCircuitBreaker(eid_t eid)
+    {
+        if (endpoints[eid])
+        {
+            onEndpointResponse(*endpoints[eid]);
+        }
+    }
+
+    /** @brief Set the observer of the circuit breakers, it is invoked for
+     *         the existing breakers right away
+     */
+    void setCircuitStateHandler(CircuitStateHandler handler)
+    {
+        circuitStateHandler = std::move(handler);
+        for (const auto& endpoint : endpoints)
+        {
+            if (endpoint)
+            {
+                notifyCircuitState(*endpoint);
+            }
+        }
+    }
+
+    /** @brief Get the number of running retry and instance ID expiry timers
+     *
+     *  @return number of active timers on the timing wheel
+     */
+    size_t getNumActiveTimers() const
+    {
+        return timerWheel.getNumActiveTimers();
+    }
+
+    /** @brief Get the executor of the continuations of the responses */
+    RunQueue& getRunQueue()
+    {
+        return runQueue;
+    }
+
   private:
     sdeventplus::Event& event; //!< reference to NSM daemon's main event loop
+
+    /** @brief Timing wheel of the retry and instance ID expiry timers, it
+     *         outlives every request and is destroyed last
+     */
+    TimerWheel timerWheel;
+
+    /** @brief Resumes the coroutines whose response was received */
+    RunQueue runQueue;
+
     nsm::InstanceIdDb& instanceIdDb; //!< reference to instanceIdDb object
     mctp_socket::Manager& sockManager;
 
@@ -364,32 +675,572 @@ class Handler
     uint8_t numRetries;           //!< number of request retries
     std::chrono::milliseconds
         responseTimeOut;          //!< time to wait between each retry
+    uint8_t maxOutstandingRequests; //!< request window per EID
 
-    /** @brief Container for storing the NSM request entries */
-    std::unordered_map<eid_t, RequestQueue> handlers;
+    /** @brief Retry timeouts derived from the measured round trip times */
+    ResponseTimeoutPolicy timeoutPolicy;
 
-    /** @brief Container to store information about the request entries to be
-     *         removed after the instance ID timer expires
+    /** @brief Pooled, queued and in flight NSM requests, indexed by EID so
+     *         the request path does not hash
      */
-    std::unordered_map<eid_t, std::unique_ptr<sdeventplus::source::Defer>>
-        removeRequestContainer;
+    std::array<std::unique_ptr<Endpoint>, 256> endpoints{};
 
-    std::unordered_map<eid_t, std::unique_ptr<sdbusplus::Timer>> timerToFree;
+    /** @brief Queueing statistics per request class */
+    std::array<RequestClassStats, numRequestClasses> classStats{};
 
     const mctp_socket::Handler* socketHandler; // MCTP socket handler
 
-    /** @brief Remove request entry for which the instance ID expired
+    /** @brief Observer of the circuit breakers */
+    CircuitStateHandler circuitStateHandler;
+
+    /** @brief Number of requests attached to a pending request */
+    uint64_t numCoalescedRequests = 0;
+
+    /** @brief Budgets of the limited buses, by bus identifier */
+    std::unordered_map<std::string, std::unique_ptr<Bus>> buses;
+
+    /** @brief Compare two request messages, apart from the instance ID */
+    static bool sameRequest(const std::vector<uint8_t>& lhs,
+                            const std::vector<uint8_t>& rhs)
+    {
+        if (lhs.size() != rhs.size())
+        {
+            return false;
+        }
+        auto lhsHdr = *reinterpret_cast<const nsm_msg_hdr*>(lhs.data());
+        auto rhsHdr = *reinterpret_cast<const nsm_msg_hdr*>(rhs.data());
+        lhsHdr.instance_id = 0;
+        rhsHdr.instance_id = 0;
+        return std::memcmp(&lhsHdr, &rhsHdr, sizeof(nsm_msg_hdr)) == 0 &&
+               std::equal(lhs.begin() + sizeof(nsm_msg_hdr), lhs.end(),
+                          rhs.begin() + sizeof(nsm_msg_hdr));
+    }
+
+    /** @brief Hash a request message, apart from the instance ID */
+    static size_t hashRequest(const std::vector<uint8_t>& requestMsg)
+    {
+        auto msg = reinterpret_cast<const nsm_msg*>(requestMsg.data());
+        std::string_view payload(
+            reinterpret_cast<const char*>(msg->payload),
+            requestMsg.size() - sizeof(nsm_msg_hdr));
+        return std::hash<std::string_view>{}(payload) * 31 +
+               msg->hdr.nvidia_msg_type;
+    }
+
+    /** @brief Find a request identical to requestMsg which a request of the
+     *         given class may attach to: one in flight, or one queued in the
+     *         same or a higher class
+     */
+    Slot* findPending(const Endpoint& endpoint,
+                      const std::vector<uint8_t>& requestMsg, size_t hash,
+                      RequestClass requestClass) const
+    {
+        for (auto slot = endpoint.pending[hash & (pendingBuckets - 1)]; slot;
+             slot = slot->nextPending)
+        {
+            if (slot->hash != hash ||
+                !sameRequest(slot->request->getMessage(), requestMsg))
+            {
+                continue;
+            }
+            auto inFlight =
+                endpoint.outstanding[slot->request->getInstanceId()] == slot;
+            if (inFlight || slot->requestClass <= requestClass)
+            {
+                return slot;
+            }
+        }
+        return nullptr;
+    }
+
+    /** @brief Remove a coalescable request from the pending index */
+    void removePending(Endpoint& endpoint, Slot& slot)
+    {
+        auto link = &endpoint.pending[slot.hash & (pendingBuckets - 1)];
+        while (*link && *link != &slot)
+        {
+            link = &(*link)->nextPending;
+        }
+        if (*link)
+        {
+            *link = slot.nextPending;
+        }
+        slot.nextPending = nullptr;
+    }
+
+    /** @brief Get the requests of an EID, creating them and the circuit
+     *         breaker of the EID on first use
+     */
+    Endpoint& getEndpoint(eid_t eid)
+    {
+        auto& endpoint = endpoints[eid];
+        if (!endpoint)
+        {
+            endpoint = std::make_unique<Endpoint>(*this, eid);
+            notifyCircuitState(*endpoint);
+        }
+        return *endpoint;
+    }
+
+    /** @brief Take the budget of the next request of an EID from its bus.
+     *         Once the budget is exhausted or other EIDs wait for it, the EID
+     *         waits for its turn.
+     *
+     *  @return true if the request may be sent now
+     */
+    bool admit(Endpoint& endpoint, size_t size)
+    {
+        if (!endpoint.bus)
+        {
+            return true;
+        }
+        if (endpoint.waitingForBus)
+        {
+            return false;
+        }
+
+        auto& bus = *endpoint.bus;
+        auto now = BusBudget::Clock::now();
+        if (bus.waiting.empty() && bus.budget.tryAcquire(size, now))
+        {
+            return true;
+        }
+
+        bus.budget.onDeferred();
+        bus.waiting.push_back(endpoint.eid);
+        endpoint.waitingForBus = true;
+        if (!bus.timer.isRunning())
+        {
+            bus.timer.start(bus.budget.getDelay(size, now));
+        }
+        return false;
+    }
+
+    /** @brief Give the budget taken by admit() back to the bus of an EID,
+     *         for a request which was not sent
+     */
+    void refund(Endpoint& endpoint, const Slot& slot)
+    {
+        if (endpoint.bus)
+        {
+            endpoint.bus->budget.refund(slot.request->getMessage().size());
+        }
+    }
+
+    /** @brief Send a request of each EID waiting for the bus in turn, while
+     *         the budget lasts
+     */
+    void serveBus(Bus& bus)
+    {
+        while (!bus.waiting.empty())
+        {
+            auto& endpoint = *endpoints[bus.waiting.front()];
+            if (endpoint.queue.empty() ||
+                endpoint.numOutstanding >= maxOutstandingRequests)
+            {
+                // Nothing to send before a response, which queues the EID
+                // again
+                bus.waiting.pop_front();
+                endpoint.waitingForBus = false;
+                continue;
+            }
+
+            auto size = endpoint.queue.front().request->getMessage().size();
+            auto now = BusBudget::Clock::now();
+            if (!bus.budget.tryAcquire(size, now))
+            {
+                bus.timer.start(bus.budget.getDelay(size, now));
+                return;
+            }
+
+            bus.waiting.pop_front();
+            bus.waiting.push_back(endpoint.eid);
+            if (!sendNext(endpoint))
+            {
+                std::erase(bus.waiting, endpoint.eid);
+                endpoint.waitingForBus = false;
+            }
+        }
+    }
+
+    /** @brief Send the next queued request of an EID
+     *
+     *  @return false if no instance ID is free, the request stays queued
+     */
+    bool sendNext(Endpoint& endpoint)
+    {
+        auto& slot = endpoint.queue.pop();
+
+        auto rc = startRequest(endpoint, slot);
+        if (rc == NSM_BUSY)
+        {
+            // No free instance ID while other requests are in flight,
+            // retry once one of them completes
+            refund(endpoint, slot);
+            endpoint.queue.pushFront(slot);
+            return false;
+        }
+
+        auto& stats = classStats[static_cast<size_t>(slot.requestClass)];
+        auto delay = std::chrono::duration_cast<std::chrono::microseconds>(
+            RequestQueue::Clock::now() - slot.enqueued);
+        stats.totalDelay += delay;
+        stats.maxDelay = std::max(stats.maxDelay, delay);
+
+        if (rc)
+        {
+            // The caller is suspended waiting for this request, resume it
+            // with an empty response
+            complete(endpoint, slot, nullptr, 0);
+        }
+        return true;
+    }
+
+    /** @brief Reset a slot and return it to the pool of the EID */
+    void releaseSlot(Endpoint& endpoint, Slot& slot)
+    {
+        if (slot.coalescable)
+        {
+            removePending(endpoint, slot);
+            slot.coalescable = false;
+        }
+        slot.request.reset();
+        slot.responseHandler = nullptr;
+        slot.followers = nullptr;
+        endpoint.pool.release(slot);
+    }
+
+    /** @brief Release a request which left the queue and the window and
+     *         invoke its response handler, then the handlers of the requests
+     *         attached to it
+     */
+    void complete(Endpoint& endpoint, Slot& slot,
+                  const std::shared_ptr<const nsm_msg>& response,
+                  size_t respMsgLen)
+    {
+        auto eid = slot.eid;
+        // Detach the followers first, a handler sending the same request
+        // again starts a new one
+        auto responseHandler = std::move(slot.responseHandler);
+        auto follower = slot.followers;
+        releaseSlot(endpoint, slot);
+        responseHandler(eid, response, respMsgLen);
+
+        while (follower)
+        {
+            auto next = follower->next;
+            auto followerHandler = std::move(follower->responseHandler);
+            releaseSlot(endpoint, *follower);
+            followerHandler(eid, response, respMsgLen);
+            follower = next;
+        }
+    }
+
+    static const std::vector<uint8_t>&
+        messageBytes(const std::vector<uint8_t>& requestMsg)
+    {
+        return requestMsg;
+    }
+
+    static const std::vector<uint8_t>&
+        messageBytes(const RequestTemplate& requestTemplate)
+    {
+        return *requestTemplate;
+    }
+
+    /** @brief Register a request message or template, attaching it to a
+     *         pending identical request to the EID when there is one
+     */
+    template <typename Message>
+    int registerMessage(uint8_t tag, eid_t eid, uint8_t type, uint8_t command,
+                        Message&& requestMsg, ResponseHandler&& responseHandler,
+                        RequestClass requestClass)
+    {
+        auto& endpoint = getEndpoint(eid);
+        if (!endpoint.breaker.isClosed())
+        {
+            return NSM_SW_ERROR_UNAVAILABLE;
+        }
+
+        if (requestClass == RequestClass::User ||
+            messageBytes(requestMsg).size() < sizeof(nsm_msg_hdr))
+        {
+            return enqueueRequest(tag, eid, type, command,
+                                  std::move(requestMsg),
+                                  std::move(responseHandler), requestClass);
+        }
+
+        auto hash = hashRequest(messageBytes(requestMsg));
+        auto pending = findPending(endpoint, messageBytes(requestMsg), hash,
+                                   requestClass);
+        if (pending)
+        {
+            auto& follower = endpoint.pool.acquire(*this, eid);
+            follower.responseHandler = std::move(responseHandler);
+            auto last = &pending->followers;
+            while (*last)
+            {
+                last = &(*last)->next;
+            }
+            *last = &follower;
+            numCoalescedRequests++;
+            return NSM_SUCCESS;
+        }
+
+        return enqueueRequest(tag, eid, type, command, std::move(requestMsg),
+                              std::move(responseHandler), requestClass, hash);
+    }
+
+    /** @brief Queue or send a request, regardless of the circuit breaker
+     *
+     *  @param[in] hash - hash of the request message if identical requests
+     * may attach to it
+     *
+     *  @return NSM_SUCCESS on success and NSM_ERROR otherwise
+     */
+    template <typename Message>
+    int enqueueRequest(uint8_t tag, eid_t eid, uint8_t type, uint8_t command,
+                       Message&& requestMsg, ResponseHandler&& responseHandler,
+                       RequestClass requestClass,
+                       std::optional<size_t> hash = std::nullopt)
+    {
+        auto size = messageBytes(requestMsg).size();
+        if (size > static_cast<size_t>(sockManager.getSendBufferSize(eid)))
+        {
+            sockManager.setSendBufferSize(sockManager.getSocket(eid), size);
+        }
+
+        auto& endpoint = getEndpoint(eid);
+        auto& slot = endpoint.pool.acquire(*this, eid);
+        slot.request.emplace(sockManager.getSocket(eid), eid, tag, timerWheel,
+                             socketHandler, std::move(requestMsg), numRetries,
+                             timeoutPolicy.timeout(eid, type, command),
+                             responseTimeOut, verbose);
+        slot.responseHandler = std::move(responseHandler);
+        slot.requestClass = requestClass;
+        slot.coalescable = hash.has_value();
+        if (hash)
+        {
+            slot.hash = *hash;
+            auto& bucket = endpoint.pending[*hash & (pendingBuckets - 1)];
+            slot.nextPending = bucket;
+            bucket = &slot;
+        }
+
+        auto& stats = classStats[static_cast<size_t>(requestClass)];
+        stats.requests++;
+
+        if (!endpoint.queue.empty() ||
+            endpoint.numOutstanding >= maxOutstandingRequests ||
+            !admit(endpoint, size))
+        {
+            // The window is full, the request is sent once an outstanding
+            // request to the EID completes, or the bus is out of budget and
+            // the request is sent on the turn of the EID
+            endpoint.queue.push(requestClass, slot);
+            stats.queued++;
+            return NSM_SUCCESS;
+        }
+
+        auto rc = startRequest(endpoint, slot);
+        if (rc == NSM_BUSY)
+        {
+            // No free instance ID while other requests are in flight, the
+            // request is sent once one of them completes
+            refund(endpoint, slot);
+            endpoint.queue.push(requestClass, slot);
+            stats.queued++;
+            return NSM_SUCCESS;
+        }
+        if (rc)
+        {
+            // The caller is not suspended yet, so a failure is reported
+            // through the return code rather than through the response handler
+            releaseSlot(endpoint, slot);
+        }
+        return rc;
+    }
+
+    void notifyCircuitState(const Endpoint& endpoint)
+    {
+        if (circuitStateHandler)
+        {
+            circuitStateHandler(endpoint.eid, endpoint.breaker);
+        }
+    }
+
+    /** @brief Account a response of the EID, closing its circuit breaker */
+    void onEndpointResponse(Endpoint& endpoint)
+    {
+        if (endpoint.breaker.onResponse())
+        {
+            endpoint.probeTimer.stop();
+            lg2::info("EID={EID} responds again, circuit breaker closed",
+                      "EID", endpoint.eid);
+            notifyCircuitState(endpoint);
+        }
+    }
+
+    /** @brief Account an instance ID expiry of the EID. Once the circuit
+     *         breaker opens, fail the queued requests and schedule a probe.
+     */
+    void onEndpointTimeout(Endpoint& endpoint)
+    {
+        if (!endpoint.breaker.onTimeout())
+        {
+            return;
+        }
+
+        lg2::error("EID={EID} stopped responding after {COUNT} timeouts, "
+                   "circuit breaker opened",
+                   "EID", endpoint.eid, "COUNT",
+                   endpoint.breaker.getConsecutiveTimeouts());
+        endpoint.probeTimer.start(endpoint.breaker.getProbeInterval());
+        notifyCircuitState(endpoint);
+
+        // The response handlers may register new requests, which now fail
+        // immediately, so take the queue before resuming the callers
+        RequestQueue failed;
+        std::swap(failed, endpoint.queue);
+        while (!failed.empty())
+        {
+            complete(endpoint, failed.pop(), nullptr, 0);
+        }
+    }
+
+    /** @brief Send a ping to an EID whose circuit breaker is open
      *
-     *  @param[in] eid - eid for the Request
+     *  The probe is a background request, the queue of the EID was failed
+     *  when the breaker opened and user requests fail until it closes, so it
+     *  does not wait behind other requests.
      */
-    void removeRequestEntry(
-        eid_t eid, std::unordered_map<eid_t, RequestQueue>& handlers,
-        std::unordered_map<eid_t, std::unique_ptr<sdbusplus::Timer>>&
-            timerToFree,
-        std::chrono::seconds instanceIdExpiryInterval)
+    void sendProbe(Endpoint& endpoint)
+    {
+        auto eid = endpoint.eid;
+        endpoint.breaker.onProbe();
+        notifyCircuitState(endpoint);
+
+        std::vector<uint8_t> request(sizeof(nsm_msg_hdr) +
+                                     sizeof(nsm_common_req));
+        auto requestMsg = reinterpret_cast<nsm_msg*>(request.data());
+        encode_ping_req(0, requestMsg);
+
+        // A response closes the breaker in handleResponseImpl, only a
+        // missing one is handled here
+        auto rc = enqueueRequest(
+            MCTP_MSG_TAG_REQ, eid, NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY,
+            NSM_PING, std::move(request),
+            [this, &endpoint](eid_t, std::shared_ptr<const nsm_msg> response,
+                              size_t) {
+            if (!response)
+            {
+                onProbeFailure(endpoint);
+            }
+        },
+            RequestClass::Background);
+        if (rc)
+        {
+            onProbeFailure(endpoint);
+        }
+    }
+
+    void onProbeFailure(Endpoint& endpoint)
     {
-        timerToFree[eid] = nullptr;
-        runRegisteredRequest(eid, handlers, instanceIdExpiryInterval);
+        if (endpoint.breaker.isClosed())
+        {
+            return;
+        }
+        endpoint.breaker.onProbeFailure();
+        endpoint.probeTimer.start(endpoint.breaker.getProbeInterval());
+        notifyCircuitState(endpoint);
+    }
+
+    /** @brief Allocate an instance ID, send the request and arm its instance
+     *         ID expiry timer. On success the request is moved to the
+     *         outstanding requests.
+     *
+     *  @param[in] endpoint - requests of the EID
+     *  @param[in] slot - request entry
+     *
+     *  @return NSM_SUCCESS on success, NSM_BUSY if no instance ID is free
+     *          while other requests to the EID are in flight and NSM_ERROR
+     *          otherwise
+     */
+    int startRequest(Endpoint& endpoint, Slot& slot)
+    {
+        auto eid = slot.eid;
+        auto& request = slot.request;
+
+        try
+        {
+            // get instance_id from pool
+            auto instanceId = instanceIdDb.next(eid);
+            request->setInstanceId(instanceId);
+        }
+        catch (const std::exception& e)
+        {
+            if (endpoint.numOutstanding)
+            {
+                return NSM_BUSY;
+            }
+            lg2::error("Error while get MCTP instanceId for EID={EID}, {ERROR}",
+                       "EID", eid, "ERROR", e);
+            return NSM_ERROR;
+        }
+
+        auto rc = request->start();
+        if (rc)
+        {
+            instanceIdDb.free(eid, request->getInstanceId());
+            lg2::error("Failure to send the NSM request message");
+            return rc;
+        }
+
+        slot.expiryTimer.start(
+            timeoutPolicy.expiryInterval(request->getTimeout(), numRetries));
+
+        endpoint.outstanding[request->getInstanceId()] = &slot;
+        endpoint.numOutstanding++;
+
+        return NSM_SUCCESS;
+    }
+
+    /** @brief Callback of the instance ID expiry timer of a request
+     *
+     *  @param[in] slot - request whose instance ID expired
+     */
+    void instanceIdExpiryCallBack(Slot& slot)
+    {
+        auto eid = slot.eid;
+        auto& endpoint = getEndpoint(eid);
+        auto& request = slot.request;
+
+        // The flight recorder is updated either here or in
+        // handleResponseImpl
+        nsm::TimeOutTracker::getInstance()
+            .getDeviceTimeOutTracker(eid)
+            .handleTimeout(request->getMessageType(), request->getCommand(),
+                           request->getInstanceId(),
+                           std::chrono::duration_cast<std::chrono::microseconds>(
+                               TimerWheel::Clock::now() -
+                               request->getSendTime()));
+
+        timeoutPolicy.backoff(eid, request->getMessageType(),
+                              request->getCommand());
+        request->stop();
+
+        // Call responseHandler after erase it from the outstanding requests
+        // to avoid starting the same request again in runRegisteredRequest()
+        instanceIdDb.free(eid, request->getInstanceId());
+        endpoint.outstanding[request->getInstanceId()] = nullptr;
+        endpoint.numOutstanding--;
+        onEndpointTimeout(endpoint);
+
+        // Call response handler with an empty response to indicate
+        // no response
+        complete(endpoint, slot, nullptr, 0);
+
+        runRegisteredRequest(eid);
     }
 };
 
@@ -400,6 +1251,10 @@ class Handler
  * e.g.
  * rc = co_await SendRecvNsmMsg<h>(h, eid, req, respMsg, respLen);
  *
+ * The response is returned either as a reference counted message, which the
+ * caller may keep, or as a raw pointer which is only valid until the
+ * coroutine suspends again.
+ *
  * @tparam RequesterHandler - Requester::handler class type
  */
 template <class RequesterHandler>
@@ -421,11 +1276,19 @@ struct SendRecvNsmMsg
 
     /** @brief The NSM request message.
      */
-    std::vector<uint8_t>& request;
+    std::vector<uint8_t>* request = nullptr;
+
+    /** @brief The shared NSM request template, sent instead of request.
+     */
+    RequestTemplate requestTemplate;
 
     /** @brief The pointer of NSM response message.
      */
-    const nsm_msg** responseMsg;
+    const nsm_msg** responseMsg = nullptr;
+
+    /** @brief The reference counted NSM response message.
+     */
+    std::shared_ptr<const nsm_msg>* responseBuffer = nullptr;
 
     /** @brief The length of NSM response message.
      */
@@ -446,25 +1309,56 @@ struct SendRecvNsmMsg
      * method will send out NSM request message, register handleResponse() as
      * call back function for the event when NSM response message received.
      */
-    bool await_suspend(std::coroutine_handle<> handle) noexcept
+    template <typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> handle) noexcept
     {
-        if (responseMsg == nullptr || responseLen == nullptr)
+        if ((responseMsg == nullptr && responseBuffer == nullptr) ||
+            responseLen == nullptr ||
+            (request == nullptr && requestTemplate == nullptr))
         {
             rc = NSM_SW_ERROR_NULL;
             return false;
         }
 
-        auto requestMsg = reinterpret_cast<nsm_msg*>(request.data());
+        // The request takes the class of the awaiting coroutine rather than
+        // the class of whichever code resumed it last
+        auto requestClass = currentRequestClass();
+        if constexpr (requires { handle.promise().requestClass; })
+        {
+            requestClass = handle.promise().requestClass;
+        }
 
-        rc = handler.registerRequest(
-            MCTP_MSG_TAG_REQ, eid, requestMsg->hdr.nvidia_msg_type,
-            requestMsg->payload[0], std::move(request),
-            std::move(std::bind_front(&SendRecvNsmMsg::HandleResponse, this)));
+        if (requestTemplate)
+        {
+            auto requestMsg =
+                reinterpret_cast<const nsm_msg*>(requestTemplate->data());
+            rc = handler.registerRequest(
+                MCTP_MSG_TAG_REQ, eid, requestMsg->hdr.nvidia_msg_type,
+                requestMsg->payload[0], std::move(requestTemplate),
+                std::move(
+                    std::bind_front(&SendRecvNsmMsg::HandleResponse, this)),
+                requestClass);
+        }
+        else
+        {
+            auto requestMsg = reinterpret_cast<nsm_msg*>(request->data());
+            rc = handler.registerRequest(
+                MCTP_MSG_TAG_REQ, eid, requestMsg->hdr.nvidia_msg_type,
+                requestMsg->payload[0], std::move(*request),
+                std::move(
+                    std::bind_front(&SendRecvNsmMsg::HandleResponse, this)),
+                requestClass);
+        }
 
         if (rc)
         {
-            lg2::error("registerRequest failed, rc={RC}", "RC",
-                       static_cast<unsigned>(rc));
+            // Requests to an unavailable EID fail by design, do not flood
+            // the log
+            if (rc != NSM_SW_ERROR_UNAVAILABLE)
+            {
+                lg2::error("registerRequest failed, rc={RC}", "RC",
+                           static_cast<unsigned>(rc));
+            }
             return false;
         }
 
@@ -487,26 +1381,65 @@ struct SendRecvNsmMsg
                    std::vector<uint8_t>& request, const nsm_msg** responseMsg,
                    size_t* responseLen) :
         handler(handler),
-        eid(eid), request(request), responseMsg(responseMsg),
+        eid(eid), request(&request), responseMsg(responseMsg),
         responseLen(responseLen), rc(NSM_ERROR)
     {}
 
+    /** @brief Constructor of awaitable object returning the reference
+     * counted response message.
+     */
+    SendRecvNsmMsg(RequesterHandler& handler, eid_t eid,
+                   std::vector<uint8_t>& request,
+                   std::shared_ptr<const nsm_msg>* responseBuffer,
+                   size_t* responseLen) :
+        handler(handler),
+        eid(eid), request(&request), responseBuffer(responseBuffer),
+        responseLen(responseLen), rc(NSM_ERROR)
+    {}
+
+    /** @brief Constructor of awaitable object sending a shared request
+     * template and returning the reference counted response message.
+     */
+    SendRecvNsmMsg(RequesterHandler& handler, eid_t eid,
+                   const RequestTemplate& requestTemplate,
+                   std::shared_ptr<const nsm_msg>* responseBuffer,
+                   size_t* responseLen) :
+        handler(handler),
+        eid(eid), requestTemplate(requestTemplate),
+        responseBuffer(responseBuffer), responseLen(responseLen),
+        rc(NSM_ERROR)
+    {}
+
     /** @brief The function will be registered by ReqisterHandler for handling
      * NSM response message. */
-    void HandleResponse([[maybe_unused]] eid_t eid, const nsm_msg* response,
+    void HandleResponse(eid_t eid, std::shared_ptr<const nsm_msg> response,
                         size_t length)
     {
         if (response == nullptr || !length)
         {
-            rc = NSM_SW_ERROR_NULL;
+            rc = handler.isEndpointAvailable(eid) ? NSM_SW_ERROR_NULL
+                                                  : NSM_SW_ERROR_UNAVAILABLE;
         }
         else
         {
-            *responseMsg = response;
+            if (responseMsg)
+            {
+                *responseMsg = response.get();
+            }
+            if (responseBuffer)
+            {
+                *responseBuffer = response;
+            }
             *responseLen = length;
             rc = NSM_SW_SUCCESS;
         }
-        resumeHandle();
+        // Resume from the run queue rather than the I/O callback, the
+        // response stays valid until the coroutine suspends again
+        handler.getRunQueue().post(
+            eid, [this, response = std::move(response)]() mutable {
+            resumeHandle();
+            response.reset();
+        });
     }
 };
 
@@ -23,6 +23,7 @@
 #include "common/types.hpp"
 #include "common/utils.hpp"
 #include "nsmd/socket_handler.hpp"
+#include "requester/timer_wheel.hpp"
 
 #include <errno.h>
 #include <stdlib.h>
@@ -32,9 +33,8 @@
 #include <unistd.h>
 
 #include <phosphor-logging/lg2.hpp>
-#include <sdbusplus/timer.hpp>
-#include <sdeventplus/event.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <iostream>
@@ -46,31 +46,36 @@ namespace requester
  *
  *  The abstract base class for implementing the NSM request retry logic. This
  *  class handles number of times the NSM request needs to be retried if the
- *  response is not received and the time to wait between each retry. It
- *  provides APIs to start and stop the request flow.
+ *  response is not received and the time to wait between each retry, which
+ *  doubles with every retry up to the maximum timeout. It provides APIs to
+ *  start and stop the request flow.
  */
 class RequestRetryTimer
 {
   public:
     RequestRetryTimer() = delete;
     RequestRetryTimer(const RequestRetryTimer&) = delete;
-    RequestRetryTimer(RequestRetryTimer&&) = default;
+    RequestRetryTimer(RequestRetryTimer&&) = delete;
     RequestRetryTimer& operator=(const RequestRetryTimer&) = delete;
-    RequestRetryTimer& operator=(RequestRetryTimer&&) = default;
+    RequestRetryTimer& operator=(RequestRetryTimer&&) = delete;
     virtual ~RequestRetryTimer() = default;
 
     /** @brief Constructor
      *
-     *  @param[in] event - reference to NSM daemon's main event loop
+     *  @param[in] timerWheel - timing wheel of the requester handler
      *  @param[in] numRetries - number of request retries
-     *  @param[in] timeout - time to wait between each retry in milliseconds
+     *  @param[in] timeout - time to wait before the first retry
+     *  @param[in] maxTimeout - upper bound of the time to wait between
+     * retries
      */
-    explicit RequestRetryTimer(sdeventplus::Event& event, uint8_t numRetries,
-                               std::chrono::milliseconds timeout) :
-
-        event(event),
-        numRetries(numRetries), timeout(timeout),
-        timer(event.get(), std::bind_front(&RequestRetryTimer::callback, this))
+    explicit RequestRetryTimer(TimerWheel& timerWheel, uint8_t numRetries,
+                               std::chrono::milliseconds timeout,
+                               std::chrono::milliseconds maxTimeout) :
+        numRetries(numRetries),
+        timeout(timeout), maxTimeout(std::max(timeout, maxTimeout)),
+        // a lambda capturing only this is stored inline by std::function,
+        // unlike the equivalent std::bind_front
+        timer(timerWheel, [this] { callback(); })
     {}
 
     /** @brief Starts the request flow and arms the timer for request retries
@@ -79,24 +84,16 @@ class RequestRetryTimer
      */
     int start()
     {
+        sendTime = TimerWheel::Clock::now();
         auto rc = send();
         if (rc)
         {
             return rc;
         }
 
-        try
-        {
-            if (numRetries)
-            {
-                timer.start(duration_cast<std::chrono::microseconds>(timeout),
-                            true);
-            }
-        }
-        catch (const std::runtime_error& e)
+        if (numRetries)
         {
-            lg2::error("Failed to start the request timer.", "ERROR", e);
-            return NSM_ERROR;
+            timer.start(timeout);
         }
 
         return NSM_SW_SUCCESS;
@@ -105,20 +102,37 @@ class RequestRetryTimer
     /** @brief Stops the timer and no further request retries happen */
     void stop()
     {
-        auto rc = timer.stop();
-        if (rc)
-        {
-            lg2::error("Failed to stop the request timer. RC={RC}", "RC",
-                       unsigned(rc));
-        }
+        timer.stop();
+    }
+
+    /** @brief Get the time to wait before the next retry */
+    std::chrono::milliseconds getTimeout() const
+    {
+        return timeout;
+    }
+
+    /** @brief Get the time the request was first sent */
+    TimerWheel::Clock::time_point getSendTime() const
+    {
+        return sendTime;
+    }
+
+    /** @brief Check whether the request was sent again, the response of a
+     *         retried request does not tell which attempt it answers
+     */
+    bool isRetransmitted() const
+    {
+        return retransmitted;
     }
 
   protected:
-    sdeventplus::Event& event; //!< reference to NSM daemon's main event loop
-    uint8_t numRetries;        //!< number of request retries
+    uint8_t numRetries; //!< number of request retries
     std::chrono::milliseconds
-        timeout;            //!< time to wait between each retry in milliseconds
-    sdbusplus::Timer timer; //!< manages starting timers and handling timeouts
+        timeout;             //!< time to wait before the next retry
+    std::chrono::milliseconds maxTimeout; //!< upper bound of the timeout
+    TimerWheel::Timer timer; //!< retry timer on the wheel of the handler
+    TimerWheel::Clock::time_point sendTime; //!< time of the first attempt
+    bool retransmitted = false;             //!< whether a retry was sent
 
     /** @brief Sends the NSM request message
      *
@@ -131,11 +145,10 @@ class RequestRetryTimer
     {
         if (numRetries--)
         {
+            retransmitted = true;
             send();
-        }
-        else
-        {
-            stop();
+            timeout = std::min(timeout * 2, maxTimeout);
+            timer.start(timeout);
         }
     }
 };
@@ -154,51 +167,79 @@ class Request final : public RequestRetryTimer
   public:
     Request() = delete;
     Request(const Request&) = delete;
-    Request(Request&&) = default;
+    Request(Request&&) = delete;
     Request& operator=(const Request&) = delete;
-    Request& operator=(Request&&) = default;
+    Request& operator=(Request&&) = delete;
     ~Request() = default;
 
     /** @brief Constructor
      *
      *  @param[in] fd - fd of the MCTP communication socket
      *  @param[in] eid - endpoint ID of the remote MCTP endpoint
-     *  @param[in] event - reference to NSM daemon's main event loop
+     *  @param[in] timerWheel - timing wheel of the requester handler
      *  @param[in] requestMsg - NSM request message
      *  @param[in] numRetries - number of request retries
-     *  @param[in] timeout - time to wait between each retry in milliseconds
+     *  @param[in] timeout - time to wait before the first retry
+     *  @param[in] maxTimeout - upper bound of the time to wait between
+     * retries
      *  @param[in] verbose - verbose tracing flag
      */
-    explicit Request(int fd, eid_t eid, uint8_t tag, sdeventplus::Event& event,
+    explicit Request(int fd, eid_t eid, uint8_t tag, TimerWheel& timerWheel,
                      const mctp_socket::Handler* handler,
                      std::vector<uint8_t>&& requestMsg, uint8_t numRetries,
-                     std::chrono::milliseconds timeout, bool verbose) :
-        RequestRetryTimer(event, numRetries, timeout),
+                     std::chrono::milliseconds timeout,
+                     std::chrono::milliseconds maxTimeout, bool verbose) :
+        RequestRetryTimer(timerWheel, numRetries, timeout, maxTimeout),
         fd(fd), eid(eid), tag(tag), requestMsg(std::move(requestMsg)),
         verbose(verbose), socketHandler(handler)
     {}
 
+    /** @brief Constructor of a request sent from a shared request template
+     *
+     *  The template is neither copied nor written to, the instance ID of the
+     *  request is handed to the transport on every send.
+     */
+    explicit Request(int fd, eid_t eid, uint8_t tag, TimerWheel& timerWheel,
+                     const mctp_socket::Handler* handler,
+                     RequestTemplate requestTemplate, uint8_t numRetries,
+                     std::chrono::milliseconds timeout,
+                     std::chrono::milliseconds maxTimeout, bool verbose) :
+        RequestRetryTimer(timerWheel, numRetries, timeout, maxTimeout),
+        fd(fd), eid(eid), tag(tag), requestTemplate(std::move(requestTemplate)),
+        verbose(verbose), socketHandler(handler)
+    {}
+
     uint8_t getInstanceId()
     {
-        auto nsmMsg = reinterpret_cast<nsm_msg*>(requestMsg.data());
-        return nsmMsg->hdr.instance_id;
+        return instanceId;
     }
 
     void setInstanceId(uint8_t instanceId)
     {
-        auto nsmMsg = reinterpret_cast<nsm_msg*>(requestMsg.data());
-        nsmMsg->hdr.instance_id = instanceId;
+        this->instanceId = instanceId;
+        if (!requestTemplate)
+        {
+            auto nsmMsg = reinterpret_cast<nsm_msg*>(requestMsg.data());
+            nsmMsg->hdr.instance_id = instanceId;
+        }
     }
 
-    std::string requestMsgToString() const
+    uint8_t getMessageType() const
     {
-        std::ostringstream oss;
-        for (const auto& byte : requestMsg)
-        {
-            oss << std::setfill('0') << std::setw(2) << std::hex
-                << static_cast<int>(byte) << " ";
-        }
-        return oss.str();
+        auto nsmMsg = reinterpret_cast<const nsm_msg*>(getMessage().data());
+        return nsmMsg->hdr.nvidia_msg_type;
+    }
+
+    uint8_t getCommand() const
+    {
+        auto nsmMsg = reinterpret_cast<const nsm_msg*>(getMessage().data());
+        return nsmMsg->payload[0];
+    }
+
+    /** @brief Get the NSM request message */
+    const std::vector<uint8_t>& getMessage() const
+    {
+        return requestTemplate ? *requestTemplate : requestMsg;
     }
 
   private:
@@ -206,6 +247,8 @@ class Request final : public RequestRetryTimer
     eid_t eid;   //!< endpoint ID of the remote MCTP endpoint
     uint8_t tag; //!< tag mctp message tag to be used
     std::vector<uint8_t> requestMsg;           //!< NSM request message
+    RequestTemplate requestTemplate;           //!< shared NSM request message
+    uint8_t instanceId = 0;                    //!< instance ID of the request
     bool verbose;                              //!< verbose tracing flag
     const mctp_socket::Handler* socketHandler; // MCTP socket handler
 
@@ -215,8 +258,11 @@ class Request final : public RequestRetryTimer
      */
     int send() const
     {
-        auto rc = socketHandler->sendMsg(tag, eid, fd, requestMsg.data(),
-                                         requestMsg.size());
+        // The transport sends the instance ID from its own copy of the
+        // header, a shared template is never written to
+        const auto& message = getMessage();
+        auto rc = socketHandler->sendMsg(tag, eid, fd, message.data(),
+                                         message.size(), instanceId);
         if (rc < 0)
         {
             lg2::error("Failed to send NSM message. RC={RC}, errno={ERRNO}",
@@ -0,0 +1,131 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+namespace requester
+{
+
+/** @struct RequestPoolStats
+ *
+ *  Counters of the request slot pool of an EID. Overflows are slots taken
+ *  from the heap while every pooled slot was in use.
+ */
+struct RequestPoolStats
+{
+    size_t capacity = 0;  //!< upper bound of the pooled slots
+    size_t slots = 0;     //!< pooled slots created so far
+    size_t inUse = 0;     //!< slots currently holding a request
+    size_t peakInUse = 0; //!< largest number of slots in use
+    uint64_t acquired = 0;
+    uint64_t overflows = 0;
+};
+
+/** @class RequestPool
+ *
+ *  Fixed-capacity pool of the request slots of an EID. Slots are created on
+ *  first use, up to the capacity, and recycled through a free list once the
+ *  request they hold completes, so the steady state request path does not
+ *  allocate. While every pooled slot is in use further slots come from the
+ *  heap and are freed on release.
+ *
+ *  The pool does not reset a released slot, its owner does.
+ *
+ *  @tparam T - slot type, with a T* next member linking the free slots and
+ *              a bool pooled member
+ */
+template <typename T>
+class RequestPool
+{
+  public:
+    explicit RequestPool(size_t capacity)
+    {
+        stats.capacity = capacity;
+    }
+
+    RequestPool(const RequestPool&) = delete;
+    RequestPool& operator=(const RequestPool&) = delete;
+
+    /** @brief Take a free slot, constructing it from args if the pool has
+     *         none left
+     */
+    template <typename... Args>
+    T& acquire(Args&&... args)
+    {
+        T* slot = freeSlots;
+        if (slot)
+        {
+            freeSlots = slot->next;
+        }
+        else if (slots.size() < stats.capacity)
+        {
+            slot = &slots.emplace_back(std::forward<Args>(args)...);
+            stats.slots = slots.size();
+        }
+        else
+        {
+            auto overflowSlot = std::make_unique<T>(std::forward<Args>(args)...);
+            slot = overflowSlot.get();
+            slot->pooled = false;
+            overflow.emplace(slot, std::move(overflowSlot));
+            stats.overflows++;
+        }
+
+        slot->next = nullptr;
+        stats.acquired++;
+        stats.inUse++;
+        stats.peakInUse = std::max(stats.peakInUse, stats.inUse);
+        return *slot;
+    }
+
+    /** @brief Return a slot to the pool, a heap slot is destroyed */
+    void release(T& slot)
+    {
+        stats.inUse--;
+        if (!slot.pooled)
+        {
+            overflow.erase(&slot);
+            return;
+        }
+        slot.next = freeSlots;
+        freeSlots = &slot;
+    }
+
+    const RequestPoolStats& getStats() const
+    {
+        return stats;
+    }
+
+  private:
+    /** @brief Pooled slots, a deque keeps their address as it grows */
+    std::deque<T> slots;
+
+    /** @brief Heap slots in use beyond the capacity */
+    std::unordered_map<T*, std::unique_ptr<T>> overflow;
+
+    T* freeSlots = nullptr;
+    RequestPoolStats stats;
+};
+
+} // namespace requester
@@ -0,0 +1,244 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace requester
+{
+
+/** @brief Class of a NSM request. Queued requests of an EID are sent in
+ *         strict priority, in the order of the enumerators.
+ */
+enum class RequestClass : uint8_t
+{
+    User,       //!< user initiated set operations and raw commands
+    Priority,   //!< priority telemetry
+    RoundRobin, //!< round robin telemetry
+    Background, //!< static inventory reads
+};
+
+static constexpr size_t numRequestClasses =
+    static_cast<size_t>(RequestClass::Background) + 1;
+
+/** @brief Get the class assigned to requests registered by the running code
+ *
+ *  A Coroutine takes the current class when it starts and keeps it in its
+ *  promise. The class is made current again whenever the coroutine resumes,
+ *  and the class of the code which resumed it once it suspends.
+ *
+ *  @return reference to the current request class of the thread
+ */
+inline RequestClass& currentRequestClass()
+{
+    thread_local RequestClass requestClass = RequestClass::RoundRobin;
+    return requestClass;
+}
+
+/** @class RequestClassScope
+ *
+ *  Sets the current request class for the lifetime of the object. It must not
+ *  be kept across a co_await, use withRequestClass() to start a coroutine in a
+ *  class instead.
+ */
+class RequestClassScope
+{
+  public:
+    explicit RequestClassScope(RequestClass requestClass) :
+        previous(std::exchange(currentRequestClass(), requestClass))
+    {}
+
+    RequestClassScope(const RequestClassScope&) = delete;
+    RequestClassScope& operator=(const RequestClassScope&) = delete;
+
+    ~RequestClassScope()
+    {
+        currentRequestClass() = previous;
+    }
+
+  private:
+    RequestClass previous;
+};
+
+/** @brief Invoke a function, typically starting a coroutine, with the given
+ *         request class
+ *
+ *  e.g. co_await withRequestClass(RequestClass::User, [&] { return f(); });
+ *
+ *  @param[in] requestClass - class of the requests registered by the function
+ *  @param[in] func - function to invoke
+ *
+ *  @return the return value of the function
+ */
+template <typename Func>
+decltype(auto) withRequestClass(RequestClass requestClass, Func&& func)
+{
+    RequestClassScope scope(requestClass);
+    return std::forward<Func>(func)();
+}
+
+/** @struct RequestClassStats
+ *
+ *  Queueing statistics of a request class. Only requests which waited for a
+ *  free slot in the request window are accounted in the delay.
+ */
+struct RequestClassStats
+{
+    uint64_t requests = 0; //!< registered requests
+    uint64_t queued = 0;   //!< requests which waited in the queue
+    std::chrono::microseconds totalDelay{0}; //!< sum of the queueing delays
+    std::chrono::microseconds maxDelay{0};   //!< largest queueing delay
+
+    /** @brief Get the average queueing delay of the queued requests */
+    std::chrono::microseconds averageDelay() const
+    {
+        return queued ? totalDelay / static_cast<int64_t>(queued)
+                      : std::chrono::microseconds{0};
+    }
+};
+
+/** @class ClassedRequestQueue
+ *
+ *  Queue of the requests to an EID with one FIFO per request class. pop()
+ *  returns the oldest request of the highest non-empty class. The queue is
+ *  intrusive, requests are linked through their own next member so queueing
+ *  never allocates.
+ *
+ *  @tparam T - request entry type, with requestClass, enqueued and T* next
+ *              members
+ */
+template <typename T>
+class ClassedRequestQueue
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Append a request to the FIFO of its class */
+    void push(RequestClass requestClass, T& entry,
+              Clock::time_point enqueued = Clock::now())
+    {
+        entry.requestClass = requestClass;
+        entry.enqueued = enqueued;
+        entry.next = nullptr;
+
+        auto& queue = fifo(requestClass);
+        if (queue.tail)
+        {
+            queue.tail->next = &entry;
+        }
+        else
+        {
+            queue.head = &entry;
+        }
+        queue.tail = &entry;
+        queue.size++;
+        ++count;
+    }
+
+    /** @brief Put a popped request back at the head of the FIFO of its class
+     */
+    void pushFront(T& entry)
+    {
+        auto& queue = fifo(entry.requestClass);
+        entry.next = queue.head;
+        queue.head = &entry;
+        if (!queue.tail)
+        {
+            queue.tail = &entry;
+        }
+        queue.size++;
+        ++count;
+    }
+
+    /** @brief Remove and return the next request to send, the queue must not
+     *         be empty
+     */
+    T& pop()
+    {
+        for (auto& queue : queues)
+        {
+            if (queue.head)
+            {
+                T& entry = *queue.head;
+                queue.head = entry.next;
+                if (!queue.head)
+                {
+                    queue.tail = nullptr;
+                }
+                entry.next = nullptr;
+                queue.size--;
+                --count;
+                return entry;
+            }
+        }
+        __builtin_unreachable();
+    }
+
+    /** @brief Get the request pop() returns next, the queue must not be
+     *         empty
+     */
+    const T& front() const
+    {
+        for (const auto& queue : queues)
+        {
+            if (queue.head)
+            {
+                return *queue.head;
+            }
+        }
+        __builtin_unreachable();
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    /** @brief Get the number of queued requests of a class */
+    size_t size(RequestClass requestClass) const
+    {
+        return queues[static_cast<size_t>(requestClass)].size;
+    }
+
+  private:
+    /** @brief Linked FIFO of the requests of a class */
+    struct Fifo
+    {
+        T* head = nullptr;
+        T* tail = nullptr;
+        size_t size = 0;
+    };
+
+    Fifo& fifo(RequestClass requestClass)
+    {
+        return queues[static_cast<size_t>(requestClass)];
+    }
+
+    std::array<Fifo, numRequestClasses> queues{};
+    size_t count = 0;
+};
+
+} // namespace requester
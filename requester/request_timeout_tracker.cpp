@@ -19,13 +19,9 @@
 
 #include <phosphor-logging/lg2.hpp>
 
-#include <cerrno>
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
-#include <exception>
-#include <queue>
-#include <string>
-#include <system_error>
 
 namespace nsm
 {
@@ -37,12 +33,13 @@ DeviceRequestTimeOutTracker::DeviceRequestTimeOutTracker(eid_t eid) : eid(eid)
 
 DeviceRequestTimeOutTracker& DeviceRequestTimeOutTracker::getInstance(eid_t eid)
 {
-    if (instances.find(eid) == instances.end())
+    auto& instance = instances[eid];
+    if (!instance)
     {
-        instances[eid] = std::shared_ptr<DeviceRequestTimeOutTracker>(
+        instance = std::shared_ptr<DeviceRequestTimeOutTracker>(
             new DeviceRequestTimeOutTracker(eid));
     }
-    return *instances[eid];
+    return *instance;
 }
 void DeviceRequestTimeOutTracker::logFailuresForAllEids()
 {
@@ -52,85 +49,38 @@ void DeviceRequestTimeOutTracker::logFailuresForAllEids()
     }
 }
 
-bool DeviceRequestTimeOutTracker::isEmpty()
+std::vector<FlightRecord> DeviceRequestTimeOutTracker::getRecords() const
 {
-    return messages.empty();
-}
-
-bool DeviceRequestTimeOutTracker::isFull()
-{
-    return messages.size() == MAXSIZE;
-}
-// push on a full queue, will remove the oldest message
-void DeviceRequestTimeOutTracker::push(std::string nsm_request)
-{
-    if (isFull())
-    {
-        messages.pop_front();
-    }
-    messages.push_back(nsm_request);
-}
-
-void DeviceRequestTimeOutTracker::pop()
-{
-    if (isEmpty())
+    std::vector<FlightRecord> result;
+    auto count = std::min<uint64_t>(next, capacity);
+    result.reserve(count);
+    for (auto i = next - count; i < next; i++)
     {
-        return;
+        result.push_back(records[i % capacity]);
     }
-    messages.pop_front();
-}
-
-std::string DeviceRequestTimeOutTracker::front()
-{
-    std::string nsm_request;
-    if (isEmpty())
-    {
-        return nsm_request;
-    }
-    nsm_request = messages.front();
-    return nsm_request;
-}
-
-void DeviceRequestTimeOutTracker::handleTimeout(std::string nsm_request)
-{
-    if (firstTimeoutMessage.has_value())
-    {
-        // skip further timeout messages as first timeout request has been
-        // recorded
-        return;
-    }
-    firstTimeoutMessage = nsm_request;
-}
-void DeviceRequestTimeOutTracker::handleNoTimeout(std::string nsm_request)
-{
-    if (firstTimeoutMessage.has_value())
-    {
-        // device responded after a timeout, reset tracker params
-        firstTimeoutMessage = std::nullopt;
-        emptyQueue();
-    }
-    push(nsm_request);
-}
-
-void DeviceRequestTimeOutTracker::emptyQueue()
-{
-    messages.clear();
+    return result;
 }
 
 void DeviceRequestTimeOutTracker::logTimeOutFailure()
 {
     lg2::error("******logTimeOutFailure: EID={EID}*****", "EID", eid);
-    if (firstTimeoutMessage.has_value())
+    if (numTimeouts)
     {
-        for (const auto& message : messages)
+        lg2::error("logTimeOutFailure: EID={EID}, {TIMEOUTS} timeouts in "
+                   "{REQUESTS} requests, last {COUNT} requests:",
+                   "EID", eid, "TIMEOUTS", numTimeouts, "REQUESTS", next,
+                   "COUNT", std::min<uint64_t>(next, capacity));
+        for (const auto& record : getRecords())
         {
             lg2::error(
-                "logTimeOutFailure: EID={EID}, Last(n) NSM request msg before timeout: {REQ} ",
-                "EID", eid, "REQ", message);
+                "logTimeOutFailure: EID={EID}, TIME={TIME}us, TYPE={TYPE}, "
+                "COMMAND={CMD}, IID={IID}, LATENCY={LATENCY}us, OUTCOME={OUTCOME}",
+                "EID", eid, "TIME", record.timestamp, "TYPE",
+                record.messageType, "CMD", record.command, "IID",
+                record.instanceId, "LATENCY", record.latency, "OUTCOME",
+                record.outcome == FlightRecord::Outcome::Timeout ? "Timeout"
+                                                                 : "Response");
         }
-        lg2::error(
-            "logTimeOutFailure: EID={EID}, Timeout for NSM request: {REQ}",
-            "EID", eid, "REQ", *firstTimeoutMessage);
     }
     lg2::error("******logTimeOutFailure: EID={EID}*****", "EID", eid);
 }
@@ -17,38 +17,81 @@
 
 #pragma once
 
-#include "request.hpp"
+#include "common/types.hpp"
 
-#include <phosphor-logging/lg2.hpp>
-
-#include <cerrno>
+#include <array>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
-#include <exception>
-#include <queue>
-#include <string>
-#include <system_error>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace nsm
 {
 
+/** @struct FlightRecord
+ *
+ *  Outcome of a completed NSM request, kept in binary form and only
+ *  formatted when the records are dumped.
+ */
+struct FlightRecord
+{
+    enum class Outcome : uint8_t
+    {
+        Response,
+        Timeout,
+    };
+
+    uint64_t timestamp;  //!< completion time, microseconds since the epoch
+    uint32_t latency;    //!< microseconds since the request was first sent
+    uint8_t messageType; //!< NVIDIA message type
+    uint8_t command;     //!< NSM command
+    uint8_t instanceId;  //!< NSM instance ID
+    Outcome outcome;
+};
+
+/** @class DeviceRequestTimeOutTracker
+ *
+ *  Flight recorder of an EID, a ring of the last completed requests. The
+ *  records are logged on demand, through the LogDump D-Bus method.
+ */
 class DeviceRequestTimeOutTracker
 {
   public:
+    /** @brief Number of requests recorded per EID */
+    static constexpr size_t capacity = 32;
+
     static std::unordered_map<eid_t,
                               std::shared_ptr<DeviceRequestTimeOutTracker>>
         instances;
     static DeviceRequestTimeOutTracker& getInstance(eid_t eid);
 
-    bool isEmpty();
-    bool isFull();
-    void push(std::string nsm_request);
-    void pop();
-    std::string front();
-    void emptyQueue();
+    /** @brief Record a request which expired without response */
+    void handleTimeout(uint8_t messageType, uint8_t command,
+                       uint8_t instanceId, std::chrono::microseconds latency)
+    {
+        record(messageType, command, instanceId, latency,
+               FlightRecord::Outcome::Timeout);
+    }
+
+    /** @brief Record a request which got its response */
+    void handleNoTimeout(uint8_t messageType, uint8_t command,
+                         uint8_t instanceId, std::chrono::microseconds latency)
+    {
+        record(messageType, command, instanceId, latency,
+               FlightRecord::Outcome::Response);
+    }
+
+    /** @brief Get the recorded requests, oldest first */
+    std::vector<FlightRecord> getRecords() const;
+
+    /** @brief Get the number of timeouts recorded since the start */
+    uint64_t getNumTimeouts() const
+    {
+        return numTimeouts;
+    }
 
-    void handleTimeout(std::string nsm_request);
-    void handleNoTimeout(std::string nsm_request);
     void logTimeOutFailure();
 
     static void logFailuresForAllEids();
@@ -58,9 +101,28 @@ class DeviceRequestTimeOutTracker
     DeviceRequestTimeOutTracker(const DeviceRequestTimeOutTracker&) = delete;
     DeviceRequestTimeOutTracker&
         operator=(const DeviceRequestTimeOutTracker&) = delete;
-    static const size_t MAXSIZE = 1;
-    std::deque<std::string> messages;
-    std::optional<std::string> firstTimeoutMessage;
+
+    void record(uint8_t messageType, uint8_t command, uint8_t instanceId,
+                std::chrono::microseconds latency,
+                FlightRecord::Outcome outcome)
+    {
+        auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch());
+        records[next % capacity] = {
+            static_cast<uint64_t>(now.count()),
+            static_cast<uint32_t>(std::min<int64_t>(latency.count(),
+                                                    UINT32_MAX)),
+            messageType, command, instanceId, outcome};
+        next++;
+        if (outcome == FlightRecord::Outcome::Timeout)
+        {
+            numTimeouts++;
+        }
+    }
+
+    std::array<FlightRecord, capacity> records{};
+    uint64_t next = 0; //!< number of requests recorded since the start
+    uint64_t numTimeouts = 0;
     eid_t eid;
 };
 
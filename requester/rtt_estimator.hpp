@@ -0,0 +1,225 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "common/types.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+namespace requester
+{
+
+/** @class RttEstimator
+ *
+ *  Smoothed round trip time and round trip time variation of the responses
+ *  of an endpoint, following the TCP retransmission timer of RFC 6298.
+ */
+class RttEstimator
+{
+  public:
+    using Duration = std::chrono::microseconds;
+
+    /** @brief Clock granularity added to the variation, one wheel tick */
+    static constexpr Duration granularity = std::chrono::milliseconds(1);
+
+    /** @brief Largest number of doublings of the timeout after expiries */
+    static constexpr uint8_t maxBackoff = 6;
+
+    /** @brief Account the round trip time of a request which was sent once
+     *
+     *  @param[in] rtt - time between sending the request and its response
+     */
+    void addSample(Duration rtt)
+    {
+        if (!samples)
+        {
+            srtt = rtt;
+            rttvar = rtt / 2;
+        }
+        else
+        {
+            auto delta = srtt > rtt ? srtt - rtt : rtt - srtt;
+            rttvar = (3 * rttvar + delta) / 4;
+            srtt = (7 * srtt + rtt) / 8;
+        }
+        samples++;
+        backoffShift = 0;
+    }
+
+    /** @brief Double the timeout after a request expired without response,
+     *         until the next sample
+     */
+    void backoff()
+    {
+        backoffShift = std::min<uint8_t>(backoffShift + 1, maxBackoff);
+    }
+
+    bool hasSamples() const
+    {
+        return samples != 0;
+    }
+
+    uint64_t getSamples() const
+    {
+        return samples;
+    }
+
+    Duration getSmoothedRtt() const
+    {
+        return srtt;
+    }
+
+    Duration getRttVariation() const
+    {
+        return rttvar;
+    }
+
+    /** @brief Get the retransmission timeout
+     *
+     *  @param[in] initial - timeout to use before the first sample
+     *  @param[in] floor - lower bound of the timeout
+     *  @param[in] ceiling - upper bound of the timeout
+     *
+     *  @return SRTT + max(G, 4 * RTTVAR), doubled per backoff and clamped
+     */
+    std::chrono::milliseconds timeout(std::chrono::milliseconds initial,
+                                      std::chrono::milliseconds floor,
+                                      std::chrono::milliseconds ceiling) const
+    {
+        auto rto = samples ? srtt + std::max(granularity, 4 * rttvar)
+                           : Duration(initial);
+        rto *= 1 << backoffShift;
+        return std::clamp(std::chrono::ceil<std::chrono::milliseconds>(rto),
+                          floor, ceiling);
+    }
+
+  private:
+    Duration srtt{0};
+    Duration rttvar{0};
+    uint64_t samples = 0;
+    uint8_t backoffShift = 0;
+};
+
+/** @class ResponseTimeoutPolicy
+ *
+ *  Derives the retry timeout and the instance ID expiry interval of NSM
+ *  requests from the round trip times measured per EID and per command. A
+ *  command without samples uses the estimate of its EID, an EID without
+ *  samples uses the ceiling.
+ */
+class ResponseTimeoutPolicy
+{
+  public:
+    /** @brief Constructor
+     *
+     *  @param[in] floor - lower bound of the retry timeout
+     *  @param[in] ceiling - upper bound and initial value of the retry
+     * timeout
+     *  @param[in] expiryCeiling - upper bound of the instance ID expiry
+     * interval
+     */
+    ResponseTimeoutPolicy(std::chrono::milliseconds floor,
+                          std::chrono::milliseconds ceiling,
+                          std::chrono::milliseconds expiryCeiling) :
+        floor(std::min(floor, ceiling)),
+        ceiling(ceiling), expiryCeiling(expiryCeiling)
+    {}
+
+    /** @brief Get the timeout before the first retry of a request */
+    std::chrono::milliseconds timeout(eid_t eid, uint8_t type,
+                                      uint8_t command) const
+    {
+        auto entry = commands.find(commandKey(eid, type, command));
+        if (entry != commands.end() && entry->second.hasSamples())
+        {
+            return entry->second.timeout(ceiling, floor, ceiling);
+        }
+        auto eidEntry = eids.find(eid);
+        if (eidEntry != eids.end())
+        {
+            return eidEntry->second.timeout(ceiling, floor, ceiling);
+        }
+        return ceiling;
+    }
+
+    /** @brief Get the next retry timeout, retries back off exponentially */
+    std::chrono::milliseconds
+        nextTimeout(std::chrono::milliseconds timeout) const
+    {
+        return std::min(timeout * 2, ceiling);
+    }
+
+    /** @brief Get the instance ID expiry interval of a request, covering the
+     *         first attempt and every retry
+     *
+     *  @param[in] timeout - timeout before the first retry
+     *  @param[in] numRetries - number of retries
+     */
+    std::chrono::milliseconds expiryInterval(std::chrono::milliseconds timeout,
+                                             uint8_t numRetries) const
+    {
+        auto interval = timeout;
+        for (uint8_t i = 0; i < numRetries && interval < expiryCeiling; i++)
+        {
+            timeout = nextTimeout(timeout);
+            interval += timeout;
+        }
+        return std::min(interval, expiryCeiling);
+    }
+
+    /** @brief Account the round trip time of a request sent once */
+    void addSample(eid_t eid, uint8_t type, uint8_t command,
+                   RttEstimator::Duration rtt)
+    {
+        eids[eid].addSample(rtt);
+        commands[commandKey(eid, type, command)].addSample(rtt);
+    }
+
+    /** @brief Back off the timeouts after a request expired */
+    void backoff(eid_t eid, uint8_t type, uint8_t command)
+    {
+        eids[eid].backoff();
+        commands[commandKey(eid, type, command)].backoff();
+    }
+
+    /** @brief Get the estimator of an EID, nullptr before its first request
+     */
+    const RttEstimator* getEstimator(eid_t eid) const
+    {
+        auto entry = eids.find(eid);
+        return entry == eids.end() ? nullptr : &entry->second;
+    }
+
+  private:
+    static constexpr uint32_t commandKey(eid_t eid, uint8_t type,
+                                         uint8_t command)
+    {
+        return (static_cast<uint32_t>(eid) << 16) | (type << 8) | command;
+    }
+
+    std::chrono::milliseconds floor;
+    std::chrono::milliseconds ceiling;
+    std::chrono::milliseconds expiryCeiling;
+
+    std::unordered_map<eid_t, RttEstimator> eids;
+    std::unordered_map<uint32_t, RttEstimator> commands;
+};
+
+} // namespace requester
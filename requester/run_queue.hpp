@@ -0,0 +1,193 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "common/types.hpp"
+
+#include <function2/function2.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/event.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+namespace requester
+{
+
+/** @struct RunQueueStats
+ *
+ *  Counters of the run queue. The resume latency is the time between posting
+ *  a task and running it, latencyHistogram[i] counts the latencies below
+ *  2^i microseconds and its last bucket the longer ones.
+ */
+struct RunQueueStats
+{
+    uint64_t posted = 0;
+    uint64_t run = 0;
+    uint64_t batches = 0;
+    size_t maxDepth = 0;
+    std::chrono::steady_clock::duration totalLatency{};
+    std::chrono::steady_clock::duration maxLatency{};
+    std::array<uint64_t, 16> latencyHistogram{};
+};
+
+/** @class RunQueue
+ *
+ *  Executor of the continuations posted by I/O completions, e.g. resuming a
+ *  coroutine once the response it awaits is received. The tasks run from a
+ *  deferred event source in batches of at most batchSize, so a chain of
+ *  requests of one device neither runs on the stack of the I/O callback nor
+ *  holds off the sockets and the other devices. Tasks are taken round robin
+ *  across the EIDs they are posted for, in posting order for each EID.
+ *
+ *  With a batch size of 0 the tasks run as soon as they are posted.
+ */
+class RunQueue
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Task = fu2::unique_function<void()>;
+
+    RunQueue() = delete;
+    RunQueue(const RunQueue&) = delete;
+    RunQueue(RunQueue&&) = delete;
+    RunQueue& operator=(const RunQueue&) = delete;
+    RunQueue& operator=(RunQueue&&) = delete;
+    ~RunQueue() = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] event - event loop running the tasks
+     *  @param[in] batchSize - tasks run per event loop iteration
+     */
+    explicit RunQueue(sdeventplus::Event& event, size_t batchSize) :
+        event(event), batchSize(batchSize)
+    {}
+
+    /** @brief Run a task from the event loop
+     *
+     *  @param[in] eid - endpoint the task continues the work of
+     *  @param[in] task - task to run
+     */
+    void post(eid_t eid, Task&& task)
+    {
+        stats.posted++;
+        if (batchSize == 0)
+        {
+            record(Clock::duration::zero());
+            task();
+            return;
+        }
+
+        auto& queue = queues[eid];
+        if (queue.empty())
+        {
+            ready.push_back(eid);
+        }
+        queue.push_back({std::move(task), Clock::now()});
+        numQueued++;
+        stats.maxDepth = std::max(stats.maxDepth, numQueued);
+
+        if (!source)
+        {
+            source = std::make_unique<sdeventplus::source::Defer>(
+                event, [this](sdeventplus::source::EventBase&) { runBatch(); });
+        }
+        source->set_enabled(sdeventplus::source::Enabled::On);
+    }
+
+    /** @brief Run up to batchSize of the queued tasks. Called by the event
+     *         loop, exposed for unit tests.
+     */
+    void runBatch()
+    {
+        stats.batches++;
+        for (size_t n = std::min(batchSize, numQueued); n > 0; n--)
+        {
+            auto eid = ready.front();
+            ready.pop_front();
+            auto& queue = queues[eid];
+            auto entry = std::move(queue.front());
+            queue.pop_front();
+            if (!queue.empty())
+            {
+                ready.push_back(eid);
+            }
+            numQueued--;
+
+            record(Clock::now() - entry.posted);
+            // the task may post further tasks
+            entry.task();
+        }
+
+        if (numQueued == 0 && source)
+        {
+            source->set_enabled(sdeventplus::source::Enabled::Off);
+        }
+    }
+
+    /** @brief Get the number of tasks waiting to run */
+    size_t size() const
+    {
+        return numQueued;
+    }
+
+    /** @brief Get the counters of the run queue */
+    const RunQueueStats& getStats() const
+    {
+        return stats;
+    }
+
+  private:
+    struct Entry
+    {
+        Task task;
+        Clock::time_point posted;
+    };
+
+    void record(Clock::duration latency)
+    {
+        stats.run++;
+        stats.totalLatency += latency;
+        stats.maxLatency = std::max(stats.maxLatency, latency);
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency)
+                      .count();
+        size_t bucket = std::bit_width(static_cast<uint64_t>(us));
+        stats.latencyHistogram[std::min(bucket,
+                                        stats.latencyHistogram.size() - 1)]++;
+    }
+
+    sdeventplus::Event& event;
+    size_t batchSize;
+    std::unique_ptr<sdeventplus::source::Defer> source;
+
+    /** @brief Queued tasks of each EID */
+    std::unordered_map<eid_t, std::deque<Entry>> queues;
+
+    /** @brief EIDs with queued tasks, in the order they are served */
+    std::deque<eid_t> ready;
+
+    size_t numQueued = 0;
+    RunQueueStats stats;
+};
+
+} // namespace requester
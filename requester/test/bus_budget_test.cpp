@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "requester/bus_budget.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace requester;
+using namespace std::chrono_literals;
+
+TEST(BusBudgetTest, RequestRateRefills)
+{
+    auto t0 = BusBudget::Clock::time_point{};
+    // 100 requests per second, a burst of 10
+    BusBudget budget(100, 0, t0);
+    EXPECT_TRUE(budget.isLimited());
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_TRUE(budget.tryAcquire(64, t0));
+    }
+    EXPECT_FALSE(budget.tryAcquire(64, t0));
+    EXPECT_EQ(budget.getDelay(64, t0), 10ms);
+
+    EXPECT_FALSE(budget.tryAcquire(64, t0 + 9ms));
+    EXPECT_TRUE(budget.tryAcquire(64, t0 + 10ms));
+    EXPECT_FALSE(budget.tryAcquire(64, t0 + 10ms));
+
+    // a long idle time refills no more than the burst
+    auto t1 = t0 + 3600s;
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_TRUE(budget.tryAcquire(64, t1));
+    }
+    EXPECT_FALSE(budget.tryAcquire(64, t1));
+
+    auto& stats = budget.getStats();
+    EXPECT_EQ(stats.requests, 21u);
+    EXPECT_EQ(stats.bytes, 21u * 64);
+}
+
+TEST(BusBudgetTest, LargeRequestGoesIntoDebt)
+{
+    auto t0 = BusBudget::Clock::time_point{};
+    // 1000 bytes per second, a burst of 100 bytes
+    BusBudget budget(0, 1000, t0);
+    EXPECT_TRUE(budget.tryAcquire(40, t0));
+    EXPECT_FALSE(budget.tryAcquire(200, t0));
+    EXPECT_EQ(budget.getDelay(200, t0), 40ms);
+
+    // sent once the bucket is full, then repays the 100 extra bytes
+    EXPECT_TRUE(budget.tryAcquire(200, t0 + 40ms));
+    EXPECT_FALSE(budget.tryAcquire(1, t0 + 40ms));
+    EXPECT_EQ(budget.getDelay(1, t0 + 40ms), 101ms);
+    EXPECT_TRUE(budget.tryAcquire(1, t0 + 141ms));
+}
+
+TEST(BusBudgetTest, RefundGivesTheBudgetBack)
+{
+    auto t0 = BusBudget::Clock::time_point{};
+    // 10 requests per second, a burst of a single request
+    BusBudget budget(10, 0, t0);
+    EXPECT_TRUE(budget.tryAcquire(64, t0));
+    EXPECT_FALSE(budget.tryAcquire(64, t0));
+
+    budget.refund(64);
+    EXPECT_EQ(budget.getDelay(64, t0), BusBudget::Clock::duration::zero());
+    EXPECT_TRUE(budget.tryAcquire(64, t0));
+    EXPECT_EQ(budget.getStats().requests, 1u);
+    EXPECT_EQ(budget.getStats().bytes, 64u);
+}
+
+TEST(BusBudgetTest, ZeroRatesDoNotLimit)
+{
+    auto t0 = BusBudget::Clock::time_point{};
+    BusBudget budget(0, 0, t0);
+    EXPECT_FALSE(budget.isLimited());
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(budget.tryAcquire(4096, t0));
+    }
+    EXPECT_EQ(budget.getDelay(4096, t0), BusBudget::Clock::duration::zero());
+}
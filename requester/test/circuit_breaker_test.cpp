@@ -0,0 +1,80 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "requester/circuit_breaker.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace requester;
+using namespace std::chrono_literals;
+using State = CircuitBreaker::State;
+
+TEST(CircuitBreakerTest, OpensAfterConsecutiveTimeouts)
+{
+    CircuitBreaker breaker(3, 1000ms, 8000ms);
+    EXPECT_FALSE(breaker.onTimeout());
+    EXPECT_FALSE(breaker.onTimeout());
+    // a response resets the count
+    EXPECT_FALSE(breaker.onResponse());
+    EXPECT_FALSE(breaker.onTimeout());
+    EXPECT_FALSE(breaker.onTimeout());
+    EXPECT_TRUE(breaker.isClosed());
+
+    EXPECT_TRUE(breaker.onTimeout());
+    EXPECT_EQ(breaker.getState(), State::Open);
+    EXPECT_EQ(breaker.getOpenCount(), 1u);
+    // already open
+    EXPECT_FALSE(breaker.onTimeout());
+    EXPECT_EQ(breaker.getOpenCount(), 1u);
+}
+
+TEST(CircuitBreakerTest, ProbesBackOffAndResponseCloses)
+{
+    CircuitBreaker breaker(1, 1000ms, 3000ms);
+    EXPECT_TRUE(breaker.onTimeout());
+    EXPECT_EQ(breaker.getProbeInterval(), 1000ms);
+
+    breaker.onProbe();
+    EXPECT_EQ(breaker.getState(), State::HalfOpen);
+    breaker.onProbeFailure();
+    EXPECT_EQ(breaker.getState(), State::Open);
+    EXPECT_EQ(breaker.getProbeInterval(), 2000ms);
+
+    breaker.onProbe();
+    breaker.onProbeFailure();
+    EXPECT_EQ(breaker.getProbeInterval(), 3000ms);
+    EXPECT_EQ(breaker.getProbeCount(), 2u);
+
+    breaker.onProbe();
+    EXPECT_TRUE(breaker.onResponse());
+    EXPECT_TRUE(breaker.isClosed());
+    EXPECT_EQ(breaker.getCloseCount(), 1u);
+
+    // the backoff starts over when the breaker opens again
+    EXPECT_TRUE(breaker.onTimeout());
+    EXPECT_EQ(breaker.getProbeInterval(), 1000ms);
+    EXPECT_EQ(breaker.getOpenCount(), 2u);
+}
+
+TEST(CircuitBreakerTest, ZeroThresholdNeverOpens)
+{
+    CircuitBreaker breaker(0, 1000ms, 8000ms);
+    for (int i = 0; i < 300; i++)
+    {
+        EXPECT_FALSE(breaker.onTimeout());
+    }
+    EXPECT_TRUE(breaker.isClosed());
+}
@@ -0,0 +1,799 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "libnsm/base.h"
+
+#include "common/coroutine.hpp"
+#include "common/types.hpp"
+#include "nsmd/eventManager.hpp"
+#include "nsmd/instance_id.hpp"
+#include "nsmd/socket_handler.hpp"
+#include "nsmd/socket_manager.hpp"
+#include "requester/handler.hpp"
+#include "requester/request.hpp"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sdeventplus/event.hpp>
+
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace requester;
+using ::testing::_;
+using ::testing::NiceMock;
+
+/** @brief Number of heap allocations made by the test binary */
+static size_t numAllocations = 0;
+
+void* operator new(std::size_t size)
+{
+    numAllocations++;
+    if (auto ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+class MockSocketHandler : public mctp_socket::Handler
+{
+  public:
+    using mctp_socket::Handler::Handler;
+
+    MOCK_METHOD(int, registerMctpEndpoint,
+                (eid_t eid, int type, int protocol,
+                 const std::vector<uint8_t>& pathName),
+                (override));
+    MOCK_METHOD(int, sendMsg,
+                (uint8_t tag, eid_t eid, int mctpFd, const uint8_t* nsmMsg,
+                 size_t nsmMsgLen, std::optional<uint8_t> instanceId),
+                (const, override));
+
+  private:
+    void handleReceivedMsg(mctp_socket::IO&, int, uint32_t) override {}
+};
+
+/** @brief Socket handler recording the instance IDs sent, without the
+ *         allocations of a mock
+ */
+class RecordingSocketHandler : public mctp_socket::Handler
+{
+  public:
+    using mctp_socket::Handler::Handler;
+
+    int registerMctpEndpoint(eid_t, int, int,
+                             const std::vector<uint8_t>&) override
+    {
+        return NSM_SW_SUCCESS;
+    }
+
+    int sendMsg(uint8_t, eid_t, int, const uint8_t*, size_t,
+                std::optional<uint8_t> instanceId) const override
+    {
+        sentInstanceIds[numSent++ % sentInstanceIds.size()] =
+            instanceId.value_or(0xff);
+        return NSM_SW_SUCCESS;
+    }
+
+    mutable std::array<uint8_t, 256> sentInstanceIds{};
+    mutable size_t numSent = 0;
+
+  private:
+    void handleReceivedMsg(mctp_socket::IO&, int, uint32_t) override {}
+};
+
+static std::string createInstanceIdDb()
+{
+    std::string path = std::filesystem::temp_directory_path() /
+                       "nsmd-handler-test-XXXXXX";
+    int fd = mkstemp(path.data());
+    EXPECT_NE(fd, -1);
+    // one lock byte per (EID, instance ID) pair
+    EXPECT_EQ(ftruncate(fd, 256 * (NSM_INSTANCE_MAX + 1)), 0);
+    close(fd);
+    return path;
+}
+
+class HandlerTest : public testing::Test
+{
+  protected:
+    static constexpr eid_t eid = 9;
+    static constexpr uint8_t window = 2;
+
+    HandlerTest() :
+        event(sdeventplus::Event::get_default()), dbPath(createInstanceIdDb()),
+        instanceIdDb(dbPath),
+        handler(event, instanceIdDb, sockManager, false,
+                std::chrono::seconds(1), 2, std::chrono::milliseconds(100),
+                window),
+        sockHandler(event, handler, eventManager, sockManager, false)
+    {
+        handler.setSocketHandler(&sockHandler);
+        sockManager.registerEndpoint(eid, 0, 4096);
+        ON_CALL(sockHandler, sendMsg(_, _, _, _, _, _))
+            .WillByDefault([this](uint8_t, eid_t, int, const uint8_t*, size_t,
+                                  std::optional<uint8_t> instanceId) {
+            EXPECT_TRUE(instanceId.has_value());
+            sentInstanceIds.push_back(instanceId.value_or(0xff));
+            return NSM_SW_SUCCESS;
+        });
+    }
+
+    ~HandlerTest()
+    {
+        std::filesystem::remove(dbPath);
+    }
+
+    /** @brief Ping request, the tag makes it differ from other pings so it
+     *         is not coalesced with them
+     */
+    std::vector<uint8_t> pingRequest(uint8_t tag)
+    {
+        std::vector<uint8_t> request(sizeof(nsm_msg_hdr) +
+                                     sizeof(nsm_common_req));
+        auto msg = reinterpret_cast<nsm_msg*>(request.data());
+        encode_ping_req(0, msg);
+        reinterpret_cast<nsm_common_req*>(msg->payload)->data_size = tag;
+        return request;
+    }
+
+    std::vector<uint8_t> pingResponse(uint8_t instanceId)
+    {
+        std::vector<uint8_t> response(sizeof(nsm_msg_hdr) +
+                                      sizeof(nsm_common_resp));
+        encode_ping_resp(instanceId, ERR_NULL,
+                         reinterpret_cast<nsm_msg*>(response.data()));
+        return response;
+    }
+
+    int registerPing(size_t index,
+                     RequestClass requestClass = RequestClass::RoundRobin,
+                     uint8_t tag = 0xff)
+    {
+        return handler.registerRequest(
+            MCTP_MSG_TAG_REQ, eid, NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY,
+            NSM_PING, pingRequest(tag == 0xff ? index : tag),
+            [this, index](eid_t, std::shared_ptr<const nsm_msg> response,
+                          size_t) {
+            completed.emplace_back(index, response != nullptr);
+            retained = std::move(response);
+        },
+            requestClass);
+    }
+
+    void respond(uint8_t instanceId)
+    {
+        auto response =
+            std::make_shared<std::vector<uint8_t>>(pingResponse(instanceId));
+        handler.handleResponse(MCTP_MSG_TAG_REQ, eid, instanceId,
+                               NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY, NSM_PING,
+                               std::shared_ptr<const nsm_msg>(
+                                   response, reinterpret_cast<const nsm_msg*>(
+                                                 response->data())),
+                               response->size());
+    }
+
+    sdeventplus::Event event;
+    std::string dbPath;
+    nsm::InstanceIdDb instanceIdDb;
+    mctp_socket::Manager sockManager;
+    nsm::EventManager eventManager;
+    requester::Handler<requester::Request> handler;
+    NiceMock<MockSocketHandler> sockHandler;
+
+    std::vector<uint8_t> sentInstanceIds;
+    std::vector<std::pair<size_t, bool>> completed;
+    std::shared_ptr<const nsm_msg> retained;
+};
+
+TEST_F(HandlerTest, WindowLimitsOutstandingRequests)
+{
+    for (size_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(registerPing(i), NSM_SUCCESS);
+    }
+
+    EXPECT_EQ(sentInstanceIds.size(), window);
+    EXPECT_NE(sentInstanceIds[0], sentInstanceIds[1]);
+    EXPECT_EQ(handler.getNumOutstandingRequests(eid), window);
+    EXPECT_EQ(handler.getNumQueuedRequests(eid), 1u);
+}
+
+TEST_F(HandlerTest, ResponseMatchedByInstanceId)
+{
+    for (size_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(registerPing(i), NSM_SUCCESS);
+    }
+
+    // answer the second request first
+    respond(sentInstanceIds[1]);
+    ASSERT_EQ(completed.size(), 1u);
+    EXPECT_EQ(completed[0], std::make_pair(size_t(1), true));
+
+    // the freed slot is used by the queued request
+    ASSERT_EQ(sentInstanceIds.size(), 3u);
+    EXPECT_EQ(handler.getNumOutstandingRequests(eid), window);
+    EXPECT_EQ(handler.getNumQueuedRequests(eid), 0u);
+
+    respond(sentInstanceIds[0]);
+    respond(sentInstanceIds[2]);
+    ASSERT_EQ(completed.size(), 3u);
+    EXPECT_EQ(completed[1], std::make_pair(size_t(0), true));
+    EXPECT_EQ(completed[2], std::make_pair(size_t(2), true));
+    EXPECT_EQ(handler.getNumOutstandingRequests(eid), 0u);
+}
+
+TEST_F(HandlerTest, UserRequestOvertakesQueuedTelemetry)
+{
+    EXPECT_EQ(registerPing(0, RequestClass::Priority), NSM_SUCCESS);
+    EXPECT_EQ(registerPing(1, RequestClass::Priority), NSM_SUCCESS);
+    EXPECT_EQ(registerPing(2, RequestClass::Background), NSM_SUCCESS);
+    EXPECT_EQ(registerPing(3, RequestClass::RoundRobin), NSM_SUCCESS);
+    EXPECT_EQ(registerPing(4, RequestClass::User), NSM_SUCCESS);
+    EXPECT_EQ(handler.getNumQueuedRequests(eid), 3u);
+
+    for (size_t i = 0; i < 5; i++)
+    {
+        respond(sentInstanceIds[i]);
+    }
+
+    ASSERT_EQ(completed.size(), 5u);
+    EXPECT_EQ(completed[2].first, 4u);
+    EXPECT_EQ(completed[3].first, 3u);
+    EXPECT_EQ(completed[4].first, 2u);
+
+    const auto& user = handler.getRequestClassStats(RequestClass::User);
+    EXPECT_EQ(user.requests, 1u);
+    EXPECT_EQ(user.queued, 1u);
+    EXPECT_EQ(handler.getRequestClassStats(RequestClass::Priority).queued, 0u);
+    EXPECT_LE(user.maxDelay, handler.getRequestClassStats(
+                                 RequestClass::Background).maxDelay);
+}
+
+TEST_F(HandlerTest, TimeoutAdaptsToRoundTripTime)
+{
+    auto timeout = [this] {
+        return handler.getResponseTimeOut(
+            eid, NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY, NSM_PING);
+    };
+    EXPECT_EQ(timeout(), std::chrono::milliseconds(100));
+    EXPECT_EQ(handler.getRttEstimator(eid), nullptr);
+
+    EXPECT_EQ(registerPing(0), NSM_SUCCESS);
+    respond(sentInstanceIds[0]);
+
+    ASSERT_NE(handler.getRttEstimator(eid), nullptr);
+    EXPECT_EQ(handler.getRttEstimator(eid)->getSamples(), 1u);
+    // the loopback round trip is far below the floor
+    EXPECT_EQ(timeout(), std::chrono::milliseconds(RESPONSE_TIME_OUT_MIN));
+}
+
+TEST_F(HandlerTest, IdenticalRequestsAreCoalesced)
+{
+    EXPECT_EQ(registerPing(0, RequestClass::RoundRobin, 7), NSM_SUCCESS);
+    EXPECT_EQ(registerPing(1, RequestClass::Priority, 7), NSM_SUCCESS);
+    EXPECT_EQ(registerPing(2, RequestClass::RoundRobin, 8), NSM_SUCCESS);
+    // user initiated requests are always sent
+    EXPECT_EQ(registerPing(3, RequestClass::User, 7), NSM_SUCCESS);
+
+    EXPECT_EQ(handler.getNumCoalescedRequests(), 1u);
+    EXPECT_EQ(sentInstanceIds.size(), window);
+    EXPECT_EQ(handler.getNumQueuedRequests(eid), 1u);
+
+    respond(sentInstanceIds[0]);
+    ASSERT_EQ(completed.size(), 2u);
+    EXPECT_EQ(completed[0], std::make_pair(size_t(0), true));
+    EXPECT_EQ(completed[1], std::make_pair(size_t(1), true));
+
+    // the response completed the pending request, the same request is sent
+    // again
+    EXPECT_EQ(registerPing(4, RequestClass::RoundRobin, 7), NSM_SUCCESS);
+    EXPECT_EQ(handler.getNumCoalescedRequests(), 1u);
+    EXPECT_EQ(handler.getNumQueuedRequests(eid), 1u);
+}
+
+TEST_F(HandlerTest, ResponseOutlivesDispatch)
+{
+    EXPECT_EQ(registerPing(0), NSM_SUCCESS);
+    ASSERT_EQ(sentInstanceIds.size(), 1u);
+
+    respond(sentInstanceIds[0]);
+    ASSERT_NE(retained, nullptr);
+    EXPECT_EQ(retained.use_count(), 1);
+    EXPECT_EQ(retained->hdr.instance_id, sentInstanceIds[0]);
+    EXPECT_EQ(retained->payload[0], NSM_PING);
+}
+
+TEST_F(HandlerTest, TimersShareTheWheel)
+{
+    for (size_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(registerPing(i), NSM_SUCCESS);
+    }
+
+    // a retry and an instance ID expiry timer per outstanding request
+    EXPECT_EQ(handler.getNumActiveTimers(), 2 * window);
+
+    respond(sentInstanceIds[0]);
+    respond(sentInstanceIds[1]);
+    EXPECT_EQ(handler.getNumActiveTimers(), 2u);
+
+    respond(sentInstanceIds[2]);
+    EXPECT_EQ(handler.getNumActiveTimers(), 0u);
+}
+
+TEST_F(HandlerTest, UnknownInstanceIdIsIgnored)
+{
+    EXPECT_EQ(registerPing(0), NSM_SUCCESS);
+    ASSERT_EQ(sentInstanceIds.size(), 1u);
+
+    respond((sentInstanceIds[0] + 1) & INSTANCEID_MASK);
+    EXPECT_TRUE(completed.empty());
+    EXPECT_EQ(handler.getNumOutstandingRequests(eid), 1u);
+}
+
+TEST_F(HandlerTest, SendFailureIsReturnedToCaller)
+{
+    EXPECT_CALL(sockHandler, sendMsg(_, _, _, _, _, _))
+        .WillOnce(testing::Return(-1));
+
+    EXPECT_NE(registerPing(0), NSM_SUCCESS);
+    EXPECT_TRUE(completed.empty());
+    EXPECT_EQ(handler.getNumOutstandingRequests(eid), 0u);
+    EXPECT_EQ(handler.getNumQueuedRequests(eid), 0u);
+}
+
+TEST_F(HandlerTest, RequestTemplateIsSentWithoutCopy)
+{
+    RequestTemplate requestTemplate =
+        std::make_shared<const std::vector<uint8_t>>(pingRequest(0));
+    std::vector<const uint8_t*> sentMessages;
+    ON_CALL(sockHandler, sendMsg(_, _, _, _, _, _))
+        .WillByDefault([&](uint8_t, eid_t, int, const uint8_t* nsmMsg, size_t,
+                           std::optional<uint8_t> instanceId) {
+        sentInstanceIds.push_back(instanceId.value_or(0xff));
+        sentMessages.push_back(nsmMsg);
+        return NSM_SW_SUCCESS;
+    });
+
+    // user requests are not coalesced, both are sent from the template
+    for (size_t i = 0; i < 2; i++)
+    {
+        EXPECT_EQ(handler.registerRequest(
+                      MCTP_MSG_TAG_REQ, eid,
+                      NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY, NSM_PING,
+                      requestTemplate,
+                      [this, i](eid_t, std::shared_ptr<const nsm_msg> response,
+                                size_t) {
+            completed.emplace_back(i, response != nullptr);
+        },
+                      RequestClass::User),
+                  NSM_SUCCESS);
+    }
+
+    ASSERT_EQ(sentMessages.size(), 2u);
+    EXPECT_EQ(sentMessages[0], requestTemplate->data());
+    EXPECT_EQ(sentMessages[1], requestTemplate->data());
+    EXPECT_NE(sentInstanceIds[0], sentInstanceIds[1]);
+    EXPECT_EQ(*requestTemplate, pingRequest(0));
+    EXPECT_EQ(requestTemplate.use_count(), 3);
+
+    respond(sentInstanceIds[1]);
+    respond(sentInstanceIds[0]);
+    ASSERT_EQ(completed.size(), 2u);
+    EXPECT_EQ(completed[0], std::make_pair(size_t(1), true));
+    EXPECT_EQ(completed[1], std::make_pair(size_t(0), true));
+    EXPECT_EQ(requestTemplate.use_count(), 1);
+}
+
+TEST_F(HandlerTest, CoroutineResumesFromRunQueue)
+{
+    if (RUN_QUEUE_BATCH_SIZE == 0)
+    {
+        GTEST_SKIP() << "coroutines are resumed from the I/O callback";
+    }
+
+    bool resumed = false;
+    uint8_t rc = NSM_ERROR;
+    size_t responseLen = 0;
+    auto coroutine = [&]() -> Coroutine {
+        auto request = pingRequest(0);
+        std::shared_ptr<const nsm_msg> response;
+        rc = co_await SendRecvNsmMsg<Handler<requester::Request>>(
+            handler, eid, request, &response, &responseLen);
+        resumed = true;
+        co_return rc;
+    };
+    auto task = coroutine();
+    ASSERT_EQ(sentInstanceIds.size(), 1u);
+
+    respond(sentInstanceIds[0]);
+    EXPECT_FALSE(resumed);
+    EXPECT_EQ(handler.getRunQueue().size(), 1u);
+
+    handler.getRunQueue().runBatch();
+    EXPECT_TRUE(resumed);
+    EXPECT_EQ(rc, NSM_SW_SUCCESS);
+    EXPECT_EQ(responseLen, pingResponse(0).size());
+}
+
+TEST_F(HandlerTest, SteadyStateRequestsDoNotAllocate)
+{
+    RecordingSocketHandler recorder(event, handler, eventManager, sockManager,
+                                    false);
+    handler.setSocketHandler(&recorder);
+
+    std::array<RequestTemplate, 3> requestTemplates;
+    for (size_t i = 0; i < requestTemplates.size(); i++)
+    {
+        requestTemplates[i] =
+            std::make_shared<const std::vector<uint8_t>>(pingRequest(i));
+    }
+    std::array<std::shared_ptr<const nsm_msg>, NSM_INSTANCE_MAX + 1> responses;
+    for (uint8_t id = 0; id <= NSM_INSTANCE_MAX; id++)
+    {
+        auto response =
+            std::make_shared<const std::vector<uint8_t>>(pingResponse(id));
+        responses[id] = std::shared_ptr<const nsm_msg>(
+            response, reinterpret_cast<const nsm_msg*>(response->data()));
+    }
+    auto responseLen = pingResponse(0).size();
+
+    size_t numResponses = 0;
+    size_t numAnswered = 0;
+    auto round = [&] {
+        // one more request than the window, so one is queued, and one
+        // identical to the first, which attaches to it
+        for (size_t i = 0; i <= requestTemplates.size(); i++)
+        {
+            EXPECT_EQ(handler.registerRequest(
+                          MCTP_MSG_TAG_REQ, eid,
+                          NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY, NSM_PING,
+                          requestTemplates[i % requestTemplates.size()],
+                          [&numResponses](eid_t,
+                                          std::shared_ptr<const nsm_msg>,
+                                          size_t) { numResponses++; }),
+                      NSM_SUCCESS);
+        }
+        while (numAnswered < recorder.numSent)
+        {
+            auto id = recorder.sentInstanceIds[numAnswered++ %
+                                               recorder.sentInstanceIds.size()];
+            handler.handleResponse(MCTP_MSG_TAG_REQ, eid, id,
+                                   NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY,
+                                   NSM_PING, responses[id], responseLen);
+        }
+    };
+
+    // the first rounds create the pooled slots and the per EID state
+    for (size_t i = 0; i < 4; i++)
+    {
+        round();
+    }
+
+    auto allocations = numAllocations;
+    for (size_t i = 0; i < 100; i++)
+    {
+        round();
+    }
+    EXPECT_EQ(numAllocations, allocations);
+
+    EXPECT_EQ(numResponses, 104u * 4);
+    EXPECT_EQ(handler.getNumOutstandingRequests(eid), 0u);
+    const auto stats = handler.getRequestPoolStats(eid);
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->inUse, 0u);
+    EXPECT_EQ(stats->peakInUse, 4u);
+    EXPECT_EQ(stats->slots, 4u);
+    EXPECT_EQ(stats->overflows, 0u);
+}
+
+TEST_F(HandlerTest, EndpointsOfABusTakeTurns)
+{
+    constexpr eid_t otherEid = eid + 1;
+    sockManager.registerEndpoint(otherEid, 0, 4096);
+    std::vector<std::pair<eid_t, uint8_t>> sent;
+    ON_CALL(sockHandler, sendMsg(_, _, _, _, _, _))
+        .WillByDefault([&sent](uint8_t, eid_t eid, int, const uint8_t*, size_t,
+                               std::optional<uint8_t> instanceId) {
+        sent.emplace_back(eid, instanceId.value_or(0xff));
+        return NSM_SW_SUCCESS;
+    });
+
+    // 10 requests per second, a burst of a single request
+    handler.setEndpointBus(eid, "smbus", 10, 0);
+    handler.setEndpointBus(otherEid, "smbus", 10, 0);
+    EXPECT_EQ(handler.getBusBudgetStats("pcie"), nullptr);
+
+    for (auto endpointId : {eid, otherEid})
+    {
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            EXPECT_EQ(handler.registerRequest(
+                          MCTP_MSG_TAG_REQ, endpointId,
+                          NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY, NSM_PING,
+                          pingRequest(i),
+                          [](eid_t, std::shared_ptr<const nsm_msg>, size_t) {}),
+                      NSM_SUCCESS);
+        }
+    }
+    ASSERT_EQ(sent.size(), 1u);
+
+    size_t numAnswered = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (sent.size() < 6 &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+    {
+        for (; numAnswered < sent.size(); numAnswered++)
+        {
+            auto [endpointId, instanceId] = sent[numAnswered];
+            auto response = std::make_shared<std::vector<uint8_t>>(
+                pingResponse(instanceId));
+            handler.handleResponse(
+                MCTP_MSG_TAG_REQ, endpointId, instanceId,
+                NSM_TYPE_DEVICE_CAPABILITY_DISCOVERY, NSM_PING,
+                std::shared_ptr<const nsm_msg>(
+                    response,
+                    reinterpret_cast<const nsm_msg*>(response->data())),
+                response->size());
+        }
+        event.run(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_EQ(sent.size(), 6u);
+    std::vector<eid_t> order;
+    for (const auto& [endpointId, instanceId] : sent)
+    {
+        order.push_back(endpointId);
+    }
+    EXPECT_EQ(order, (std::vector<eid_t>{eid, eid, otherEid, eid, otherEid,
+                                         otherEid}));
+    // the budget holds once both EIDs compete for it
+    EXPECT_GE(std::chrono::steady_clock::now() - start,
+              std::chrono::milliseconds(500));
+
+    const auto stats = handler.getBusBudgetStats("smbus");
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->requests, 6u);
+    EXPECT_GT(stats->deferred, 0u);
+}
+
+TEST_F(HandlerTest, RequestWaitsForAFreeInstanceId)
+{
+    // leave a single instance ID of the EID to the handler
+    std::vector<uint8_t> taken;
+    for (uint8_t i = 0; i < NSM_INSTANCE_MAX; i++)
+    {
+        taken.push_back(instanceIdDb.next(eid));
+    }
+
+    EXPECT_EQ(registerPing(0), NSM_SUCCESS);
+    // the window has room but no instance ID is free, the request waits for
+    // the outstanding one rather than failing
+    EXPECT_EQ(registerPing(1), NSM_SUCCESS);
+    ASSERT_EQ(sentInstanceIds.size(), 1u);
+    EXPECT_EQ(handler.getNumOutstandingRequests(eid), 1u);
+    EXPECT_EQ(handler.getNumQueuedRequests(eid), 1u);
+
+    // the allocator does not hand out the instance ID it allocated last
+    // right away, so free another one too
+    instanceIdDb.free(eid, taken.back());
+    taken.pop_back();
+    respond(sentInstanceIds[0]);
+    ASSERT_EQ(sentInstanceIds.size(), 2u);
+    respond(sentInstanceIds[1]);
+    ASSERT_EQ(completed.size(), 2u);
+    EXPECT_EQ(completed[0], std::make_pair(size_t(0), true));
+    EXPECT_EQ(completed[1], std::make_pair(size_t(1), true));
+
+    for (auto id : taken)
+    {
+        instanceIdDb.free(eid, id);
+    }
+}
+
+TEST_F(HandlerTest, RequestWaitingForAnInstanceIdKeepsNoBudget)
+{
+    // 20 requests per second, a burst of two requests
+    handler.setEndpointBus(eid, "smbus", 20, 0);
+
+    std::vector<uint8_t> taken;
+    EXPECT_EQ(registerPing(0), NSM_SUCCESS);
+    for (uint8_t i = 0; i < NSM_INSTANCE_MAX; i++)
+    {
+        taken.push_back(instanceIdDb.next(eid));
+    }
+    // the bus admits the request but no instance ID is free, so it gives
+    // the budget back
+    EXPECT_EQ(registerPing(1), NSM_SUCCESS);
+    ASSERT_EQ(sentInstanceIds.size(), 1u);
+    EXPECT_EQ(handler.getNumQueuedRequests(eid), 1u);
+
+    for (auto id : taken)
+    {
+        instanceIdDb.free(eid, id);
+    }
+    // sent on the response without waiting for the bus
+    respond(sentInstanceIds[0]);
+    ASSERT_EQ(sentInstanceIds.size(), 2u);
+    respond(sentInstanceIds[1]);
+    ASSERT_EQ(completed.size(), 2u);
+
+    const auto stats = handler.getBusBudgetStats("smbus");
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->requests, 2u);
+    EXPECT_EQ(stats->deferred, 0u);
+}
+
+TEST_F(HandlerTest, CoroutineKeepsItsRequestClass)
+{
+    /** @brief Awaitable resumed by the test, standing for a timer or a
+     *         D-Bus call
+     */
+    struct Gate
+    {
+        std::coroutine_handle<> handle;
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+        void await_suspend(std::coroutine_handle<> h) noexcept
+        {
+            handle = h;
+        }
+        void await_resume() const noexcept {}
+    } gate;
+
+    size_t responseLen = 0;
+    std::shared_ptr<const nsm_msg> response;
+    auto send = [&]() -> Coroutine {
+        auto request = pingRequest(0);
+        co_return co_await SendRecvNsmMsg<Handler<requester::Request>>(
+            handler, eid, request, &response, &responseLen);
+    };
+    auto background = [&]() -> Coroutine {
+        co_await gate;
+        co_return co_await send();
+    };
+    auto task = withRequestClass(RequestClass::Background,
+                                 [&] { return background(); });
+    EXPECT_EQ(currentRequestClass(), RequestClass::RoundRobin);
+
+    // a user request resumes the background coroutine, the request the
+    // coroutine sends from a nested one is still a background one
+    {
+        RequestClassScope scope(RequestClass::User);
+        gate.handle.resume();
+        EXPECT_EQ(currentRequestClass(), RequestClass::User);
+    }
+    EXPECT_EQ(handler.getRequestClassStats(RequestClass::Background).requests,
+              1u);
+    EXPECT_EQ(handler.getRequestClassStats(RequestClass::User).requests, 0u);
+
+    ASSERT_EQ(sentInstanceIds.size(), 1u);
+    respond(sentInstanceIds[0]);
+    handler.getRunQueue().runBatch();
+    EXPECT_EQ(currentRequestClass(), RequestClass::RoundRobin);
+    EXPECT_TRUE(task.handle.done());
+}
+
+TEST_F(HandlerTest, OpenCircuitIsProbedInTheBackground)
+{
+    CircuitBreaker::State state = CircuitBreaker::State::Closed;
+    handler.setCircuitStateHandler(
+        [&state](eid_t, const CircuitBreaker& breaker) {
+        state = breaker.getState();
+    });
+
+    // requests without response open the breaker
+    for (size_t i = 0; i < CIRCUIT_BREAKER_THRESHOLD; i++)
+    {
+        EXPECT_EQ(registerPing(i), NSM_SUCCESS);
+    }
+    auto start = std::chrono::steady_clock::now();
+    while (state != CircuitBreaker::State::HalfOpen &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+    {
+        event.run(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(state, CircuitBreaker::State::HalfOpen);
+    EXPECT_FALSE(handler.isEndpointAvailable(eid));
+    EXPECT_EQ(registerPing(0, RequestClass::User), NSM_SW_ERROR_UNAVAILABLE);
+
+    // the probe does not compete with user requests
+    EXPECT_EQ(handler.getRequestClassStats(RequestClass::User).requests, 0u);
+    EXPECT_EQ(handler.getRequestClassStats(RequestClass::Background).requests,
+              1u);
+
+    respond(sentInstanceIds.back());
+    EXPECT_EQ(state, CircuitBreaker::State::Closed);
+    EXPECT_TRUE(handler.isEndpointAvailable(eid));
+    ASSERT_NE(handler.getCircuitBreaker(eid), nullptr);
+    EXPECT_EQ(handler.getCircuitBreaker(eid)->getProbeCount(), 1u);
+}
+
+TEST_F(HandlerTest, RequestDoesNotWaitBehindLowerClass)
+{
+    EXPECT_EQ(registerPing(0), NSM_SUCCESS);
+    EXPECT_EQ(registerPing(1), NSM_SUCCESS);
+    EXPECT_EQ(registerPing(2, RequestClass::Background, 7), NSM_SUCCESS);
+    // a round robin request does not attach to a queued background one
+    EXPECT_EQ(registerPing(3, RequestClass::RoundRobin, 7), NSM_SUCCESS);
+    EXPECT_EQ(handler.getNumCoalescedRequests(), 0u);
+    EXPECT_EQ(handler.getNumQueuedRequests(eid), 2u);
+    // a background request attaches to a queued request of a higher class
+    EXPECT_EQ(registerPing(4, RequestClass::Background, 7), NSM_SUCCESS);
+    EXPECT_EQ(handler.getNumCoalescedRequests(), 1u);
+
+    respond(sentInstanceIds[0]);
+    respond(sentInstanceIds[1]);
+    ASSERT_EQ(sentInstanceIds.size(), 4u);
+    respond(sentInstanceIds[2]);
+    respond(sentInstanceIds[3]);
+
+    ASSERT_EQ(completed.size(), 5u);
+    EXPECT_EQ(completed[2].first, 3u);
+    EXPECT_EQ(completed[3].first, 4u);
+    EXPECT_EQ(completed[4].first, 2u);
+
+    // completed requests left the pending index
+    EXPECT_EQ(registerPing(5, RequestClass::RoundRobin, 7), NSM_SUCCESS);
+    EXPECT_EQ(handler.getNumCoalescedRequests(), 1u);
+}
+
+TEST_F(HandlerTest, SendFailureFailsRequestAtOnce)
+{
+    EXPECT_EQ(registerPing(0), NSM_SUCCESS);
+    EXPECT_EQ(registerPing(1), NSM_SUCCESS);
+    EXPECT_EQ(registerPing(2), NSM_SUCCESS);
+    ASSERT_EQ(sentInstanceIds.size(), window);
+
+    // the batched send of the first request failed after it was queued
+    handler.handleSendFailure(eid, sentInstanceIds[0]);
+    ASSERT_EQ(completed.size(), 1u);
+    EXPECT_EQ(completed[0], std::make_pair(size_t(0), false));
+    EXPECT_EQ(handler.getNumActiveTimers(), 2 * window);
+    // the queued request takes its place
+    EXPECT_EQ(sentInstanceIds.size(), 3u);
+    EXPECT_EQ(handler.getNumQueuedRequests(eid), 0u);
+    EXPECT_EQ(handler.getNumOutstandingRequests(eid), window);
+
+    // a failure reported for a completed request is ignored
+    handler.handleSendFailure(eid, sentInstanceIds[0]);
+    EXPECT_EQ(completed.size(), 1u);
+}
@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "requester/request_pool.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace requester;
+
+struct TestSlot
+{
+    explicit TestSlot(int value) : value(value) {}
+
+    int value;
+    bool pooled = true;
+    TestSlot* next = nullptr;
+};
+
+TEST(RequestPoolTest, ReleasedSlotsAreReused)
+{
+    RequestPool<TestSlot> pool(2);
+    auto& first = pool.acquire(1);
+    auto& second = pool.acquire(2);
+    EXPECT_NE(&first, &second);
+    EXPECT_EQ(second.value, 2);
+
+    pool.release(first);
+    auto& third = pool.acquire(3);
+    EXPECT_EQ(&third, &first);
+    // the pool does not reset a recycled slot
+    EXPECT_EQ(third.value, 1);
+
+    const auto& stats = pool.getStats();
+    EXPECT_EQ(stats.capacity, 2u);
+    EXPECT_EQ(stats.slots, 2u);
+    EXPECT_EQ(stats.inUse, 2u);
+    EXPECT_EQ(stats.acquired, 3u);
+    EXPECT_EQ(stats.overflows, 0u);
+}
+
+TEST(RequestPoolTest, SlotsBeyondCapacityComeFromTheHeap)
+{
+    RequestPool<TestSlot> pool(1);
+    auto& pooled = pool.acquire(1);
+    auto& overflow = pool.acquire(2);
+    EXPECT_TRUE(pooled.pooled);
+    EXPECT_FALSE(overflow.pooled);
+    EXPECT_EQ(pool.getStats().overflows, 1u);
+    EXPECT_EQ(pool.getStats().peakInUse, 2u);
+
+    // a heap slot is freed rather than recycled
+    pool.release(overflow);
+    pool.release(pooled);
+    EXPECT_EQ(&pool.acquire(3), &pooled);
+    EXPECT_EQ(pool.getStats().slots, 1u);
+    EXPECT_EQ(pool.getStats().inUse, 1u);
+}
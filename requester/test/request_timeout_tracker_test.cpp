@@ -0,0 +1,60 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "requester/request_timeout_tracker.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace nsm;
+using namespace std::chrono_literals;
+using Outcome = FlightRecord::Outcome;
+
+TEST(FlightRecorderTest, RecordsOutcomes)
+{
+    auto& recorder = DeviceRequestTimeOutTracker::getInstance(30);
+    recorder.handleNoTimeout(0, 1, 4, 150us);
+    recorder.handleTimeout(3, 2, 5, 5s);
+
+    auto records = recorder.getRecords();
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].command, 1);
+    EXPECT_EQ(records[0].instanceId, 4);
+    EXPECT_EQ(records[0].latency, 150u);
+    EXPECT_EQ(records[0].outcome, Outcome::Response);
+    EXPECT_EQ(records[1].messageType, 3);
+    EXPECT_EQ(records[1].latency, 5000000u);
+    EXPECT_EQ(records[1].outcome, Outcome::Timeout);
+    EXPECT_LE(records[0].timestamp, records[1].timestamp);
+    EXPECT_EQ(recorder.getNumTimeouts(), 1u);
+}
+
+TEST(FlightRecorderTest, KeepsTheLatestRequests)
+{
+    auto& recorder = DeviceRequestTimeOutTracker::getInstance(31);
+    constexpr auto capacity = DeviceRequestTimeOutTracker::capacity;
+    for (size_t i = 0; i < capacity + 5; i++)
+    {
+        recorder.handleNoTimeout(0, static_cast<uint8_t>(i), 0, 1us);
+    }
+
+    auto records = recorder.getRecords();
+    ASSERT_EQ(records.size(), capacity);
+    EXPECT_EQ(records.front().command, 5);
+    EXPECT_EQ(records.back().command, capacity + 4);
+
+    // formats without timeouts as well
+    recorder.logTimeOutFailure();
+}
@@ -0,0 +1,90 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "requester/rtt_estimator.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace requester;
+using namespace std::chrono_literals;
+
+TEST(RttEstimatorTest, FirstSampleSetsEstimate)
+{
+    RttEstimator estimator;
+    EXPECT_FALSE(estimator.hasSamples());
+    EXPECT_EQ(estimator.timeout(2000ms, 20ms, 2000ms), 2000ms);
+
+    estimator.addSample(40ms);
+    EXPECT_EQ(estimator.getSmoothedRtt(), 40ms);
+    EXPECT_EQ(estimator.getRttVariation(), 20ms);
+    // SRTT + 4 * RTTVAR
+    EXPECT_EQ(estimator.timeout(2000ms, 20ms, 2000ms), 120ms);
+}
+
+TEST(RttEstimatorTest, StableRttConvergesToFloor)
+{
+    RttEstimator estimator;
+    for (int i = 0; i < 50; i++)
+    {
+        estimator.addSample(2ms);
+    }
+    EXPECT_EQ(estimator.getSmoothedRtt(), 2ms);
+    EXPECT_LT(estimator.getRttVariation(), 100us);
+    EXPECT_EQ(estimator.timeout(2000ms, 1ms, 2000ms), 3ms);
+    EXPECT_EQ(estimator.timeout(2000ms, 20ms, 2000ms), 20ms);
+}
+
+TEST(RttEstimatorTest, BackoffDoublesUntilNextSample)
+{
+    RttEstimator estimator;
+    estimator.addSample(40ms);
+    estimator.backoff();
+    EXPECT_EQ(estimator.timeout(2000ms, 20ms, 2000ms), 240ms);
+    estimator.backoff();
+    estimator.backoff();
+    estimator.backoff();
+    EXPECT_EQ(estimator.timeout(2000ms, 20ms, 2000ms), 1920ms);
+    estimator.backoff();
+    EXPECT_EQ(estimator.timeout(2000ms, 20ms, 2000ms), 2000ms);
+
+    estimator.addSample(40ms);
+    EXPECT_LT(estimator.timeout(2000ms, 20ms, 2000ms), 240ms);
+}
+
+TEST(ResponseTimeoutPolicyTest, CommandFallsBackToEid)
+{
+    ResponseTimeoutPolicy policy(20ms, 2000ms, 5000ms);
+    EXPECT_EQ(policy.timeout(8, 0, 1), 2000ms);
+
+    policy.addSample(8, 0, 1, 40ms);
+    EXPECT_EQ(policy.timeout(8, 0, 1), 120ms);
+    // another command of the same EID uses the estimate of the EID
+    EXPECT_EQ(policy.timeout(8, 3, 2), 120ms);
+    // other EIDs are not affected
+    EXPECT_EQ(policy.timeout(9, 0, 1), 2000ms);
+
+    policy.addSample(8, 3, 2, 400ms);
+    EXPECT_GT(policy.timeout(8, 3, 2), policy.timeout(8, 0, 1));
+}
+
+TEST(ResponseTimeoutPolicyTest, ExpiryCoversRetries)
+{
+    ResponseTimeoutPolicy policy(20ms, 2000ms, 5000ms);
+    // 100 + 200 + 400
+    EXPECT_EQ(policy.expiryInterval(100ms, 2), 700ms);
+    // 2000 + 2000 + 2000, bounded by the expiry ceiling
+    EXPECT_EQ(policy.expiryInterval(2000ms, 2), 5000ms);
+}
@@ -0,0 +1,112 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "requester/run_queue.hpp"
+
+#include <sdeventplus/event.hpp>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace requester;
+
+class RunQueueTest : public testing::Test
+{
+  protected:
+    RunQueueTest() : event(sdeventplus::Event::get_default()) {}
+
+    RunQueue::Task record(int id)
+    {
+        return [this, id]() { order.push_back(id); };
+    }
+
+    sdeventplus::Event event;
+    std::vector<int> order;
+};
+
+TEST_F(RunQueueTest, TasksRunFromTheQueue)
+{
+    RunQueue queue(event, 8);
+    queue.post(1, record(1));
+    queue.post(1, record(2));
+    EXPECT_TRUE(order.empty());
+    EXPECT_EQ(queue.size(), 2u);
+
+    queue.runBatch();
+    EXPECT_EQ(order, (std::vector<int>{1, 2}));
+    EXPECT_EQ(queue.size(), 0u);
+
+    const auto& stats = queue.getStats();
+    EXPECT_EQ(stats.posted, 2u);
+    EXPECT_EQ(stats.run, 2u);
+    EXPECT_EQ(stats.batches, 1u);
+    EXPECT_EQ(stats.maxDepth, 2u);
+}
+
+TEST_F(RunQueueTest, BatchSizeBoundsEachRun)
+{
+    RunQueue queue(event, 2);
+    for (int i = 0; i < 5; i++)
+    {
+        queue.post(1, record(i));
+    }
+
+    queue.runBatch();
+    EXPECT_EQ(order.size(), 2u);
+    queue.runBatch();
+    EXPECT_EQ(order.size(), 4u);
+    queue.runBatch();
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3, 4}));
+}
+
+TEST_F(RunQueueTest, EidsAreServedRoundRobin)
+{
+    RunQueue queue(event, 8);
+    queue.post(1, record(10));
+    queue.post(1, record(11));
+    queue.post(1, record(12));
+    queue.post(2, record(20));
+    queue.post(3, record(30));
+    queue.post(2, record(21));
+
+    queue.runBatch();
+    EXPECT_EQ(order, (std::vector<int>{10, 20, 30, 11, 21, 12}));
+}
+
+TEST_F(RunQueueTest, TasksPostedByTasksWaitForTheNextBatch)
+{
+    RunQueue queue(event, 8);
+    queue.post(1, [&]() {
+        order.push_back(1);
+        queue.post(1, record(2));
+    });
+
+    queue.runBatch();
+    EXPECT_EQ(order, (std::vector<int>{1}));
+    queue.runBatch();
+    EXPECT_EQ(order, (std::vector<int>{1, 2}));
+}
+
+TEST_F(RunQueueTest, ZeroBatchSizeRunsTasksAtOnce)
+{
+    RunQueue queue(event, 0);
+    queue.post(1, record(1));
+    EXPECT_EQ(order, (std::vector<int>{1}));
+    EXPECT_EQ(queue.size(), 0u);
+    EXPECT_EQ(queue.getStats().latencyHistogram[0], 1u);
+}
@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "requester/timer_wheel.hpp"
+
+#include <sdeventplus/event.hpp>
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace requester;
+using namespace std::chrono_literals;
+
+class TimerWheelTest : public testing::Test
+{
+  protected:
+    TimerWheelTest() :
+        event(sdeventplus::Event::get_default()), wheel(event, 1s)
+    {}
+
+    /** @brief Expire the wheel at the given offset from now */
+    void expireAfter(TimerWheel::Clock::duration offset)
+    {
+        wheel.expire(TimerWheel::Clock::now() + offset);
+    }
+
+    sdeventplus::Event event;
+    TimerWheel wheel;
+};
+
+TEST_F(TimerWheelTest, TimerExpiresAfterTimeout)
+{
+    size_t fired = 0;
+    TimerWheel::Timer timer(wheel, [&]() { fired++; });
+
+    timer.start(5s);
+    EXPECT_TRUE(timer.isRunning());
+    EXPECT_EQ(wheel.getNumActiveTimers(), 1u);
+
+    expireAfter(3s);
+    EXPECT_EQ(fired, 0u);
+
+    expireAfter(6s);
+    EXPECT_EQ(fired, 1u);
+    EXPECT_FALSE(timer.isRunning());
+    EXPECT_EQ(wheel.getNumActiveTimers(), 0u);
+}
+
+TEST_F(TimerWheelTest, StoppedTimerDoesNotExpire)
+{
+    size_t fired = 0;
+    TimerWheel::Timer first(wheel, [&]() { fired++; });
+    TimerWheel::Timer second(wheel, [&]() { fired += 10; });
+
+    first.start(2s);
+    second.start(2s);
+    first.stop();
+    EXPECT_EQ(wheel.getNumActiveTimers(), 1u);
+
+    expireAfter(3s);
+    EXPECT_EQ(fired, 10u);
+}
+
+TEST_F(TimerWheelTest, LongTimersCascadeInOrder)
+{
+    std::vector<int> order;
+    TimerWheel::Timer level0(wheel, [&]() { order.push_back(0); });
+    TimerWheel::Timer level1(wheel, [&]() { order.push_back(1); });
+    TimerWheel::Timer level2(wheel, [&]() { order.push_back(2); });
+
+    level2.start(5000s);
+    level1.start(100s);
+    level0.start(10s);
+
+    expireAfter(99s);
+    EXPECT_EQ(order, (std::vector<int>{0}));
+
+    expireAfter(5001s);
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(wheel.getNumActiveTimers(), 0u);
+}
+
+TEST_F(TimerWheelTest, CallbackCanRestartAndDestroyTimers)
+{
+    size_t restarts = 0;
+    std::unique_ptr<TimerWheel::Timer> periodic;
+    periodic = std::make_unique<TimerWheel::Timer>(wheel, [&]() {
+        if (++restarts < 3)
+        {
+            periodic->start(1s);
+        }
+        else
+        {
+            periodic.reset();
+        }
+    });
+
+    periodic->start(1s);
+    for (auto offset = 1s; offset <= 4s; offset += 1s)
+    {
+        expireAfter(offset + 500ms);
+    }
+
+    EXPECT_EQ(restarts, 3u);
+    EXPECT_EQ(periodic, nullptr);
+    EXPECT_EQ(wheel.getNumActiveTimers(), 0u);
+}
+
+TEST_F(TimerWheelTest, TimeoutIsClamped)
+{
+    size_t fired = 0;
+    TimerWheel::Timer timer(wheel, [&]() { fired++; });
+
+    timer.start(wheel.maxTimeout() * 2);
+    expireAfter(wheel.maxTimeout() - 1s);
+    EXPECT_EQ(fired, 0u);
+
+    expireAfter(wheel.maxTimeout() + 1s);
+    EXPECT_EQ(fired, 1u);
+}
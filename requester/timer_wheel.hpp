@@ -0,0 +1,375 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <sdbusplus/timer.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace requester
+{
+
+/** @class TimerWheel
+ *
+ *  Hierarchical timing wheel multiplexing any number of one-shot timers onto
+ *  a single sd-event timer. Starting and stopping a timer is O(1), expired
+ *  timers are found with per-level occupancy bitmaps and the sd-event timer
+ *  is only armed for the next occupied slot.
+ *
+ *  Level L has 64 slots of 64^L ticks each. A timer lives at the lowest level
+ *  whose enclosing block it shares with the current tick, and moves down a
+ *  level whenever the wheel crosses into its block.
+ */
+class TimerWheel
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Intrusive list node shared by the slots and the timers */
+    struct Link
+    {
+        Link* prev = this;
+        Link* next = this;
+
+        bool empty() const
+        {
+            return next == this;
+        }
+
+        void unlink()
+        {
+            prev->next = next;
+            next->prev = prev;
+            prev = next = this;
+        }
+
+        void pushBack(Link& node)
+        {
+            node.prev = prev;
+            node.next = this;
+            prev->next = &node;
+            prev = &node;
+        }
+
+        /** @brief Move every node of the list to the other, empty, list */
+        void moveTo(Link& other)
+        {
+            if (empty())
+            {
+                return;
+            }
+            other.next = next;
+            other.prev = prev;
+            next->prev = &other;
+            prev->next = &other;
+            prev = next = this;
+        }
+    };
+
+    /** @class Timer
+     *
+     *  A one-shot timer of the wheel. The callback may start, stop or destroy
+     *  the timer itself.
+     */
+    class Timer : private Link
+    {
+      public:
+        Timer() = delete;
+        Timer(const Timer&) = delete;
+        Timer(Timer&&) = delete;
+        Timer& operator=(const Timer&) = delete;
+        Timer& operator=(Timer&&) = delete;
+
+        /** @brief Constructor
+         *
+         *  @param[in] wheel - timing wheel driving the timer
+         *  @param[in] callback - invoked when the timer expires
+         */
+        Timer(TimerWheel& wheel, std::function<void()> callback) :
+            wheel(wheel), callback(std::move(callback))
+        {}
+
+        ~Timer()
+        {
+            stop();
+        }
+
+        /** @brief Arm the timer, rearming it if it is already running
+         *
+         *  @param[in] timeout - time until expiry, rounded up to the tick of
+         *                       the wheel and clamped to maxTimeout()
+         */
+        template <typename Rep, typename Period>
+        void start(std::chrono::duration<Rep, Period> timeout)
+        {
+            stop();
+            wheel.add(*this, std::chrono::ceil<Clock::duration>(timeout));
+        }
+
+        /** @brief Disarm the timer, no-op if it is not running */
+        void stop()
+        {
+            if (running)
+            {
+                wheel.remove(*this);
+            }
+        }
+
+        bool isRunning() const
+        {
+            return running;
+        }
+
+      private:
+        friend class TimerWheel;
+
+        TimerWheel& wheel;
+        std::function<void()> callback;
+        uint64_t expiry = 0;
+        bool running = false;
+    };
+
+    static constexpr unsigned slotBits = 6;
+    static constexpr size_t slotsPerLevel = 1 << slotBits;
+    static constexpr size_t numLevels = 4;
+
+    TimerWheel() = delete;
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel(TimerWheel&&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+    TimerWheel& operator=(TimerWheel&&) = delete;
+    ~TimerWheel() = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] event - reference to NSM daemon's main event loop
+     *  @param[in] tick - resolution of the wheel
+     */
+    explicit TimerWheel(sdeventplus::Event& event,
+                        Clock::duration tick = std::chrono::milliseconds(1)) :
+        tick(tick),
+        origin(Clock::now()),
+        timer(event.get(), [this]() { expire(Clock::now()); })
+    {}
+
+    /** @brief Get the number of running timers */
+    size_t getNumActiveTimers() const
+    {
+        return numActive;
+    }
+
+    /** @brief Longest timeout a timer can be started with */
+    Clock::duration maxTimeout() const
+    {
+        return tick * static_cast<Clock::rep>(maxTicks);
+    }
+
+    /** @brief Run the callbacks of every timer expired at the given time.
+     *         Called by the sd-event timer, exposed for unit tests.
+     *
+     *  @param[in] now - current time
+     */
+    void expire(Clock::time_point now)
+    {
+        auto target = toTick(now);
+        while (currentTick < target)
+        {
+            // jump over the ticks where nothing happens
+            currentTick = std::min(nextEventTick(), target + 1) - 1;
+            if (currentTick >= target)
+            {
+                break;
+            }
+
+            ++currentTick;
+            cascade();
+
+            Link due;
+            slots[0][currentTick & slotMask].moveTo(due);
+            occupied[0] &= ~(uint64_t(1) << (currentTick & slotMask));
+            while (!due.empty())
+            {
+                auto& expired = static_cast<Timer&>(*due.next);
+                expired.unlink();
+                if (expired.expiry > currentTick)
+                {
+                    // clamped into the top level, not due yet
+                    insert(expired);
+                    continue;
+                }
+                expired.running = false;
+                numActive--;
+                // the callback may destroy the timer, do not touch it after
+                expired.callback();
+            }
+        }
+        schedule();
+    }
+
+  private:
+    static constexpr uint64_t slotMask = slotsPerLevel - 1;
+    static constexpr uint64_t maxTicks =
+        (uint64_t(1) << (slotBits * (numLevels - 1))) * (slotsPerLevel - 1);
+
+    Clock::duration tick;
+    Clock::time_point origin;
+    uint64_t currentTick = 0;
+    size_t numActive = 0;
+    std::array<std::array<Link, slotsPerLevel>, numLevels> slots;
+    std::array<uint64_t, numLevels> occupied{};
+    sdbusplus::Timer timer; //!< single sd-event timer driving the wheel
+    uint64_t scheduledTick = 0;
+
+    uint64_t toTick(Clock::time_point time) const
+    {
+        return time <= origin ? 0 : (time - origin) / tick;
+    }
+
+    void add(Timer& t, Clock::duration timeout)
+    {
+        auto now = toTick(Clock::now());
+        if (numActive == 0)
+        {
+            // idle wheel, nothing can expire while catching up
+            currentTick = std::max(currentTick, now);
+        }
+        uint64_t ticks = (std::max(timeout, Clock::duration::zero()) + tick -
+                          Clock::duration(1)) /
+                         tick;
+        ticks = std::clamp<uint64_t>(ticks, 1, maxTicks);
+        t.expiry = std::max(now, currentTick) + ticks;
+        t.running = true;
+        numActive++;
+        insert(t);
+        if (numActive == 1 || t.expiry < scheduledTick)
+        {
+            schedule();
+        }
+    }
+
+    void remove(Timer& t)
+    {
+        t.unlink();
+        t.running = false;
+        numActive--;
+        if (numActive == 0)
+        {
+            timer.stop();
+            scheduledTick = 0;
+        }
+    }
+
+    void insert(Timer& t)
+    {
+        auto expiry = std::max(t.expiry, currentTick + 1);
+        size_t level = 0;
+        while (level < numLevels - 1 &&
+               (expiry >> (slotBits * (level + 1))) !=
+                   (currentTick >> (slotBits * (level + 1))))
+        {
+            level++;
+        }
+        auto slot = (expiry >> (slotBits * level)) & slotMask;
+        slots[level][slot].pushBack(t);
+        occupied[level] |= uint64_t(1) << slot;
+    }
+
+    /** @brief Move the timers of the upper level slots the current tick just
+     *         entered down the wheel, highest level first
+     */
+    void cascade()
+    {
+        size_t top = 0;
+        while (top < numLevels - 1 &&
+               (currentTick & ((uint64_t(1) << (slotBits * (top + 1))) - 1)) ==
+                   0)
+        {
+            top++;
+        }
+        for (size_t level = top; level > 0; --level)
+        {
+            auto slot = (currentTick >> (slotBits * level)) & slotMask;
+            Link moved;
+            slots[level][slot].moveTo(moved);
+            occupied[level] &= ~(uint64_t(1) << slot);
+            while (!moved.empty())
+            {
+                auto& t = static_cast<Timer&>(*moved.next);
+                t.unlink();
+                insert(t);
+            }
+        }
+    }
+
+    /** @brief Get the next tick at which a timer may expire or an upper
+     *         level slot cascades. Every tick before it can be skipped.
+     */
+    uint64_t nextEventTick() const
+    {
+        for (size_t level = 0; level < numLevels; ++level)
+        {
+            auto shift = slotBits * level;
+            auto index = (currentTick >> shift) & slotMask;
+            auto ahead = index == slotMask ? 0
+                                           : occupied[level] >> (index + 1);
+            auto base = (currentTick >> (shift + slotBits))
+                        << (shift + slotBits);
+            if (ahead)
+            {
+                auto slot = index + 1 + std::countr_zero(ahead);
+                return base + (slot << shift);
+            }
+            if (level == numLevels - 1 && occupied[level])
+            {
+                // the slots behind the current index belong to the next
+                // revolution of the top level
+                auto slot = std::countr_zero(occupied[level]);
+                return base + (uint64_t(1) << (shift + slotBits)) +
+                       (uint64_t(slot) << shift);
+            }
+        }
+        return currentTick + 1;
+    }
+
+    /** @brief Arm the sd-event timer for the next tick which may expire a
+     *         timer
+     */
+    void schedule()
+    {
+        if (numActive == 0)
+        {
+            timer.stop();
+            scheduledTick = 0;
+            return;
+        }
+
+        scheduledTick = nextEventTick();
+        auto due = origin + tick * static_cast<Clock::rep>(scheduledTick);
+        auto now = Clock::now();
+        timer.start(std::chrono::ceil<std::chrono::microseconds>(
+            std::max(due - now, Clock::duration::zero())));
+    }
+};
+
+} // namespace requester